@@ -1,6 +1,36 @@
 import json
 import numpy as np
 import pathlib
+import struct
+import zlib
+
+# Logs written with `-F | --frame` wrap each record as [24-byte header][payload]
+# Header: magic, kind, reserved, payload length, CRC-32 (zlib), sequence number
+FRAME_HEADER = struct.Struct('<IHHIIQ')
+FRAME_MAGIC = 0x46524C53
+FRAME_DATA = 0
+
+def unframe(raw):
+    # Return the payload text of every valid data record, stopping at the first torn/corrupt frame
+    payloads = []
+    offset = 0
+    while offset + FRAME_HEADER.size <= len(raw):
+        magic, kind, reserved, length, crc, seq = FRAME_HEADER.unpack_from(raw, offset)
+        end = offset + FRAME_HEADER.size + length
+        if magic != FRAME_MAGIC or end > len(raw):
+            break
+        zeroed = FRAME_HEADER.pack(magic, kind, reserved, length, 0, seq)
+        if zlib.crc32(raw[offset+FRAME_HEADER.size:end], zlib.crc32(zeroed)) != crc:
+            break
+        if kind == FRAME_DATA:
+            payloads.append(raw[offset+FRAME_HEADER.size:end].decode())
+        offset = end
+    return "".join(payloads)
+
+def is_framed(fname):
+    with open(fname, 'rb') as f:
+        head = f.read(4)
+    return len(head) == 4 and struct.unpack('<I', head)[0] == FRAME_MAGIC
 
 def backspace_json(data):
     olen = len(data)
@@ -70,8 +100,14 @@ def incomplete_json(data):
         return clipped_json
 
 def load_incomplete_json(fname, n=0, to=-1, via=incomplete_json):
-    with open(fname, 'r') as f:
-        contents = "".join([_ for idx, _ in enumerate(f.readlines()) if idx >= n and (to==-1 or idx < to)])
+    if is_framed(fname):
+        # Framed logs are cut at the last valid record, so only the closing bracket can be missing
+        with open(fname, 'rb') as f:
+            lines = unframe(f.read()).splitlines(keepends=True)
+    else:
+        with open(fname, 'r') as f:
+            lines = f.readlines()
+    contents = "".join([_ for idx, _ in enumerate(lines) if idx >= n and (to==-1 or idx < to)])
     return via(contents)
 
 if __name__ == "__main__":
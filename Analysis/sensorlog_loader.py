@@ -0,0 +1,29 @@
+import json
+import numpy as np
+
+# The sensorlog extension (SensorTools/reader) parses logs in parallel C++ and hands columns to numpy without copies
+# Build it with `cmake -DBUILD_PYTHON_READER=ON` and put the build directory on PYTHONPATH
+# Scripts fall back to their own pure-Python loading when it is unavailable
+try:
+    import sensorlog
+except ImportError:
+    sensorlog = None
+
+def fast_reader_available():
+    return sensorlog is not None
+
+def load_log(fname):
+    # Returns (columns, events, truncated)
+    # columns maps channel name -> numpy array (list of str for text channels), with 'timestamp' first
+    # events are dicts like the JSON records: 'event', 'timestamp', ... plus any payload fields
+    log = sensorlog.read(str(fname))
+    text = set(log.text_columns)
+    columns = dict()
+    for name in log:
+        columns[name] = log[name] if name in text else np.asarray(log[name])
+    events = []
+    for event in log.events:
+        payload = json.loads(event.pop('payload'))
+        event.update(payload)
+        events.append(event)
+    return columns, events, log.truncated
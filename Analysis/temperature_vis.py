@@ -13,6 +13,7 @@ lines = {'linewidth': 2,
 matplotlib.rc('font', **font)
 matplotlib.rc('lines', **lines)
 import matplotlib.pyplot as plt
+from sensorlog_loader import fast_reader_available, load_log
 rcparams = {'axes.labelsize': 16,
             'legend.fontsize': 16,
             'xtick.labelsize': 20,
@@ -245,7 +246,31 @@ def get_temps_and_traces(args, paths, postprocess=True, baseline=None):
     for i in paths:
         prev_temp_len = len(temps)
         prev_trace_len = len(traces)
-        if i.suffix == '.json':
+        if fast_reader_available() and i.suffix in ['.json', '.csv']:
+            columns, events, truncated = load_log(i)
+            print(f"Loaded {i} with sensorlog{' (torn final record dropped)' if truncated else ''}")
+            times = columns['timestamp']
+            temp_cols = [_ for _ in columns if 'temperature' in _]
+            # Only load fields that match a regex when --only-regex is given
+            if len(args.only_regex) > 0:
+                temp_cols = [_ for _ in temp_cols if any((re.match(expr, _) for expr in args.only_regex))]
+            for col in temp_cols:
+                temps.append(VarianceData(times, relabel(f"{refile(i.name,args)} {col.replace('_','-')}", args.rename_labels), columns[col], directory=i.parents[0]))
+            if i.suffix == '.json':
+                for col in columns:
+                    if any((re.match(expr, col) for expr in args.non_temperatures)):
+                        others.append(VarianceData(times, relabel(f"{refile(i.name,args)} {col.replace('_','-')}", args.rename_labels), columns[col], directory=i.parents[0]))
+                skip_events = ['initialization', 'poll-update']
+                for record in events:
+                    if record['event'] in skip_events:
+                        continue
+                    if len(traces) > 0 and args.min_trace_diff is not None and\
+                       record['timestamp'] - traces[-1].timestamp < args.min_trace_diff:
+                       continue
+                    traces.append(TimedLabel(record['timestamp'], relabel(f"{refile(i.name,args)} {record['event']} ({int(record['timestamp'])})", args.rename_labels), directory=i.parents[0]))
+            print(f"Loaded {sum([len(t.data) for t in temps[prev_temp_len:]])} temperature records ({len(temp_cols)} fields)")
+            print(f"Loaded {len(traces[prev_trace_len:])} trace records")
+        elif i.suffix == '.json':
             with open(i) as f:
                 j = json.load(f)
             print(f"Loaded JSON {i}")
@@ -10,7 +10,7 @@ def build():
     fio.add_argument("--inputs", "-i", nargs="+", required=True,
                      help="CSV or JSON files to parse")
     fio.add_argument("--auxilliary-inputs", "-a", nargs="*", default=None,
-                     help="Error and nohup-style files to parse for additional event timings")
+                     help="Error, nohup-style and event timeline (.events, from -E | --events) files to parse for additional event timings")
     fio.add_argument("--output", default=None,
                      help="Path to save plot to (default: display only)")
     fio.add_argument("--format", choices=['png','pdf','svg','jpeg'], default='png',
@@ -107,6 +107,17 @@ class traceData(labeled_timestamp):
         super().__init__(timestamp, axis_label, kind, tag)
         self.record_class = record_class
 
+    @classmethod
+    def from_event(cls, record, source):
+        # Typed timeline events carry their own wallclock, so no auxilliary file is needed to pin them
+        trace = cls(record['timestamp'], f"{source.name} {record['event']} ({int(record['timestamp'])})", record['event'], detect_kind_from_path(source.name), source.stem)
+        if 'wallclock-ns' in record:
+            trace.datetime_timestamp = datetime.datetime.fromtimestamp(int(record['wallclock-ns']) / 1e9)
+            trace.old_axis_label = trace.axis_label
+            trace.axis_label = trace.axis_label.split('(')[0]+f"({trace.datetime_timestamp})"
+            trace.relabeled = True
+        return trace
+
     def __repr__(self):
         return f"[{super().__repr_front__()}: {self.record_class}] {super().__repr_back__()}"
 
@@ -241,7 +252,7 @@ def get_temps_and_traces(args):
             print(f"Loaded JSON {i}")
             jtemps = dict()
             jtimes = []
-            skip_events = ['initialization', 'poll-update']
+            skip_events = ['initialization', 'poll-update', 'program-start', 'server-start', 'server-stop', 'client-connect', 'client-poll']
             for record in j:
                 if 'event' not in record or record['event'] in skip_events:
                     continue
@@ -262,7 +273,7 @@ def get_temps_and_traces(args):
                     if len(traces) > 0 and args.min_trace_diff is not None and\
                        record['timestamp'] - traces[-1].timestamp < args.min_trace_diff:
                        continue
-                    traces.append(traceData(record['timestamp'], f"{i.name} {record['event']} ({int(record['timestamp'])})", record['event'], detect_kind_from_path(i.name), i.stem))
+                    traces.append(traceData.from_event(record, i))
             # Post all tracked data
             for (k,v) in jtemps.items():
                 temps.append(temperatureData(v, jtimes, f"{i.name} {k}", detect_kind_from_path(i.name), i.stem))
@@ -285,7 +296,23 @@ def get_temps_and_traces(args):
     # Auxilliary files have a lot of extraneous data, but we can skip through it with regex well enough
     for a in args.auxilliary_inputs:
         prev_trace_len = len(traces)
-        if a.suffix in ['.error', '.out']:
+        if a.suffix == '.events':
+            # Event timeline sidecar, written in the run's output format; payloads are not needed for tracing
+            with open(a) as f:
+                is_json = f.read(1) == '['
+            if is_json:
+                with open(a) as f:
+                    records = json.load(f)
+            else:
+                # CSV column names use underscores where JSON keys use hyphens
+                records = [{k.replace('_', '-'): v for (k,v) in record.items()} for record in pd.read_csv(a).to_dict('records')]
+            for record in records:
+                if record['event'] in ['initialization', 'program-start', 'server-start', 'server-stop', 'client-connect', 'client-poll']:
+                    continue
+                traces.append(traceData.from_event(record, a))
+            print(f"Loaded {len(traces[prev_trace_len:])} trace records from event timeline {a}")
+            continue
+        elif a.suffix in ['.error', '.out']:
             with open(a) as f:
                 aux = [_.rstrip() for _ in f.readlines()]
         else:
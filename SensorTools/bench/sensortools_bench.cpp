@@ -0,0 +1,521 @@
+/*
+    sensortools_bench: cost of each piece of the sensing pipeline, measured against simulated hardware
+
+    Suites (select with -s, default: all of them):
+        cpufreq     scaling_cur_freq polls through a cached FILE* (the original update_cpus() path), one pread() per core
+                    and the batched SysfsReader (io_uring when available)
+        libsensors  every hwmon feature the CPU tool reports, discovered and read the way it replaces libsensors calls
+        snmp        encoding the PDU GetRequest and parsing the GetResponse a simulated agent answers it with
+        submer      parsing a simulated Submer realTime document and extracting every logged field
+        format      rendering samples as CSV, JSON and human-readable text on a sink thread, at several channel counts
+        poll        whole poll cycles of the sensing tool (-c) on simulated trees of several core counts, under -V
+    File-based suites read a tree written by sensortools-simtree, which is removed afterwards; -r uses the live /sys instead.
+    Poll cycles are timed as the difference between a long and a short run, so startup and caching cancel out,
+    alongside the mean poll-update-duration the tool logged for itself.
+    -j prints every result as one JSON document, so runs of different versions can be compared.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../definitions.h" // SensorToolsVersion, NAME_BUFFER_SIZE (the read size of the original cpufreq path)
+#include "../enums.h" // OutputFormats, SampleChannelKinds, SysfsEngines, DebugLevels
+#include "../io/sysfs_parse.h" // The parser under test
+#include "../io/sysfs_reader.h" // The batched reader under test
+#include "../io/sample.h" // Sample schema and records
+#include "../io/sinks.h" // Sink rendering under test
+#include "../tools/cpu/hwmon.h" // hwmon discovery and compute expressions under test
+#include "../tools/pdu/snmp_hosts_and_oids.h" // The OIDs the PDU tool requests
+#include "../tools/pdu/snmp.c" // Message encoding under test; connections are simulated below
+#include "../tools/sim/snmp_sim.h" // GetResponse messages to parse
+#include "../tools/pdu/snmp_response.h" // The response parser under test
+#include "../tools/sim/curl_sim.h" // Submer documents to parse
+#include "../reader/log_reader.h" // Reading back the logs of end-to-end runs
+#include <nlohmann/json.hpp> // The Submer parser under test
+
+#include <iostream> // std file descriptors
+#include <iomanip> // setw and setprecision
+#include <sstream> // Splitting lists
+#include <string> // String class and manipulation
+#include <vector> // Results and file lists
+#include <chrono> // Wall time
+#include <cmath> // NAN, isnan()
+#include <cstdio> // FILE type, fopen(), fread(), rewind(), fclose()
+#include <cstdlib> // mkdtemp(), atoi()
+#include <ctime> // clock_gettime() for process CPU time
+#include <filesystem> // Tree discovery and cleanup
+#include <getopt.h> // provides getopt-long() definition
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close(), fork(), execv()
+#include <sys/wait.h> // wait4()
+#include <sys/resource.h> // Child CPU time from wait4()
+// End Headers
+
+#define BenchDefaultCores 64 // Cores in the tree used by the cpufreq and libsensors suites
+#define BenchDefaultIterations 2000 // Operations timed per benchmark, and poll cycles per end-to-end run
+#define BenchDefaultPollCores "4,32,256" // Tree sizes of the poll suite
+#define BenchPollInterval 0.001 // Virtual seconds between polls of end-to-end runs
+#define BenchShortRunFraction 5 // The short end-to-end run polls 1/this as many times as the long one
+
+// Class and Type declarations
+typedef struct bench_result_t {
+    std::string suite, name;
+    size_t items; // Files, channels or fields handled per operation
+    long ops; // Operations timed
+    double wall_ns, cpu_ns; // Per operation; NAN when not measured
+    uint64_t checksum; // Keeps the work from being optimized away
+} bench_result;
+
+// Counts what the sink would deliver instead of writing it anywhere
+class CountingSink : public Sink {
+protected:
+    bool open(void) override { return true; }
+    bool write(const std::string& data) override { bytes += data.size(); return true; }
+    void close(void) override {}
+public:
+    uint64_t bytes = 0;
+    CountingSink(short format) : Sink(format, SinkDefaultDepth, "bench") {}
+};
+
+// Outcome of running another program to completion
+typedef struct run_result_t {
+    int status;
+    double wall_s, cpu_s;
+} run_result;
+// End Class and Type declarations
+
+static const char* suite_names[] = {"cpufreq", "libsensors", "snmp", "submer", "format", "poll"};
+static const char* format_names[count_OutputFormats] = {"csv", "human", "json"};
+static const size_t format_channels[] = {16, 256, 2048};
+
+void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options]" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-s [suite] | --suite [suite]\n\t\t" <<
+                 "Run only this suite; may be repeated (suites: cpufreq, libsensors, snmp, submer, format, poll)" << std::endl;
+    std::cout << "\t-i [n] | --iterations [n]\n\t\t" <<
+                 "Operations timed per benchmark and poll cycles per end-to-end run (default: " << BenchDefaultIterations << ")" << std::endl;
+    std::cout << "\t-n [cores] | --cores [cores]\n\t\t" <<
+                 "Cores in the simulated tree read by the cpufreq and libsensors suites (default: " << BenchDefaultCores << ")" << std::endl;
+    std::cout << "\t-C [list] | --poll-cores [list]\n\t\t" <<
+                 "Comma-separated core counts of the trees the poll suite runs the sensing tool on (default: " << BenchDefaultPollCores << ")" << std::endl;
+    std::cout << "\t-a [args] | --sensor-args [args]\n\t\t" <<
+                 "Extra space-separated arguments for the sensing tool in the poll suite, ie: other collectors" << std::endl;
+    std::cout << "\t-r | --real\n\t\t" <<
+                 "Read the live /sys in the cpufreq and libsensors suites instead of a simulated tree" << std::endl;
+    std::cout << "\t-j | --json\n\t\t" <<
+                 "Print results as JSON" << std::endl;
+}
+
+static double cpu_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+template <typename Op>
+static bench_result time_op(const char* suite, const std::string& name, size_t items, long ops, Op op) {
+    bench_result result = {suite, name, items, ops, 0, 0, 0};
+    result.checksum += op(); // Warm up caches and the page cache
+    double cpu0 = cpu_now_ns();
+    std::chrono::time_point<std::chrono::steady_clock> wall0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < ops; i++) result.checksum += op();
+    std::chrono::time_point<std::chrono::steady_clock> wall1 = std::chrono::steady_clock::now();
+    double cpu1 = cpu_now_ns();
+    result.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall1 - wall0).count() / static_cast<double>(ops);
+    result.cpu_ns = (cpu1 - cpu0) / ops;
+    return result;
+}
+
+// Run argv[0] with output going to log, waiting for it to finish
+static run_result run_program(const std::vector<std::string>& argv, const std::string& log) {
+    run_result result = {-1, 0, 0};
+    std::vector<char*> cargv;
+    for (std::vector<std::string>::const_iterator i = argv.begin(); i != argv.end(); i++) cargv.push_back(const_cast<char*>(i->c_str()));
+    cargv.push_back(nullptr);
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execv(cargv[0], cargv.data());
+        _exit(127);
+    }
+    if (pid < 0) return result;
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) return result;
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpu_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    result.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return result;
+}
+
+// Write a simulated /sys and /proc for cores below dir
+static bool make_tree(const std::string& dir, int cores) {
+    std::vector<std::string> argv = {BenchSimtreeProgram, "-c", std::to_string(cores), "-s", (cores > 1) ? "2" : "1", dir};
+    run_result run = run_program(argv, dir + ".simtree.log");
+    if (run.status != 0) std::cerr << "Unable to generate a simulated tree for " << cores << " cores (see " << dir << ".simtree.log)" << std::endl;
+    else std::filesystem::remove(dir + ".simtree.log");
+    return run.status == 0;
+}
+
+static void bench_cpufreq(const std::string& root, long iterations, std::vector<bench_result>& results) {
+    std::vector<std::string> paths;
+    for (int n_cpu = 0; ; n_cpu++) {
+        std::filesystem::path fpath(root + "/sys/devices/system/cpu/cpu" + std::to_string(n_cpu) + "/cpufreq/scaling_cur_freq");
+        if (!std::filesystem::exists(fpath)) break;
+        paths.push_back(fpath.string());
+    }
+    if (paths.empty()) {
+        std::cerr << "No cpufreq files below " << root << ", skipping the cpufreq suite" << std::endl;
+        return;
+    }
+    std::vector<FILE*> handles;
+    std::vector<int> fds;
+    for (std::vector<std::string>::iterator i = paths.begin(); i != paths.end(); i++) {
+        handles.push_back(fopen(i->c_str(), "r"));
+        fds.push_back(open(i->c_str(), O_RDONLY | O_CLOEXEC));
+        if (handles.back() == nullptr || fds.back() < 0) {
+            std::cerr << "Unable to open '" << *i << "'" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    results.push_back(time_op("cpufreq", "stdio", paths.size(), iterations, [&](void) {
+        uint64_t sum = 0;
+        char buf[NAME_BUFFER_SIZE] = {0};
+        for (std::vector<FILE*>::iterator i = handles.begin(); i != handles.end(); i++) {
+            rewind(*i);
+            if (fread(buf, sizeof(char), sizeof(buf), *i) > 0) sum += std::stoi(buf);
+        }
+        return sum;
+    }));
+    results.push_back(time_op("cpufreq", "pread", paths.size(), iterations, [&](void) {
+        uint64_t sum = 0;
+        char buf[SysfsReadSize] = {0};
+        for (std::vector<int>::iterator i = fds.begin(); i != fds.end(); i++) {
+            ssize_t nbytes = pread(*i, buf, sizeof(buf), 0);
+            if (nbytes > 0) sum += parse_sysfs_uint(buf, nbytes);
+        }
+        return sum;
+    }));
+    SysfsReader batched;
+    for (std::vector<int>::iterator i = fds.begin(); i != fds.end(); i++) batched.add(*i);
+    batched.start(SysfsAuto, std::cerr, DebugOFF);
+    results.push_back(time_op("cpufreq", batched.engine_name(), paths.size(), iterations, [&](void) {
+        uint64_t sum = 0;
+        batched.read_all();
+        for (size_t i = 0; i < batched.size(); i++) sum += batched.value(i);
+        return sum;
+    }));
+    batched.stop();
+
+    for (std::vector<FILE*>::iterator i = handles.begin(); i != handles.end(); i++) fclose(*i);
+    for (std::vector<int>::iterator i = fds.begin(); i != fds.end(); i++) close(*i);
+}
+
+static void bench_libsensors(const std::string& root, long iterations, std::vector<bench_result>& results) {
+    unsigned features = 0;
+    std::string error;
+    parse_cpu_features("all", features, error);
+    std::filesystem::path hwmon_root = root + HwmonRoot;
+    std::vector<hwmon_chip> chips;
+    // Discovery happens once at cache time, so fewer rounds are enough
+    long scans = (iterations + 99) / 100;
+    results.push_back(time_op("libsensors", "scan", 0, scans, [&](void) {
+        chips = scan_hwmon(hwmon_root, features, std::cerr, DebugOFF);
+        return chips.size();
+    }));
+    SysfsReader reader;
+    std::vector<const hwmon_input*> inputs;
+    for (std::vector<hwmon_chip>::iterator chip = chips.begin(); chip != chips.end(); chip++)
+        for (std::vector<hwmon_input>::iterator input = chip->inputs.begin(); input != chip->inputs.end(); input++) {
+            int fd = open(input->path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            reader.add(fd);
+            inputs.push_back(&*input);
+        }
+    results.back().items = inputs.size();
+    if (inputs.empty()) {
+        std::cerr << "No hwmon features below " << hwmon_root << ", skipping libsensors reads" << std::endl;
+        return;
+    }
+    reader.start(SysfsAuto, std::cerr, DebugOFF);
+    results.push_back(time_op("libsensors", std::string("read-") + reader.engine_name(), inputs.size(), iterations, [&](void) {
+        double sum = 0;
+        reader.read_all();
+        for (size_t i = 0; i < inputs.size(); i++)
+            sum += apply_hwmon_compute(inputs[i]->compute, reader.signed_value(i) / cpu_feature_types[inputs[i]->kind].scale);
+        return static_cast<uint64_t>(sum);
+    }));
+    reader.stop();
+}
+
+static void bench_snmp(long iterations, std::vector<bench_result>& results) {
+    results.push_back(time_op("snmp", "encode", N_PDU_OIDS, iterations, [&](void) {
+        byte *msg = createGetRequestMessage(SNMP_V1, (byte*)"public", 6, pdu_oids, N_PDU_OIDS);
+        uint64_t size = decodeLen(&msg[1]);
+        free(msg);
+        return size;
+    }));
+    byte *msg = createGetRequestMessage(SNMP_V1, (byte*)"public", 6, pdu_oids, N_PDU_OIDS);
+    snmp_sim_agent agent = {0, std::vector<byte>(msg, msg + snmp_sim_tlv(msg, nullptr))};
+    free(msg);
+    std::vector<byte> response;
+    snmp_sim_respond(agent, response);
+    std::vector<std::string> oid_names(pdu_oids, pdu_oids + N_PDU_OIDS);
+    std::vector<int> values(N_PDU_OIDS, -1);
+    results.push_back(time_op("snmp", "decode", N_PDU_OIDS, iterations, [&](void) {
+        int detail = 0;
+        parse_snmp_response(response.data(), oid_names, values, detail);
+        uint64_t sum = 0;
+        for (std::vector<int>::iterator i = values.begin(); i != values.end(); i++) sum += *i;
+        return sum;
+    }));
+}
+
+static size_t append_body(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+static void bench_submer(long iterations, std::vector<bench_result>& results) {
+    std::string body;
+    CURL* handle = curl_easy_init();
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, append_body);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &body);
+    curl_easy_perform(handle);
+    curl_easy_cleanup(handle);
+    size_t n_fields = sizeof(curl_sim_fields) / sizeof(curl_sim_fields[0]);
+    results.push_back(time_op("submer", "parse", n_fields, iterations, [&](void) {
+        nlohmann::json data = nlohmann::json::parse(body)["data"];
+        double sum = 0;
+        for (size_t k = 0; k < n_fields; k++) {
+            const nlohmann::json& value = data[curl_sim_fields[k].name];
+            sum += value.is_number() ? value.get<double>() : NAN;
+        }
+        return static_cast<uint64_t>(sum);
+    }));
+}
+
+static void bench_format(long iterations, std::vector<bench_result>& results) {
+    for (size_t c = 0; c < sizeof(format_channels) / sizeof(format_channels[0]); c++) {
+        std::vector<sample_channel> schema;
+        sample_record record = {0, 0, 0, {}, {}};
+        for (size_t i = 0; i < format_channels[c]; i++) {
+            schema.push_back({"cpu_" + std::to_string(i) + "_freq", "cpu-" + std::to_string(i) + "-freq", "CPU " + std::to_string(i) + " Frequency", ChannelNumeric});
+            record.values.push_back(1200000 + 100000 * (i % 24) + 0.25 * i);
+        }
+        record.text.assign(format_channels[c], "");
+        record.timestamp = 12345.678901;
+        record.update_duration = 0.000123;
+        std::shared_ptr<const sample_record> sample = std::make_shared<const sample_record>(record);
+        for (short format = 0; format < count_OutputFormats; format++) {
+            // A fresh sink per timed round, so every sample is rendered and queues never fill across rounds
+            bench_result result = time_op("format", format_names[format], format_channels[c], 1, [&](void) {
+                CountingSink sink(format);
+                sink.set_lossless(true);
+                sink.start(&schema);
+                for (long i = 0; i < iterations; i++) sink.push({SinkItemSample, sample, nullptr, nullptr});
+                sink.stop(SinkStopTimeout * 60);
+                return sink.bytes;
+            });
+            result.ops = iterations;
+            result.wall_ns /= iterations;
+            result.cpu_ns /= iterations;
+            results.push_back(result);
+        }
+    }
+}
+
+// Poll for about polls cycles under the virtual clock; fills rows, data channels and the mean logged update duration
+static bool run_sensors(const std::string& dir, long polls, const std::vector<std::string>& extra, run_result& run,
+                        size_t& rows, size_t& channels, double& update_s) {
+    std::string log_path = dir + "/bench.json";
+    std::vector<std::string> argv = {BenchSensorsProgram, "-c", "-Y", dir + "/sys", "-Q", dir + "/proc", "-V",
+                                     "-p", std::to_string(BenchPollInterval), "-w", std::to_string(polls * BenchPollInterval),
+                                     "-f", std::to_string(OutputJSON), "-l", log_path};
+    argv.insert(argv.end(), extra.begin(), extra.end());
+    std::filesystem::remove(log_path);
+    run = run_program(argv, dir + "/bench.err");
+    if (run.status != 0) {
+        std::cerr << "The sensing tool exited with status " << run.status << " (see " << dir << "/bench.err)" << std::endl;
+        return false;
+    }
+    sensor_log log;
+    std::string error;
+    if (read_sensor_log(log_path, reader_options(), log, error) != 0) {
+        std::cerr << "Unable to read " << log_path << ": " << error << std::endl;
+        return false;
+    }
+    rows = log.rows;
+    channels = 0;
+    for (std::vector<log_column>::iterator i = log.columns.begin(); i != log.columns.end(); i++)
+        if (i->name != "timestamp" && i->name != "poll-update-duration" && i->name != "dummy-end") channels++;
+    int duration = find_log_column(log, "poll-update-duration");
+    update_s = 0;
+    size_t counted = 0;
+    if (duration >= 0)
+        for (std::vector<double>::iterator i = log.columns[duration].values.begin(); i != log.columns[duration].values.end(); i++)
+            if (!std::isnan(*i)) {
+                update_s += *i;
+                counted++;
+            }
+    update_s = (counted == 0) ? NAN : update_s / counted;
+    return rows > 0;
+}
+
+static void bench_poll(const std::string& tmp, const std::vector<int>& core_counts, long iterations,
+                       const std::vector<std::string>& extra, std::vector<bench_result>& results) {
+    long short_polls = iterations / BenchShortRunFraction;
+    if (short_polls < 1) short_polls = 1;
+    for (std::vector<int>::const_iterator cores = core_counts.begin(); cores != core_counts.end(); cores++) {
+        std::string dir = tmp + "/poll-" + std::to_string(*cores);
+        if (!make_tree(dir, *cores)) continue;
+        run_result long_run, short_run;
+        size_t long_rows, short_rows, channels;
+        double update_s, short_update_s;
+        if (!run_sensors(dir, iterations, extra, long_run, long_rows, channels, update_s) ||
+            !run_sensors(dir, short_polls, extra, short_run, short_rows, channels, short_update_s)) continue;
+        if (long_rows <= short_rows) {
+            std::cerr << "Runs on " << *cores << " cores logged " << long_rows << " and " << short_rows << " samples; increase -i" << std::endl;
+            continue;
+        }
+        double polls = static_cast<double>(long_rows - short_rows);
+        std::string name = std::to_string(*cores) + "-cores";
+        results.push_back({"poll", name + "-cycle", channels, static_cast<long>(long_rows),
+                           (long_run.wall_s - short_run.wall_s) * 1e9 / polls, (long_run.cpu_s - short_run.cpu_s) * 1e9 / polls, long_rows});
+        results.push_back({"poll", name + "-update", channels, static_cast<long>(long_rows), update_s * 1e9, NAN, long_rows});
+        std::filesystem::remove_all(dir);
+    }
+}
+
+static void print_number(std::ostream& os, double value) {
+    if (std::isnan(value)) os << "null";
+    else os << value;
+}
+
+int main(int argc, char** argv) {
+    const struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"suite", required_argument, 0, 's'},
+        {"iterations", required_argument, 0, 'i'},
+        {"cores", required_argument, 0, 'n'},
+        {"poll-cores", required_argument, 0, 'C'},
+        {"sensor-args", required_argument, 0, 'a'},
+        {"real", no_argument, 0, 'r'},
+        {"json", no_argument, 0, 'j'},
+        {0,0,0,0}
+    };
+    const size_t n_suites = sizeof(suite_names) / sizeof(suite_names[0]);
+    std::vector<bool> selected(n_suites, false);
+    bool any_selected = false, real = false, json = false;
+    long iterations = BenchDefaultIterations;
+    int cores = BenchDefaultCores;
+    std::string poll_cores = BenchDefaultPollCores;
+    std::vector<std::string> extra;
+    int c;
+    while ((c = getopt_long(argc, argv, "hs:i:n:C:a:rj", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 's': {
+                size_t suite = 0;
+                while (suite < n_suites && std::string(optarg) != suite_names[suite]) suite++;
+                if (suite == n_suites) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg << std::endl;
+                    usage(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                selected[suite] = any_selected = true;
+                break;
+            }
+            case 'i':
+                iterations = atol(optarg);
+                break;
+            case 'n':
+                cores = atoi(optarg);
+                break;
+            case 'C':
+                poll_cores = optarg;
+                break;
+            case 'a': {
+                std::istringstream split(optarg);
+                for (std::string word; split >> word; ) extra.push_back(word);
+                break;
+            }
+            case 'r':
+                real = true;
+                break;
+            case 'j':
+                json = true;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    std::vector<int> core_counts;
+    std::istringstream split(poll_cores);
+    for (std::string count; std::getline(split, count, ','); ) core_counts.push_back(atoi(count.c_str()));
+    bool bad_counts = false;
+    for (std::vector<int>::iterator i = core_counts.begin(); i != core_counts.end(); i++) bad_counts |= (*i < 1);
+    if (iterations <= 0 || cores <= 0 || bad_counts || optind != argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (!any_selected) selected.assign(n_suites, true);
+
+    char tmp_template[] = "/tmp/sensortools_bench.XXXXXX";
+    if (mkdtemp(tmp_template) == nullptr) {
+        std::cerr << "Unable to create a directory for simulated trees" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::string tmp = tmp_template;
+    std::string root = tmp + "/tree";
+    if ((selected[0] || selected[1]) && !real && !make_tree(root, cores)) selected[0] = selected[1] = false;
+
+    std::vector<bench_result> results;
+    if (selected[0]) bench_cpufreq(real ? "" : root, iterations, results);
+    if (selected[1]) bench_libsensors(real ? "" : root, iterations, results);
+    if (selected[2]) bench_snmp(iterations, results);
+    if (selected[3]) bench_submer(iterations, results);
+    if (selected[4]) bench_format(iterations, results);
+    if (selected[5]) bench_poll(tmp, core_counts, iterations, extra, results);
+    std::filesystem::remove_all(tmp);
+
+    if (json) {
+        std::cout << "{\"benchmark\": \"sensortools\", \"version\": \"" << SensorToolsVersion << "\", \"iterations\": " << iterations <<
+                     ", \"real-sysfs\": " << (real ? "true" : "false") << ", \"results\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            std::cout << (i ? ", " : "") << "{\"suite\": \"" << results[i].suite << "\", \"name\": \"" << results[i].name <<
+                         "\", \"items\": " << results[i].items << ", \"ops\": " << results[i].ops << ", \"wall-ns-per-op\": ";
+            print_number(std::cout, results[i].wall_ns);
+            std::cout << ", \"cpu-ns-per-op\": ";
+            print_number(std::cout, results[i].cpu_ns);
+            std::cout << "}";
+        }
+        std::cout << "]}" << std::endl;
+    }
+    else {
+        std::cout << "sensortools " << SensorToolsVersion << " benchmarks, " << iterations << " iterations" << std::endl;
+        std::cout << std::left << std::setw(12) << "suite" << std::setw(22) << "name" << std::right << std::setw(8) << "items" <<
+                     std::setw(16) << "wall ns/op" << std::setw(16) << "cpu ns/op" << std::setw(16) << "wall ns/item" << std::endl;
+        for (std::vector<bench_result>::iterator i = results.begin(); i != results.end(); i++) {
+            std::cout << std::left << std::setw(12) << i->suite << std::setw(22) << i->name << std::right << std::setw(8) << i->items <<
+                         std::fixed << std::setprecision(1) << std::setw(16) << i->wall_ns << std::setw(16);
+            if (std::isnan(i->cpu_ns)) std::cout << "-";
+            else std::cout << i->cpu_ns;
+            std::cout << std::setw(16);
+            if (i->items == 0) std::cout << "-";
+            else std::cout << i->wall_ns / i->items;
+            std::cout << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
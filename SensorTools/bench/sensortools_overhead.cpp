@@ -0,0 +1,401 @@
+/*
+    sensortools_overhead: how much running the sensing tool slows a workload down
+
+    Runs a workload repeatedly on its own (the baseline) and wrapped by the sensing tool (`sensors -p X [collectors] -- cmd`)
+    for every combination of poll interval and collector set, interleaving configurations round-robin so drift in the host
+    (thermal state, background load) spreads over all of them rather than biasing one.
+    The workload is any command given after --, such as one of the Benchmarks/*.sh scripts, or a built-in CPU kernel that
+    performs a fixed amount of work on every core.
+    Only the workload itself is timed: it runs under this program's own timing shim, so the tool's startup, caching and
+    shutdown are not counted, and the shim costs the same with and without the tool.
+    Each configuration reports its mean runtime with a 95% confidence interval, and its slowdown relative to the baseline
+    with a 95% confidence interval from Welch's t-test; -j prints everything as JSON for publishing per-host overhead tables.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../definitions.h" // SensorToolsVersion, NAME_BUFFER_SIZE
+#include <nlohmann/json.hpp> // String escaping in JSON results
+
+#include <iostream> // std file descriptors
+#include <iomanip> // setw and setprecision
+#include <fstream> // Shim results and /proc/cpuinfo
+#include <sstream> // Splitting lists
+#include <string> // String class and manipulation
+#include <vector> // Configurations and runtimes
+#include <thread> // Kernel threads
+#include <chrono> // Workload timing
+#include <cmath> // sqrt(), NAN, isnan()
+#include <cstdlib> // mkdtemp(), atoi(), atof()
+#include <filesystem> // Scratch directory cleanup
+#include <getopt.h> // provides getopt-long() definition
+#include <fcntl.h> // open()
+#include <unistd.h> // fork(), execv(), readlink(), gethostname()
+#include <sys/wait.h> // waitpid()
+// End Headers
+
+#define OverheadDefaultRuns 10 // Timed runs of every configuration
+#define OverheadDefaultWarmups 1 // Untimed runs of every configuration before timing starts
+#define OverheadDefaultPolls "1,0.1,0.01" // Poll intervals (seconds) swept by default
+#define OverheadDefaultCollectors "-c" // Collector set used when none are given
+#define OverheadDefaultKernelWork 500 // Million iterations per thread of the built-in kernel
+
+// Class and Type declarations
+// One way of running the workload; the baseline has an empty sensors command
+typedef struct overhead_config_t {
+    double poll = 0;
+    std::string collectors;
+    std::vector<double> runtimes; // Seconds
+} overhead_config;
+
+// Mean with its 95% confidence interval half-width
+typedef struct overhead_summary_t {
+    double mean, stddev, ci;
+} overhead_summary;
+// End Class and Type declarations
+
+static volatile double kernel_sink; // Keeps the kernel's result, so its work cannot be optimized away
+
+void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] [-- command [args...]]" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-n [runs] | --runs [runs]\n\t\t" <<
+                 "Timed runs of every configuration (default: " << OverheadDefaultRuns << ")" << std::endl;
+    std::cout << "\t-W [runs] | --warmups [runs]\n\t\t" <<
+                 "Untimed runs of every configuration before timing starts (default: " << OverheadDefaultWarmups << ")" << std::endl;
+    std::cout << "\t-p [list] | --polls [list]\n\t\t" <<
+                 "Comma-separated poll intervals in seconds to run the sensing tool at (default: " << OverheadDefaultPolls << ")" << std::endl;
+    std::cout << "\t-s [args] | --collectors [args]\n\t\t" <<
+                 "Space-separated collector arguments for the sensing tool, ie: \"-c -z\"; may be repeated to sweep several sets (default: " <<
+                 OverheadDefaultCollectors << ")" << std::endl;
+    std::cout << "\t-k [work] | --kernel [work]\n\t\t" <<
+                 "Use the built-in CPU kernel as the workload, with [work] million iterations per thread (default without a command: " <<
+                 OverheadDefaultKernelWork << ")" << std::endl;
+    std::cout << "\t-t [threads] | --threads [threads]\n\t\t" <<
+                 "Threads of the built-in kernel (default: every hardware thread)" << std::endl;
+    std::cout << "\t-S [path] | --sensors [path]\n\t\t" <<
+                 "Sensing tool to wrap the workload with (default: " << OverheadSensorsProgram << ")" << std::endl;
+    std::cout << "\t-j | --json\n\t\t" <<
+                 "Print results as JSON" << std::endl;
+    std::cout << "\t-X [file] | --time-to [file]\n\t\t" <<
+                 "Internal: run the command, writing its runtime and exit status to [file]" << std::endl;
+    std::cout << "\t-K | --run-kernel\n\t\t" <<
+                 "Internal: run the built-in kernel with the -k and -t settings" << std::endl;
+}
+
+// Dependent floating-point chain: keeps a core's execution units busy without touching memory
+static void run_kernel(long work, int threads) {
+    std::vector<std::thread> workers;
+    std::vector<double> results(threads, 0);
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&results, t, work](void) {
+            double x = 1.0 + t, y = 0.5;
+            for (long i = 0; i < work * 1000000; i++) {
+                x = x * 0.9999999 + y;
+                y = y * 0.9999999 - 1e-9 * x;
+            }
+            results[t] = x + y;
+        });
+    double sum = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].join();
+        sum += results[t];
+    }
+    kernel_sink = sum;
+}
+
+// Fork and exec argv, returning its exit status (-1 when it could not be run or was killed)
+static int run_command(const std::vector<std::string>& argv, const std::string& log) {
+    std::vector<char*> cargv;
+    for (std::vector<std::string>::const_iterator i = argv.begin(); i != argv.end(); i++) cargv.push_back(const_cast<char*>(i->c_str()));
+    cargv.push_back(nullptr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (!log.empty()) {
+            int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (fd >= 0) {
+                dup2(fd, STDOUT_FILENO);
+                dup2(fd, STDERR_FILENO);
+                close(fd);
+            }
+        }
+        execvp(cargv[0], cargv.data());
+        _exit(127);
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Timing shim: run the command and report how long it took
+static int time_command(const std::string& result_path, const std::vector<std::string>& command) {
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    int status = run_command(command, "");
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ofstream result(result_path);
+    result << std::setprecision(9) << elapsed << " " << status << std::endl;
+    return (status < 0) ? EXIT_FAILURE : status;
+}
+
+// Two-sided 95% critical value of Student's t, interpolated in 1/df between tabulated degrees of freedom
+static double t95(double df) {
+    static const double dfs[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 15, 20, 25, 30, 40, 60, 120};
+    static const double ts[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                2.179, 2.131, 2.086, 2.060, 2.042, 2.021, 2.000, 1.980};
+    const size_t n = sizeof(dfs) / sizeof(dfs[0]);
+    if (df <= dfs[0]) return ts[0];
+    for (size_t i = 1; i < n; i++)
+        if (df <= dfs[i]) {
+            double w = (1 / dfs[i - 1] - 1 / df) / (1 / dfs[i - 1] - 1 / dfs[i]);
+            return ts[i - 1] + w * (ts[i] - ts[i - 1]);
+        }
+    double w = (1 / dfs[n - 1] - 1 / df) * dfs[n - 1];
+    return ts[n - 1] + w * (1.960 - ts[n - 1]);
+}
+
+static overhead_summary summarize(const std::vector<double>& values) {
+    overhead_summary summary = {0, 0, NAN};
+    for (std::vector<double>::const_iterator i = values.begin(); i != values.end(); i++) summary.mean += *i;
+    summary.mean /= values.size();
+    for (std::vector<double>::const_iterator i = values.begin(); i != values.end(); i++) summary.stddev += (*i - summary.mean) * (*i - summary.mean);
+    if (values.size() > 1) {
+        summary.stddev = sqrt(summary.stddev / (values.size() - 1));
+        summary.ci = t95(values.size() - 1) * summary.stddev / sqrt(values.size());
+    }
+    return summary;
+}
+
+// Difference of means (config - baseline) with its Welch 95% confidence interval half-width
+static void welch(const std::vector<double>& config, const std::vector<double>& baseline, double& difference, double& ci) {
+    overhead_summary c = summarize(config), b = summarize(baseline);
+    difference = c.mean - b.mean;
+    double vc = c.stddev * c.stddev / config.size(), vb = b.stddev * b.stddev / baseline.size();
+    if (config.size() < 2 || baseline.size() < 2 || vc + vb == 0) {
+        ci = (vc + vb == 0 && config.size() > 1 && baseline.size() > 1) ? 0 : NAN;
+        return;
+    }
+    double df = (vc + vb) * (vc + vb) / (vc * vc / (config.size() - 1) + vb * vb / (baseline.size() - 1));
+    ci = t95(df) * sqrt(vc + vb);
+}
+
+static std::string cpu_model(void) {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line); )
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos)
+            return line.substr(line.find(':') + 2);
+    return "unknown";
+}
+
+static std::string format_poll(double poll) {
+    std::ostringstream text;
+    text << poll;
+    return text.str();
+}
+
+static void print_json_number(std::ostream& os, double value) {
+    if (std::isnan(value)) os << "null";
+    else os << value;
+}
+
+int main(int argc, char** argv) {
+    const struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"runs", required_argument, 0, 'n'},
+        {"warmups", required_argument, 0, 'W'},
+        {"polls", required_argument, 0, 'p'},
+        {"collectors", required_argument, 0, 's'},
+        {"kernel", required_argument, 0, 'k'},
+        {"threads", required_argument, 0, 't'},
+        {"sensors", required_argument, 0, 'S'},
+        {"json", no_argument, 0, 'j'},
+        {"time-to", required_argument, 0, 'X'},
+        {"run-kernel", no_argument, 0, 'K'},
+        {0,0,0,0}
+    };
+    int runs = OverheadDefaultRuns, warmups = OverheadDefaultWarmups, threads = std::thread::hardware_concurrency();
+    long kernel_work = 0;
+    std::string polls = OverheadDefaultPolls, sensors = OverheadSensorsProgram, time_to;
+    std::vector<std::string> collector_sets;
+    bool json = false, kernel_only = false;
+    int c;
+    while ((c = getopt_long(argc, argv, "hn:W:p:s:k:t:S:jX:K", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 'n':
+                runs = atoi(optarg);
+                break;
+            case 'W':
+                warmups = atoi(optarg);
+                break;
+            case 'p':
+                polls = optarg;
+                break;
+            case 's':
+                collector_sets.push_back(optarg);
+                break;
+            case 'k':
+                kernel_work = atol(optarg);
+                if (kernel_work <= 0) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            case 'S':
+                sensors = optarg;
+                break;
+            case 'j':
+                json = true;
+                break;
+            case 'X':
+                time_to = optarg;
+                break;
+            case 'K':
+                kernel_only = true;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    std::vector<std::string> command(argv + optind, argv + argc);
+    if (kernel_work == 0) kernel_work = OverheadDefaultKernelWork;
+    if (threads < 1) threads = 1;
+    if (kernel_only) {
+        run_kernel(kernel_work, threads);
+        return EXIT_SUCCESS;
+    }
+    if (!time_to.empty()) {
+        if (command.empty()) {
+            usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        return time_command(time_to, command);
+    }
+
+    std::vector<double> poll_values;
+    std::istringstream split(polls);
+    for (std::string poll; std::getline(split, poll, ','); ) poll_values.push_back(atof(poll.c_str()));
+    bool bad_polls = poll_values.empty();
+    for (std::vector<double>::iterator i = poll_values.begin(); i != poll_values.end(); i++) bad_polls |= (*i <= 0);
+    if (runs < 1 || warmups < 0 || bad_polls) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (collector_sets.empty()) collector_sets.push_back(OverheadDefaultCollectors);
+
+    // The shim and kernel are this same program, found again through /proc so it works from any working directory
+    char self[4096];
+    ssize_t self_len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (self_len <= 0) {
+        std::cerr << "Unable to locate this program for its timing shim" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    self[self_len] = '\0';
+    bool kernel = command.empty();
+    std::string workload;
+    if (kernel) {
+        command = {self, "-K", "-k", std::to_string(kernel_work), "-t", std::to_string(threads)};
+        workload = "built-in kernel, " + std::to_string(kernel_work) + "M iterations on " + std::to_string(threads) + " threads";
+    }
+    else
+        for (std::vector<std::string>::iterator i = command.begin(); i != command.end(); i++) workload += (i == command.begin() ? "" : " ") + *i;
+
+    char tmp_template[] = "/tmp/sensortools_overhead.XXXXXX";
+    if (mkdtemp(tmp_template) == nullptr) {
+        std::cerr << "Unable to create a scratch directory" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::string tmp = tmp_template, result_path = tmp + "/runtime", sensor_log = tmp + "/sensors.log", output_log = tmp + "/output.log";
+
+    std::vector<overhead_config> configs(1); // Baseline first
+    for (std::vector<std::string>::iterator set = collector_sets.begin(); set != collector_sets.end(); set++)
+        for (std::vector<double>::iterator poll = poll_values.begin(); poll != poll_values.end(); poll++) {
+            overhead_config config;
+            config.poll = *poll;
+            config.collectors = *set;
+            configs.push_back(config);
+        }
+
+    // Every round runs each configuration once, starting one further along each time
+    for (int round = 0; round < warmups + runs; round++) {
+        for (size_t k = 0; k < configs.size(); k++) {
+            overhead_config& config = configs[(round + k) % configs.size()];
+            std::vector<std::string> argv_run;
+            if (config.poll > 0) {
+                argv_run = {sensors, "-p", format_poll(config.poll), "-l", sensor_log};
+                std::istringstream words(config.collectors);
+                for (std::string word; words >> word; ) argv_run.push_back(word);
+                argv_run.push_back("--");
+                std::filesystem::remove(sensor_log);
+            }
+            argv_run.insert(argv_run.end(), {self, "-X", result_path, "--"});
+            argv_run.insert(argv_run.end(), command.begin(), command.end());
+            std::filesystem::remove(result_path);
+            int status = run_command(argv_run, output_log);
+            double runtime = -1;
+            int workload_status = -1;
+            std::ifstream(result_path) >> runtime >> workload_status;
+            if (status != 0 || workload_status != 0 || runtime < 0) {
+                std::cerr << "Run failed with status " << status << " (workload status " << workload_status << "); output kept in " << output_log << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (round >= warmups) config.runtimes.push_back(runtime);
+        }
+        if (!json) std::cerr << "Finished round " << round + 1 << " of " << warmups + runs << (round < warmups ? " (warmup)" : "") << std::endl;
+    }
+    std::filesystem::remove_all(tmp);
+
+    char hostname[NAME_BUFFER_SIZE] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    overhead_summary baseline = summarize(configs[0].runtimes);
+    if (json) {
+        std::cout << "{\"benchmark\": \"overhead\", \"version\": \"" << SensorToolsVersion << "\", \"host\": " << nlohmann::json(hostname).dump() <<
+                     ", \"cpu-model\": " << nlohmann::json(cpu_model()).dump() << ", \"hardware-threads\": " << std::thread::hardware_concurrency() <<
+                     ", \"workload\": " << nlohmann::json(workload).dump() << ", \"runs\": " << runs << ", \"configurations\": [";
+        for (size_t k = 0; k < configs.size(); k++) {
+            overhead_summary summary = summarize(configs[k].runtimes);
+            double difference, ci;
+            welch(configs[k].runtimes, configs[0].runtimes, difference, ci);
+            if (k == 0) ci = NAN; // The baseline is not compared with itself
+            std::cout << (k ? ", " : "") << "{\"poll\": ";
+            if (k == 0) std::cout << "null, \"collectors\": null";
+            else std::cout << configs[k].poll << ", \"collectors\": " << nlohmann::json(configs[k].collectors).dump();
+            std::cout << ", \"runtimes\": [";
+            for (size_t i = 0; i < configs[k].runtimes.size(); i++) std::cout << (i ? ", " : "") << configs[k].runtimes[i];
+            std::cout << "], \"mean\": " << summary.mean << ", \"stddev\": " << summary.stddev << ", \"ci95\": ";
+            print_json_number(std::cout, summary.ci);
+            std::cout << ", \"overhead-seconds\": " << difference << ", \"overhead-ci95\": ";
+            print_json_number(std::cout, ci);
+            std::cout << ", \"overhead-percent\": " << 100 * difference / baseline.mean << "}";
+        }
+        std::cout << "]}" << std::endl;
+    }
+    else {
+        std::cout << "Workload: " << workload << std::endl;
+        std::cout << "Host: " << hostname << " (" << cpu_model() << ", " << std::thread::hardware_concurrency() << " hardware threads), " <<
+                     runs << " runs per configuration, 95% confidence intervals" << std::endl;
+        std::cout << std::left << std::setw(10) << "poll" << std::setw(20) << "collectors" << std::right << std::setw(12) << "mean s" <<
+                     std::setw(12) << "+/- s" << std::setw(12) << "overhead %" << std::setw(24) << "overhead % interval" << std::endl;
+        for (size_t k = 0; k < configs.size(); k++) {
+            overhead_summary summary = summarize(configs[k].runtimes);
+            std::cout << std::left << std::setw(10) << ((k == 0) ? "none" : format_poll(configs[k].poll)) <<
+                         std::setw(20) << ((k == 0) ? "-" : configs[k].collectors) << std::right << std::fixed << std::setprecision(4) <<
+                         std::setw(12) << summary.mean << std::setw(12) << summary.ci;
+            if (k == 0) {
+                std::cout << std::setw(12) << "-" << std::setw(24) << "-" << std::endl;
+                continue;
+            }
+            double difference, ci;
+            welch(configs[k].runtimes, configs[0].runtimes, difference, ci);
+            std::ostringstream interval;
+            interval << std::fixed << std::setprecision(2) << "[" << 100 * (difference - ci) / baseline.mean << ", " << 100 * (difference + ci) / baseline.mean << "]";
+            std::cout << std::setprecision(2) << std::setw(12) << 100 * difference / baseline.mean << std::setw(24) << interval.str() << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -3,6 +3,14 @@
 #cmakedefine BUILD_SUBMER
 #cmakedefine BUILD_NVME
 #cmakedefine BUILD_PDU
+#cmakedefine BUILD_RAPL
+#cmakedefine BUILD_CGROUP
+#cmakedefine BUILD_SYSSTAT
+#cmakedefine BUILD_NET
+#cmakedefine BUILD_DISK
+#cmakedefine BUILD_THERMAL
+#cmakedefine BUILD_UNCORE
+#cmakedefine BUILD_REPLAY
 #cmakedefine SERVER_MAIN
 #ifdef SERVER_MAIN
 #include "common_driver_server.h"
@@ -12,6 +20,9 @@
 
 // Variable declarations
 std::chrono::time_point<std::chrono::system_clock> t_minus_one;
+EventChannel events;
+SinkGraph sinks;
+uint64_t samples_logged = 0;
 #ifdef SERVER_MAIN
 int master_socket = -1;
 std::vector<int> client_sockets;
@@ -24,14 +35,15 @@ int main(int argc, char** argv) {
 }
 
 void init_libsensorstools(int argc, char** argv) {
-    t_minus_one = std::chrono::system_clock::now();
+    t_minus_one = poll_clock.now();
 
     // Command line argument parsing
     parse(argc, argv);
+    poll_clock.configure(args.virtual_clock);
 
     // Library initializations
-    #ifdef BUILD_CPU
-    if (args.cpu) {
+    #if defined(BUILD_CPU) && defined(CPU_LIBSENSORS_ENABLED)
+    if (args.cpu && !args.hwmon) {
         int error = sensors_init(NULL);
         if (error != 0) {
             args.error_log << "LibSensors library did not initialize properly! Aborting..." << std::endl;
@@ -50,6 +62,30 @@ void init_libsensorstools(int argc, char** argv) {
     #ifdef BUILD_PDU
     // No libraries to initialize
     #endif
+    #ifdef BUILD_RAPL
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_CGROUP
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_SYSSTAT
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_NET
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_DISK
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_THERMAL
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_UNCORE
+    // No libraries to initialize
+    #endif
+    #ifdef BUILD_REPLAY
+    // No libraries to initialize
+    #endif
 
     // Prepare for graceful shutdown via CTRL+C and other common signals
     struct sigaction sigHandler;
@@ -61,14 +97,27 @@ void init_libsensorstools(int argc, char** argv) {
     sigaction(SIGTERM, &sigHandler, NULL);
     // SIGKILL and SIGSTOP cannot be caught, blocked or ignored -- nor should they
 
-    // !! Error-log uses this message as a timestamp synchronization point. It should not be guarded by debug level! !!
-    args.error_log << "The program lives" << std::endl;
-    if (args.format == OutputJSON) {
-        args.log << "[" << std::endl;
-        args.log << "{\"arguments\": { " << std::endl <<
+    // Sink graph: the main log is always the first sink, followed by any requested with -S
+    sinks.add_output(&args.log, args.format, "log");
+    for (std::vector<sink_spec>::iterator i = args.sinks.begin(); i != args.sinks.end(); i++)
+        if (!sinks.add(*i, args.error_log)) exit(EXIT_FAILURE);
+
+    // Event timeline: inline in JSON sinks, in a sidecar when requested, and always as legacy error-log lines
+    events.configure(args.format, &args.error_log, t_minus_one);
+    events.add_listener([](const event_record& record) { sinks.publish_event(record); });
+    if (!args.event_log_path.empty()) events.add_destination(&args.event_log, true);
+    events.emit(EventProgramStart, samples_logged);
+    if (sinks.has_format(OutputJSON)) {
+        std::ostringstream block;
+        block << "{\"arguments\": { " << std::endl <<
                     "\t\"help\": " << args.help << "," << std::endl <<
                     #ifdef BUILD_CPU
                     "\t\"cpu\": " << args.cpu << "," << std::endl <<
+                    "\t\"hwmon\": " << args.hwmon << "," << std::endl <<
+                    "\t\"cpu-features\": " << args.cpu_features << "," << std::endl <<
+                    "\t\"core-stats\": " << args.core_stats << "," << std::endl <<
+                    "\t\"aggregate\": " << args.aggregate_levels << "," << std::endl <<
+                    "\t\"aggregate-only\": " << args.aggregate_only << "," << std::endl <<
                     #endif
                     #ifdef BUILD_GPU
                     "\t\"gpu\": " << args.gpu << "," << std::endl <<
@@ -82,36 +131,71 @@ void init_libsensorstools(int argc, char** argv) {
                     #ifdef BUILD_PDU
                     "\t\"pdu\": " << args.pdu << "," << std::endl <<
                     #endif
+                    #ifdef BUILD_RAPL
+                    "\t\"rapl\": " << args.rapl << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_CGROUP
+                    "\t\"cgroup\": " << args.cgroup << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_SYSSTAT
+                    "\t\"sysstat\": " << args.sysstat << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_NET
+                    "\t\"net\": " << args.net << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_DISK
+                    "\t\"disk\": " << args.disk << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_THERMAL
+                    "\t\"thermal\": " << args.thermal << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_UNCORE
+                    "\t\"uncore\": " << args.uncore << "," << std::endl <<
+                    #endif
+                    #ifdef BUILD_REPLAY
+                    "\t\"replay\": " << (args.replay ? nlohmann::json(args.replay_log) : nlohmann::json(nullptr)).dump() << "," << std::endl <<
+                    "\t\"replay-speed\": " << args.replay_speed << "," << std::endl <<
+                    #endif
                     #ifdef SERVER_MAIN
                     "\t\"clients\": " << args.clients << "," << std::endl <<
                     #else
                     "\t\"ip-address\": \"" << ((args.ip_addr == nullptr) ? "N/A" : args.ip_addr) << "\"," << std::endl <<
                     "\t\"connection-attempts\": \"" << args.connection_attempts << "\"," << std::endl <<
+                    "\t\"reads\": " << args.read_engine << "," << std::endl <<
+                    "\t\"sysfs-root\": " << (sysfs_root.empty() ? nlohmann::json(nullptr) : nlohmann::json(sysfs_root)).dump() << "," << std::endl <<
+                    "\t\"procfs-root\": " << (procfs_root.empty() ? nlohmann::json(nullptr) : nlohmann::json(procfs_root)).dump() << "," << std::endl <<
+                    "\t\"markers\": " << (args.markers_path.empty() ? nlohmann::json(nullptr) : nlohmann::json(args.markers_path)).dump() << "," << std::endl <<
+                    #ifdef SIMULATED_HW
+                    "\t\"simulate\": " << nlohmann::json(simulation.spec).dump() << "," << std::endl <<
+                    #endif
                     #endif
-                    "\t\"format\": \"json\"," << std::endl <<
+                    "\t\"format\": \"" << ((args.format == OutputCSV) ? "csv" : (args.format == OutputHuman) ? "human-readable" : "json") << "\"," << std::endl <<
                     "\t\"log\": \"" << args.log << "\"," << std::endl <<
                     "\t\"error-log\": \"" << args.error_log << "\"," << std::endl <<
+                    "\t\"event-log\": " << (args.event_log_path.empty() ? nlohmann::json(nullptr) : nlohmann::json(args.event_log_path.string())).dump() << "," << std::endl <<
+                    "\t\"sinks\": " << nlohmann::json(sinks.describe()).dump() << "," << std::endl <<
+                    "\t\"frame\": " << args.frame << "," << std::endl <<
                     "\t\"poll\": " << args.poll << "," << std::endl <<
                     "\t\"initial-wait\": " << args.initial_wait << "," << std::endl <<
                     "\t\"post-wait\": " << args.post_wait << "," << std::endl <<
                     "\t\"timeout\": " << args.timeout << "," << std::endl <<
+                    "\t\"virtual-clock\": " << args.virtual_clock << "," << std::endl <<
                     "\t\"debug\": " << args.debug << "," << std::endl <<
                     "\t\"version\": \"" << args.version << "\"," << std::endl <<
-                    "\t\"wrapped-call\": ";
-        if (args.wrapped != nullptr) {
-            int argidx = 0;
-            args.log << "\"";
-            while(args.wrapped[argidx] != nullptr) args.log << args.wrapped[argidx++] << " ";
-            args.log << "\"" << std::endl;
-        }
-        else args.log << "null" << std::endl;
-        args.log << "\t}" << std::endl << "}," << std::endl;
+                    "\t\"wrapped-call\": " << ((args.wrapped != nullptr) ? nlohmann::json(wrapped_command_string()) : nlohmann::json(nullptr)).dump() << std::endl;
+        block << "\t}" << std::endl << "}," << std::endl;
+        sinks.broadcast(OutputJSON, block.str());
     }
-    else if (args.debug >= DebugMinimal) {
+    if (args.format != OutputJSON && args.debug >= DebugMinimal) {
         args.error_log << "Arguments evaluate to" << std::endl <<
         "Help: " << args.help << std::endl <<
         #ifdef BUILD_CPU
         "CPU: " << args.cpu << std::endl <<
+        "hwmon: " << args.hwmon << std::endl <<
+        "CPU features: " << args.cpu_features << std::endl <<
+        "Core stats: " << args.core_stats << std::endl <<
+        "Aggregate levels: " << args.aggregate_levels << std::endl <<
+        "Aggregate only: " << args.aggregate_only << std::endl <<
         #endif
         #ifdef BUILD_GPU
         "GPU: " << args.gpu << std::endl <<
@@ -125,11 +209,43 @@ void init_libsensorstools(int argc, char** argv) {
         #ifdef BUILD_PDU
         "PDU: " << args.pdu << std::endl <<
         #endif
+        #ifdef BUILD_RAPL
+        "RAPL: " << args.rapl << std::endl <<
+        #endif
+        #ifdef BUILD_CGROUP
+        "Cgroup: " << args.cgroup << std::endl <<
+        #endif
+        #ifdef BUILD_SYSSTAT
+        "Sysstat: " << args.sysstat << std::endl <<
+        #endif
+        #ifdef BUILD_NET
+        "Network: " << args.net << std::endl <<
+        #endif
+        #ifdef BUILD_DISK
+        "Disk: " << args.disk << std::endl <<
+        #endif
+        #ifdef BUILD_THERMAL
+        "Thermal: " << args.thermal << std::endl <<
+        #endif
+        #ifdef BUILD_UNCORE
+        "Uncore: " << args.uncore << std::endl <<
+        #endif
+        #ifdef BUILD_REPLAY
+        "Replay: " << (args.replay ? args.replay_log : "N/A") << std::endl <<
+        "Replay speed: " << args.replay_speed << std::endl <<
+        #endif
         #ifdef SERVER_MAIN
         "Clients: " << args.clients << std::endl <<
         #else
         "IP Address: " << ((args.ip_addr == nullptr) ? "N/A" : args.ip_addr) << std::endl <<
         "Connection Attempts: " << args.connection_attempts << std::endl <<
+        "Reads: " << args.read_engine << std::endl <<
+        "Sysfs root: " << (sysfs_root.empty() ? "/sys" : sysfs_root) << std::endl <<
+        "Procfs root: " << (procfs_root.empty() ? "/proc" : procfs_root) << std::endl <<
+        "Markers: " << (args.markers_path.empty() ? "N/A" : args.markers_path) << std::endl <<
+        #ifdef SIMULATED_HW
+        "Simulate: " << simulation.spec << std::endl <<
+        #endif
         #endif
         "Format: ";
         switch(args.format) {
@@ -143,10 +259,14 @@ void init_libsensorstools(int argc, char** argv) {
         }
         args.error_log << std::endl << "Log: " << args.log << std::endl <<
         "Error log: " << args.error_log << std::endl <<
+        "Event log: " << (args.event_log_path.empty() ? "N/A" : args.event_log_path.string()) << std::endl <<
+        "Sinks: " << nlohmann::json(sinks.describe()).dump() << std::endl <<
+        "Frame: " << args.frame << std::endl <<
         "Poll: " << args.poll << std::endl <<
         "Initial Wait: " << args.initial_wait << std::endl <<
         "Post Wait: " << args.post_wait << std::endl <<
         "Connection Timeout: " << args.timeout << std::endl <<
+        "Virtual clock: " << args.virtual_clock << std::endl <<
         "Debug: " << args.debug << std::endl <<
         "Version: " << args.version << std::endl <<
         "Wrapped call: ";
@@ -159,11 +279,12 @@ void init_libsensorstools(int argc, char** argv) {
     }
 
     // Denote library versions
-    if (args.format == OutputJSON) {
-        args.log << "{\"versions\": {" << std::endl <<
+    if (sinks.has_format(OutputJSON)) {
+        std::ostringstream block;
+        block << "{\"versions\": {" << std::endl <<
                     "\t\"SensorTools\": \"" << SensorToolsVersion << "\"," << std::endl;
-        #ifdef BUILD_CPU
-        args.log << "\t\"LibSensors\": \"" << libsensors_version << "\"," << std::endl;
+        #if defined(BUILD_CPU) && defined(CPU_LIBSENSORS_ENABLED)
+        block << "\t\"LibSensors\": \"" << libsensors_version << "\"," << std::endl;
         #endif
         #ifdef BUILD_GPU
             #ifdef GPU_ENABLED
@@ -171,27 +292,52 @@ void init_libsensorstools(int argc, char** argv) {
             char NVML_DRIVER_VERSION[NAME_BUFFER_SIZE];
             nvmlSystemGetCudaDriverVersion(&NVML_VERSION);
             nvmlSystemGetDriverVersion(NVML_DRIVER_VERSION, NAME_BUFFER_SIZE);
-            args.log << "\t\"NVML\": \"" << NVML_VERSION << "\"," << std::endl <<
+            block << "\t\"NVML\": \"" << NVML_VERSION << "\"," << std::endl <<
                         "\t\"NVIDIA Driver\": \"" << NVML_DRIVER_VERSION << "\"," << std::endl;
             #endif
         #endif
         #ifdef BUILD_SUBMER
-        args.log << "\t\"LibCurl\": \"" << curl_version() << "\"," << std::endl;
+        block << "\t\"LibCurl\": \"" << curl_version() << "\"," << std::endl;
         #endif
         #ifdef BUILD_NVME
-        args.log << "\t\"LibNVMe\": \"" << nvme_get_version(NVME_VERSION_PROJECT) << "\"," << std::endl;
+        block << "\t\"LibNVMe\": \"" << nvme_get_version(NVME_VERSION_PROJECT) << "\"," << std::endl;
         #endif
         #ifdef BUILD_PDU
         // No libraries to log
         #endif
-        args.log << "\t\"Nlohmann_Json\": \"" <<
+        #ifdef BUILD_RAPL
+        // No libraries to log
+        #endif
+        #ifdef BUILD_CGROUP
+        // No libraries to log
+        #endif
+        #ifdef BUILD_SYSSTAT
+        // No libraries to log
+        #endif
+        #ifdef BUILD_NET
+        // No libraries to log
+        #endif
+        #ifdef BUILD_DISK
+        // No libraries to log
+        #endif
+        #ifdef BUILD_THERMAL
+        // No libraries to log
+        #endif
+        #ifdef BUILD_UNCORE
+        // No libraries to log
+        #endif
+        #ifdef BUILD_REPLAY
+        // No libraries to log
+        #endif
+        block << "\t\"Nlohmann_Json\": \"" <<
                         NLOHMANN_JSON_VERSION_MAJOR << "." <<
                         NLOHMANN_JSON_VERSION_MINOR << "." <<
                         NLOHMANN_JSON_VERSION_PATCH << "\"\t}" << std::endl << "}," << std::endl;
+        sinks.broadcast(OutputJSON, block.str());
     }
-    else if (args.debug >= DebugVerbose || args.version) {
+    if (args.format != OutputJSON && (args.debug >= DebugVerbose || args.version)) {
         args.error_log << "SensorTools v" << SensorToolsVersion << std::endl;
-        #ifdef BUILD_CPU
+        #if defined(BUILD_CPU) && defined(CPU_LIBSENSORS_ENABLED)
         args.error_log << "Using libsensors v" << libsensors_version << std::endl;
         #endif
         #ifdef BUILD_GPU
@@ -213,13 +359,42 @@ void init_libsensorstools(int argc, char** argv) {
         #ifdef BUILD_PDU
         // No libraries to log
         #endif
+        #ifdef BUILD_RAPL
+        // No libraries to log
+        #endif
+        #ifdef BUILD_CGROUP
+        // No libraries to log
+        #endif
+        #ifdef BUILD_SYSSTAT
+        // No libraries to log
+        #endif
+        #ifdef BUILD_NET
+        // No libraries to log
+        #endif
+        #ifdef BUILD_DISK
+        // No libraries to log
+        #endif
+        #ifdef BUILD_THERMAL
+        // No libraries to log
+        #endif
+        #ifdef BUILD_UNCORE
+        // No libraries to log
+        #endif
+        #ifdef BUILD_REPLAY
+        // No libraries to log
+        #endif
         args.error_log << "Nlohmann_Json: " <<
                           NLOHMANN_JSON_VERSION_MAJOR << "." <<
                           NLOHMANN_JSON_VERSION_MINOR << "." <<
                           NLOHMANN_JSON_VERSION_PATCH << std::endl;
     }
     // When version argument is supplied, OK to exit immediately after supplying version information
-    if (args.version) exit(EXIT_SUCCESS);
+    if (args.version) {
+        // JSON sinks still end with the shutdown event so they remain complete documents
+        if (sinks.has_format(OutputJSON)) events.emit(EventShutdown, samples_logged, {{"signal", EXIT_SUCCESS}});
+        sinks.stop(args.error_log);
+        exit(EXIT_SUCCESS);
+    }
 
     // Hardware Detection / caching for faster updates
     #ifdef BUILD_CPU
@@ -237,13 +412,46 @@ void init_libsensorstools(int argc, char** argv) {
     #ifdef BUILD_PDU
     cache_pdus();
     #endif
+    #ifdef BUILD_RAPL
+    cache_rapl();
+    #endif
+    #ifdef BUILD_CGROUP
+    cache_cgroup();
+    #endif
+    #ifdef BUILD_SYSSTAT
+    cache_sysstat();
+    #endif
+    #ifdef BUILD_NET
+    cache_net();
+    #endif
+    #ifdef BUILD_DISK
+    cache_disk();
+    #endif
+    #ifdef BUILD_THERMAL
+    cache_thermal();
+    #endif
+    #ifdef BUILD_UNCORE
+    cache_uncore();
+    #endif
+    #ifdef BUILD_REPLAY
+    cache_replay();
+    // A replayed log is finite, so the auxiliary sinks wait for room like the main log rather than dropping its rows
+    if (args.replay) sinks.set_lossless(true);
+    #endif
 
     #ifndef SERVER_MAIN
-    // Prepare output
-    update = true;
-    if (args.format == OutputCSV) print_csv_header();
-    else if (args.debug >= DebugVerbose) args.error_log << "Non-CSV format, no headers to set" << std::endl;
-    #else
+    // Every collector has registered its sysfs files, so the batched reader can size its ring
+    sysfs_reads.start(args.read_engine, args.error_log, args.debug);
+    if (!args.markers_path.empty()) {
+        // Failures from here on exit through shutdown(), so every sink still ends with the shutdown event
+        if (!markers.open(args.markers_path, args.error_log)) shutdown(EXIT_FAILURE);
+        // Exported now, while single-threaded, so the wrapped command inherits it without setenv() after fork
+        setenv(MarkerEnvironment, args.markers_path.c_str(), 1);
+    }
+    #endif
+    // Every collector has registered its channels, so sinks can write their headers and begin
+    sinks.start();
+    #ifdef SERVER_MAIN
     // Initialize server sockets and get clients connected
     int activity, addrlen, new_socket, opt = 1, sd, max_sd, valread;
     struct sockaddr_in address;
@@ -253,12 +461,12 @@ void init_libsensorstools(int argc, char** argv) {
     // Create master socket
     if ((master_socket = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
         args.error_log << "Socket creation failed" << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
     // Allow multiple same-host connections
     if (setsockopt(master_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) < 0) {
         args.error_log << "setsockopt failed to permit SO_REUSEADDR" << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
     // Type of socket we want created
     address.sin_family = AF_INET;
@@ -267,12 +475,12 @@ void init_libsensorstools(int argc, char** argv) {
     // Bind socket to localhost port
     if (bind(master_socket, (struct sockaddr *)&address, sizeof(address))<0) {
         args.error_log << "Socket binding failed" << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
     // Prepare to listen
     if (listen(master_socket, args.clients) < 0) {
         args.error_log << "Listen failed for requested " << args.clients << " clients" << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
     // Wait for all clients to connect
     addrlen = sizeof(address);
@@ -282,7 +490,7 @@ void init_libsensorstools(int argc, char** argv) {
         std::chrono::time_point<std::chrono::system_clock> server_timeout_now = std::chrono::system_clock::now();
         if (args.timeout > 0 && (std::chrono::duration_cast<std::chrono::nanoseconds>(server_timeout_now-server_timeout_start).count() / 1e9) >= args.timeout) {
             args.error_log << "Server received " << client_sockets.size() << "/" << args.clients << " connections; timeout " << args.timeout << " expired" << std::endl;
-            exit(EXIT_FAILURE);
+            shutdown(EXIT_FAILURE);
         }
         else if (args.timeout > 0 && args.debug >= DebugVerbose) {
             args.error_log << "Server connections incomplete: " << client_sockets.size() << "/" << args.clients << " active connections. Timeout in " << (std::chrono::duration_cast<std::chrono::nanoseconds>(server_timeout_now-server_timeout_start).count() / 1e9)-args.timeout << "s" << std::endl;
@@ -341,93 +549,15 @@ void init_libsensorstools(int argc, char** argv) {
     #endif
 }
 
-void print_csv_header() {
-    // Skip header if appending to a file that already exists
-    if ((&args.log != &std::cout) && args.log.tellp() > 0) {
-        if (args.debug >= DebugVerbose)
-            args.error_log << "No headers -- appending to existing file from " << args.log.tellp() << std::endl;
-        return;
-    } else if (args.debug >= DebugVerbose)
-        args.error_log << "Printing headers" << std::endl;
-
-    // Set headers
-    args.log << "timestamp";
-    #ifdef BUILD_CPU
-    if (args.cpu) {
-        // Temperature
-        for (std::vector<cpu_cache>::iterator i = known_cpus.begin(); i != known_cpus.end(); i++)
-            for (int j = 0; j < i->temperature.size(); j++)
-                args.log << ",cpu_" << i->chip_name << "_temperature_" << j;
-        // Frequency
-        for (std::vector<freq_cache>::iterator i = known_freqs.begin(); i != known_freqs.end(); i++)
-            args.log << ",core_" << i->coreid << "_freq";
-    }
-    #endif
-    #ifdef BUILD_GPU
-    if (args.gpu) {
-        for (std::vector<gpu_cache>::iterator i = known_gpus.begin(); i != known_gpus.end(); i++) {
-            args.log << ",gpu_" << i->device_ID << "_name,gpu_" << i->device_ID << "_gpu_temperature,gpu_" <<
-                     i->device_ID << "_mem_temperature,gpu_" << i->device_ID << "_power_usage,gpu_" <<
-                     i->device_ID << "_power_limit,gpu_" << i->device_ID << "_utilization_gpu,gpu_" <<
-                     i->device_ID << "_utilization_memory,gpu_" << i->device_ID << "_memory_used,gpu_" <<
-                     i->device_ID << "_memory_total,gpu_" << i->device_ID << "_pstate";
-        }
-    }
-    #endif
-    #ifdef BUILD_SUBMER
-    if (args.submer) {
-        for (std::vector<std::unique_ptr<submer_cache>>::iterator i = known_submers.begin(); i != known_submers.end(); i++) {
-            submer_cache* j = i->get();
-            args.log << ",submer_" << j->index << "_temperature"
-            << ",submer_" << j->index << "_consumption"
-            << ",submer_" << j->index << "_dissipation"
-            << ",submer_" << j->index << "_dissipationC"
-            << ",submer_" << j->index << "_dissipationW"
-            << ",submer_" << j->index << "_mPUE"
-            << ",submer_" << j->index << "_pump1rpm"
-            << ",submer_" << j->index << "_pump2rpm"
-            << ",submer_" << j->index << "_cti"
-            << ",submer_" << j->index << "_cto"
-            << ",submer_" << j->index << "_cf"
-            << ",submer_" << j->index << "_wti"
-            << ",submer_" << j->index << "_wto"
-            << ",submer_" << j->index << "_wf";
-        }
-    }
-    #endif
-    #ifdef BUILD_NVME
-    if (args.nvme) {
-        for (std::vector<nvme_cache>::iterator i = known_nvme.begin(); i != known_nvme.end(); i++)
-            for (int j = 0; j < i->temperature.size(); j++)
-                args.log << ",nvme_" << i->index << "_" << j << "_temperature";
-    }
-    #endif
-    #ifdef BUILD_PDU
-    if (args.pdu) {
-        for (std::vector<std::unique_ptr<pdu_cache>>::iterator i = known_pdus.begin(); i != known_pdus.end(); i++) {
-            pdu_cache *j = i->get();
-            for (int k = 0; k < j->oid_cache.field_names.size(); k++) {
-                args.log << ",pdu_" << j->index << "_" << j->oid_cache.field_names[k];
-            }
-        }
-    }
-    #endif
-    args.log << std::endl;
-}
-
 void shutdown(int signal = 0) {
-    std::chrono::time_point<std::chrono::system_clock> t0 = std::chrono::system_clock::now();
-    if (args.format == OutputJSON) {
-        args.log << "{ \"event\": \"shutdown\", \"timestamp\": " <<
-                 std::chrono::duration_cast<std::chrono::nanoseconds>(t0-t_minus_one).count() / 1e9 <<
-                 " }" << std::endl << "]" << std::endl;
-    }
-    else
-        args.error_log << "@@Shutdown at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t0-t_minus_one).count() / 1e9 << "s" << std::endl;
-    // !! Error-log uses these messages as a timestamp synchronization point. It should not be guarded by debug level! !!
-    args.error_log << "Run shutdown with signal " << signal << std::endl;
-    #ifdef BUILD_CPU
-    sensors_cleanup();
+    events.emit(EventShutdown, samples_logged, {{"signal", signal}});
+    sinks.stop(args.error_log);
+    #ifndef SERVER_MAIN
+    sysfs_reads.stop();
+    markers.close();
+    #endif
+    #if defined(BUILD_CPU) && defined(CPU_LIBSENSORS_ENABLED)
+    if (args.cpu && !args.hwmon) sensors_cleanup();
     #endif
     #ifdef BUILD_GPU
         #ifdef GPU_ENABLED
@@ -443,6 +573,30 @@ void shutdown(int signal = 0) {
     #ifdef BUILD_PDU
     // No special shutdown needed
     #endif
+    #ifdef BUILD_RAPL
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_CGROUP
+    if (args.cgroup) remove_cgroup();
+    #endif
+    #ifdef BUILD_SYSSTAT
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_NET
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_DISK
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_THERMAL
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_UNCORE
+    // No special shutdown needed
+    #endif
+    #ifdef BUILD_REPLAY
+    // No special shutdown needed
+    #endif
     #ifdef SERVER_MAIN
     // Terminate and free client sockets
     for (int i = 0; i < client_sockets.size(); i++) close(client_sockets[i]);
@@ -454,27 +608,33 @@ void shutdown(int signal = 0) {
 }
 
 void init_timing() {
-    std::chrono::time_point<std::chrono::system_clock> t0 = std::chrono::system_clock::now();
-    if (args.format == OutputJSON) args.log << "{\"event\": \"initialization\", \"duration\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t0-t_minus_one).count() / 1e9 << "}," << std::endl;
-    else args.error_log << "@@Initialized at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t0-t_minus_one).count() / 1e9 << "s" << std::endl;
+    std::chrono::time_point<std::chrono::system_clock> t0 = poll_clock.now();
+    events.emit(EventInitialization, samples_logged, {{"duration", std::chrono::duration_cast<std::chrono::nanoseconds>(t0-t_minus_one).count() / 1e9}});
 }
 
 int poll_cycle(std::chrono::time_point<std::chrono::system_clock> t0) {
     int satisfied = 0;
-    // Initial timestamp
-    std::chrono::time_point<std::chrono::system_clock> t1 = std::chrono::system_clock::now();
-    switch (args.format) {
-        case OutputHuman:
-            args.log << "Poll update at ";
-        case OutputCSV:
-            args.log << std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count() / 1e9;
-            break;
-        case OutputJSON:
-            args.log << "{\"event\": \"poll-data\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count() / 1e9 << "," << std::endl;
-            break;
+    #ifdef BUILD_REPLAY
+    // The next replayed row may not be due yet
+    if (args.replay) pace_replay();
+    #endif
+    #ifndef SERVER_MAIN
+    // Markers that arrived since the last poll belong before this sample
+    if (markers.is_open()) {
+        std::vector<nlohmann::json> received = markers.drain();
+        for (std::vector<nlohmann::json>::iterator i = received.begin(); i != received.end(); i++)
+            events.emit(EventMarker, samples_logged, *i);
     }
+    #endif
+    // Initial timestamp
+    std::chrono::time_point<std::chrono::system_clock> t1 = poll_clock.now();
 
     // Collection
+    #ifndef SERVER_MAIN
+    // One batch refreshes every cached sysfs file; collectors below only parse their slots
+    int failed_reads = sysfs_reads.read_all();
+    if (failed_reads > 0 && args.debug >= DebugVerbose) args.error_log << failed_reads << " / " << sysfs_reads.size() << " sysfs reads failed" << std::endl;
+    #endif
     #ifdef BUILD_CPU
     if (args.cpu) {
         int update = update_cpus();
@@ -515,30 +675,53 @@ int poll_cycle(std::chrono::time_point<std::chrono::system_clock> t0) {
         // satisfied += update_pdus();
     }
     #endif
+    #ifdef BUILD_RAPL
+    if (args.rapl) update_rapl();
+    #endif
+    #ifdef BUILD_CGROUP
+    if (args.cgroup) update_cgroup();
+    #endif
+    #ifdef BUILD_SYSSTAT
+    if (args.sysstat) update_sysstat();
+    #endif
+    #ifdef BUILD_NET
+    if (args.net) update_net();
+    #endif
+    #ifdef BUILD_DISK
+    if (args.disk) update_disk();
+    #endif
+    #ifdef BUILD_THERMAL
+    if (args.thermal) {
+        int update = update_thermal();
+        if (args.debug >= DebugVerbose) args.error_log << "Thermal has " << update << " / " << thermal_to_satisfy << " satisfied temperatures" << std::endl;
+        satisfied += update;
+    }
+    #endif
+    #ifdef BUILD_UNCORE
+    if (args.uncore) update_uncore();
+    #endif
+    #ifdef BUILD_REPLAY
+    if (args.replay) {
+        int update = update_replay();
+        if (args.debug >= DebugVerbose) args.error_log << "Replay has " << update << " / " << replay_to_satisfy << " satisfied temperatures" << std::endl;
+        satisfied += update;
+    }
+    #endif
     #ifdef SERVER_MAIN
     // TODO: Collection only in post-wait phases to increment satisfied
     #endif
 
     // Final timestamp
-    switch (args.format) {
-        case OutputCSV:
-        case OutputHuman:
-            args.log << std::endl;
-            if (args.debug >= DebugMinimal) {
-                std::chrono::time_point<std::chrono::system_clock> t2 = std::chrono::system_clock::now();
-                args.error_log << "Updates completed in " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t1).count() / 1e9 << "s" << std::endl;
-            }
-            break;
-        case OutputJSON:
-            std::chrono::time_point<std::chrono::system_clock> t2 = std::chrono::system_clock::now();
-            args.log << "\"poll-update-duration\": " <<
-                     std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t1).count() / 1e9 <<
-                     std::endl;
-            args.log << "}," << std::endl;
-            break;
-    }
+    std::chrono::time_point<std::chrono::system_clock> t2 = poll_clock.now();
+    if (args.format != OutputJSON && args.debug >= DebugMinimal)
+        args.error_log << "Updates completed in " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t1).count() / 1e9 << "s" << std::endl;
+    // The sample is produced once; every sink formats it on its own thread
+    sinks.publish(samples.finish(samples_logged,
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count() / 1e9,
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t1).count() / 1e9));
+    samples_logged++;
     // Sleeping between polls
-    if (args.poll != 0) std::this_thread::sleep_for(args.poll_duration);
+    if (args.poll != 0) poll_clock.sleep_for(args.poll_duration);
     return satisfied;
 }
 
@@ -547,8 +730,7 @@ void main_loop() {
 
     #ifdef SERVER_MAIN
     // All clients connected, notify them to start polling
-    // !! Error-log uses this message as a timestamp synchronization point. It should not be guarded by debug level! !!
-    args.error_log << "Server sends 'START' message to all clients" << std::endl;
+    events.emit(EventServerStart, samples_logged, {{"clients", client_sockets.size()}});
     char clientMsgBuffer[NAME_BUFFER_SIZE] = "START";
     for (std::vector<int>::iterator it = client_sockets.begin(); it != client_sockets.end(); it++) send(*it, clientMsgBuffer, NAME_BUFFER_SIZE, 0);
     #endif
@@ -563,8 +745,7 @@ void main_loop() {
 
     #ifdef SERVER_MAIN
     // Shut down all clients
-    // !! Error-log uses this message as a timestamp synchronization point. It should not be guarded by debug level! !!
-    args.error_log << "Server sends 'STOP' message to all clients" << std::endl;
+    events.emit(EventServerStop, samples_logged, {{"clients", client_sockets.size()}});
     strncpy(clientMsgBuffer, "STOP", 4);
     clientMsgBuffer[4] = '\0';
     for (std::vector<int>::iterator it = client_sockets.begin(); it != client_sockets.end(); it++) send(*it, clientMsgBuffer, NAME_BUFFER_SIZE, 0);
@@ -574,6 +755,8 @@ void main_loop() {
     #endif
 
     if (args.debug >= DebugVerbose) args.error_log << "The program ends" << std::endl;
+    if (poll_clock.is_virtual() && args.debug >= DebugMinimal)
+        args.error_log << "Virtual clock skipped " << poll_clock.skipped() << "s of sleep over " << samples_logged << " polls" << std::endl;
 
     // Shutdown without signal, normally
     shutdown();
@@ -581,8 +764,7 @@ void main_loop() {
 
 #ifndef SERVER_MAIN
 void client_connect_loop() {
-    // !! Error-log uses this message as a timestamp synchronization point. It should not be guarded by debug level! !!
-    args.error_log << "Client process attempts to connect to server at " << args.ip_addr << std::endl;
+    events.emit(EventClientConnect, samples_logged, {{"server", args.ip_addr}});
     // We will connect to a server for coordination
     int clientSocket, attempt = 0;
     struct sockaddr_in serverAddr;
@@ -592,12 +774,12 @@ void client_connect_loop() {
         std::chrono::time_point<std::chrono::system_clock> server_timeout_now = std::chrono::system_clock::now();
         if (args.timeout > 0 && (std::chrono::duration_cast<std::chrono::nanoseconds>(server_timeout_now-server_timeout_start).count() / 1e9) >= args.timeout) {
             args.error_log << "Client failed to locate server; timeout " << args.timeout << " expired" << std::endl;
-            exit(EXIT_FAILURE);
+            shutdown(EXIT_FAILURE);
         }
         // Create client socket
         if ((clientSocket = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
             args.error_log << "Socket creation failed";
-            exit(EXIT_FAILURE);
+            shutdown(EXIT_FAILURE);
         }
         serverAddr.sin_family = AF_INET;
         serverAddr.sin_addr.s_addr = inet_addr(args.ip_addr);
@@ -608,7 +790,7 @@ void client_connect_loop() {
             // Final attempt failed
             if (args.connection_attempts > 0 && attempt+1 >= args.connection_attempts) {
                 args.error_log << "Maximum server connection attempts (" << args.connection_attempts << ") exhausted. Exiting." << std::endl;
-                exit(EXIT_FAILURE);
+                shutdown(EXIT_FAILURE);
             }
             sleep(1);
             //std::this_thread::sleep_for(1); // Wait before retrying
@@ -626,8 +808,7 @@ void client_connect_loop() {
     recv(clientSocket, serverMsgBuffer, NAME_BUFFER_SIZE, 0);
     if (args.debug >= DebugVerbose) args.error_log << "Received server ready message. Begin polling" << std::endl;
     while (1) {
-        // !! Error-log uses this message as a timestamp synchronization point. It should not be guarded by debug level! !!
-        args.error_log << "Client polls iteration #" << n_polls << std::endl;
+        events.emit(EventClientPoll, samples_logged, {{"iteration", n_polls}});
         satisfied = poll_cycle(t_minus_one); // Monitor until server signals for termination
         fd_set readfds;
         FD_ZERO(&readfds);
@@ -652,25 +833,36 @@ void client_connect_loop() {
 }
 #endif
 
+// Rows a replayed log has left to emit, -1 when no log is replayed
+long replay_remaining() {
+    #ifdef BUILD_REPLAY
+    if (args.replay) return replay_rows_left();
+    #endif
+    return -1;
+}
+
 void simple_poll_cycle_loop() {
-    if (args.poll == 0) poll_cycle(t_minus_one); // Single event collection
+    if (args.poll == 0) {
+        do poll_cycle(t_minus_one); // Single event collection, or every row of a replayed log
+        while (replay_remaining() > 0);
+    }
     else {
       if (args.initial_wait != 0 || args.post_wait != 0) { // Take wait periods as time to poll
-          std::chrono::time_point<std::chrono::system_clock> timeout_start = std::chrono::system_clock::now();
+          std::chrono::time_point<std::chrono::system_clock> timeout_start = poll_clock.now();
           while (1) {
               // Timeout check for initial wait
-              std::chrono::time_point<std::chrono::system_clock> timeout_now = std::chrono::system_clock::now();
+              std::chrono::time_point<std::chrono::system_clock> timeout_now = poll_clock.now();
               if ((std::chrono::duration_cast<std::chrono::nanoseconds>(timeout_now-timeout_start).count() / 1e9) >= args.initial_wait) {
                   break;
               }
               poll_cycle(t_minus_one);
           }
-          timeout_start = std::chrono::system_clock::now();
+          timeout_start = poll_clock.now();
           // Usually there's a distinction between +/-, but not for this mode of execution
           if (args.post_wait < 0) args.post_wait *= -1;
           while (1) {
               // Timeout check for post wait
-              std::chrono::time_point<std::chrono::system_clock> timeout_now = std::chrono::system_clock::now();
+              std::chrono::time_point<std::chrono::system_clock> timeout_now = poll_clock.now();
               if ((std::chrono::duration_cast<std::chrono::nanoseconds>(timeout_now-timeout_start).count() / 1e9) >= args.post_wait) {
                   break;
               }
@@ -678,7 +870,9 @@ void simple_poll_cycle_loop() {
           }
       }
       else {
-          while (1) poll_cycle(t_minus_one); // No wrapping, monitor until the process is signaled to terminate
+          // No wrapping, monitor until the process is signaled to terminate or a replayed log ends
+          do poll_cycle(t_minus_one);
+          while (replay_remaining() != 0);
       }
     }
 }
@@ -687,8 +881,8 @@ void set_initial_temperatures() {
     #ifdef BUILD_CPU
     if (args.cpu)
         for (std::vector<cpu_cache>::iterator i = known_cpus.begin(); i != known_cpus.end(); i++)
-            for (int j = 0; j < i->temperature.size(); j++)
-                i->initial_temperature[j] = i->temperature[j];
+            for (std::vector<cpu_reading>::iterator j = i->readings.begin(); j != i->readings.end(); j++)
+                j->initial = j->value;
     #endif
     #ifdef BUILD_GPU
     if (args.gpu)
@@ -711,6 +905,34 @@ void set_initial_temperatures() {
     #ifdef BUILD_PDU
     // Not a temperature unit, nothing to do
     #endif
+    #ifdef BUILD_RAPL
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_CGROUP
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_SYSSTAT
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_NET
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_DISK
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_THERMAL
+    if (args.thermal)
+        for (std::vector<thermal_zone_cache>::iterator i = known_thermal_zones.begin(); i != known_thermal_zones.end(); i++)
+            i->initial = i->temperature;
+    #endif
+    #ifdef BUILD_UNCORE
+    // Not a temperature unit, nothing to do
+    #endif
+    #ifdef BUILD_REPLAY
+    if (args.replay && replay.row >= 0)
+        for (std::vector<replay_channel>::iterator i = replay.channels.begin(); i != replay.channels.end(); i++)
+            if (i->temperature) i->initial = replay.log.columns[i->column].values[replay.row];
+    #endif
 }
 
 int get_n_to_satisfy() {
@@ -730,6 +952,12 @@ int get_n_to_satisfy() {
     #ifdef BUILD_PDU
     satisfy += pdus_to_satisfy;
     #endif
+    #ifdef BUILD_THERMAL
+    satisfy += thermal_to_satisfy;
+    #endif
+    #ifdef BUILD_REPLAY
+    satisfy += replay_to_satisfy;
+    #endif
     return satisfy;
 }
 
@@ -737,45 +965,37 @@ void fork_join_loop() {
     // Prepare count of sensors to re-satisfy for early-exit
     int satisfy = get_n_to_satisfy();
     // Initial Wait
-    std::chrono::time_point<std::chrono::system_clock> t0 = std::chrono::system_clock::now(), t1 = t0;
-    if (args.format == OutputJSON)
-        args.log << "{\"event\": \"initial-wait-start\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t_minus_one).count() / 1e9 << "}," << std::endl;
-    else
-        args.error_log << "Begin initial wait. Should last " << args.initial_wait << " seconds" << std::endl;
+    std::chrono::time_point<std::chrono::system_clock> t0 = poll_clock.now(), t1 = t0;
+    events.emit(EventInitialWaitStart, samples_logged, {{"duration", args.initial_wait}});
     double waiting = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count() / 1e9;
     int poll_result;
     while (waiting < args.initial_wait) {
         poll_result = poll_cycle(t_minus_one);
-        t1 = std::chrono::system_clock::now();
+        t1 = poll_clock.now();
         waiting = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count() / 1e9;
     }
     // After initial wait expires, change initial temperatures
     set_initial_temperatures();
-    if (args.format == OutputJSON) {
-        args.log << "{\"event\": \"initial-wait-end\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t_minus_one).count() / 1e9 << ", \"wrapped-command\": \"";
-        int argidx = 0;
-        // NOTE: Not escaped for JSON format, so this value could break the file
-        while (args.wrapped[argidx] != nullptr) args.log << args.wrapped[argidx++] << " ";
-        args.log << "\"}," << std::endl;
-    }
-    else {
-        args.error_log << "@@Initial wait concludes at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t_minus_one).count() / 1e9 << "s" << std::endl
-                       << "@@Launching wrapped command: ";
-        int argidx = 0;
-        while(args.wrapped[argidx] != nullptr) args.error_log << args.wrapped[argidx++] << " ";
-        args.error_log << std::endl;
-    }
+    #ifdef BUILD_RAPL
+    // Energy of the wrapped command is counted from here to its end
+    if (args.rapl) mark_rapl_energy();
+    #endif
+    events.emit(EventInitialWaitEnd, samples_logged, {{"wrapped-command", wrapped_command_string()}});
     // Fork call
     pid_t pid = fork();
     if (pid == -1) {
         args.error_log << "Fork failed." << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
     else if (pid == 0) {
         // Child process should execute the indicated command
+        #ifdef BUILD_CGROUP
+        if (args.cgroup) attach_cgroup_child();
+        #endif
         if (execvp(args.wrapped[0], args.wrapped) == -1) {
             args.error_log << "Exec child process failed" << std::endl;
-            exit(EXIT_FAILURE);
+            // The sink threads belong to the parent, so the child must not run the atexit drain
+            _exit(EXIT_FAILURE);
         }
     }
     else fork_join_parent_poll(pid, t0, satisfy);
@@ -787,33 +1007,36 @@ void fork_join_parent_poll(pid_t pid, std::chrono::time_point<std::chrono::syste
     pid_t result;
     double waiting;
 
+    nlohmann::json child_status = nlohmann::json::object();
+
     // Non-blocking wait using waitpid with WNOHANG
+    // The child runs in real time, so a virtual clock must not skip these sleeps
+    poll_clock.pace(true);
     do {
         // Briefly check in on child process, then go back to collecting results
         result = waitpid(pid, &status, WNOHANG);
+        #ifdef BUILD_RAPL
+        // Energy stops counting at the exit, not after the final poll and its sleep
+        if (result > 0 && args.rapl) child_status["energy-joules"] = rapl_energy_since_mark();
+        #endif
         poll_result = poll_cycle(t0);
     } while (result == 0);
-    std::chrono::time_point<std::chrono::system_clock> t1 = std::chrono::system_clock::now(), t2 = t1;
-    if (args.format == OutputJSON) {
-        args.log << "{\"event\": \"wrapped-command-end\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << "}," << std::endl;
-    }
-    else args.error_log << "@@Wrapped command concludes at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << "s" << std::endl;
+    poll_clock.pace(false);
+    std::chrono::time_point<std::chrono::system_clock> t1, t2;
 
     // Waiting is over
     if (result == -1) {
         args.error_log << "Wait on child process failed" << std::endl;
-        exit(EXIT_FAILURE);
+        shutdown(EXIT_FAILURE);
     }
-    // !! Error-log uses these messages as a timestamp synchronization point. It should not be guarded by debug level! !!
-    if (WIFEXITED(status)) args.error_log << "Child process exits with status " << WEXITSTATUS(status) << std::endl;
-    else if (WIFSIGNALED(status)) args.error_log << "Child process caught/terminated by signal " << WTERMSIG(status) << std::endl;
+    if (WIFEXITED(status)) child_status["exit-status"] = WEXITSTATUS(status);
+    else if (WIFSIGNALED(status)) child_status["signal"] = WTERMSIG(status);
+    events.emit(EventWrappedCommandEnd, samples_logged, child_status);
 
     // Post Wait
-    t2 = std::chrono::system_clock::now();
-    if (args.format == OutputJSON) args.log << "{\"event\": \"post-wait-start\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << "}," << std::endl;
-    else args.error_log << "@@Post wait begins at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << "s" << std::endl;
+    events.emit(EventPostWaitStart, samples_logged, {{"max-wait", (args.post_wait < 0) ? -args.post_wait : args.post_wait}});
     if (args.debug >= DebugVerbose) args.error_log << "Post wait can last up to " << args.post_wait << " seconds" << std::endl;
-    t1 = std::chrono::system_clock::now();
+    t1 = poll_clock.now();
     t2 = t1;
     waiting = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t2).count() / 1e9;
     if (args.post_wait < 0) {
@@ -826,7 +1049,7 @@ void fork_join_parent_poll(pid_t pid, std::chrono::time_point<std::chrono::syste
             else if (args.debug >= DebugVerbose)
                 args.error_log << "Waited " << waiting << " seconds; will wait for temperature normalization or until " << -args.post_wait << " seconds elapse" << std::endl;
             poll_result = poll_cycle(t0);
-            t1 = std::chrono::system_clock::now();
+            t1 = poll_clock.now();
             waiting = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t2).count() / 1e9;
         }
     }
@@ -834,26 +1057,23 @@ void fork_join_parent_poll(pid_t pid, std::chrono::time_point<std::chrono::syste
         // Normal wait for a simple duration to expire
         while (waiting < args.post_wait) {
             poll_result = poll_cycle(t0);
-            t1 = std::chrono::system_clock::now();
+            t1 = poll_clock.now();
             waiting = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t2).count() / 1e9;
         }
     }
-    t2 = std::chrono::system_clock::now();
-    if (args.format == OutputJSON) {
-        args.log << "{\"event\": \"post-wait-end\", \"timestamp\": " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << ", \"max-wait\": ";
-        if (args.post_wait < 0) {
-            args.log << -args.post_wait << ", \"reason\": ";
-            if (waiting < -args.post_wait) args.log << "\"temperature-early-exit\"";
-            else args.log << "\"timeout\"";
-        }
-        else args.log << args.post_wait << ", \"reason\": \"timeout\"";
-        args.log << "}," << std::endl;
-    }
-    else {
-        args.error_log << "@@Post wait ends at " << std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t_minus_one).count() / 1e9 << "s" << std::endl;
-        if (args.post_wait < 0 && waiting < -args.post_wait)
-            args.error_log << "@@Post wait terminates due to temperature early exit" << std::endl;
-        else args.error_log << "@@Post wait terminates due to timeout" << std::endl;
+    bool early_exit = (args.post_wait < 0 && waiting < -args.post_wait);
+    events.emit(EventPostWaitEnd, samples_logged, {{"max-wait", (args.post_wait < 0) ? -args.post_wait : args.post_wait},
+                                                   {"reason", early_exit ? "temperature-early-exit" : "timeout"}});
+}
+
+// Wrapped command and its arguments as a single space-separated string
+std::string wrapped_command_string() {
+    std::string command;
+    if (args.wrapped == nullptr) return command;
+    for (int argidx = 0; args.wrapped[argidx] != nullptr; argidx++) {
+        if (argidx > 0) command += " ";
+        command += args.wrapped[argidx];
     }
+    return command;
 }
 
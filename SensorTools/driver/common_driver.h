@@ -3,6 +3,14 @@
 #cmakedefine BUILD_SUBMER
 #cmakedefine BUILD_NVME
 #cmakedefine BUILD_PDU
+#cmakedefine BUILD_RAPL
+#cmakedefine BUILD_CGROUP
+#cmakedefine BUILD_SYSSTAT
+#cmakedefine BUILD_NET
+#cmakedefine BUILD_DISK
+#cmakedefine BUILD_THERMAL
+#cmakedefine BUILD_UNCORE
+#cmakedefine BUILD_REPLAY
 #cmakedefine SERVER_MAIN
 // Headers and why they're included
 // Document necessary compiler flags as needed in full-line comment below the header
@@ -14,6 +22,7 @@
 #include <sys/time.h> // Other time-based structs, may import the key things from select.h
 #else
 #include "../io/argparse_libsensors.h" // Common headers, IO control
+#include "../io/sysfs_reader.h" // Batched reads of every collector's cached sysfs files
 #endif
 
 #include <iomanip> // setw and setprecision
@@ -25,6 +34,10 @@
 #include <arpa/inet.h> // Make network strings (IP addr, etc) for debug/logging
 #include <sys/socket.h> // Socket datatypes, socket operations
 #include <nlohmann/json.hpp> // JSON data type
+#include "../io/poll_clock.h" // Real or virtual time for polls and waits
+#include "../io/events.h" // Typed event timeline
+#include "../io/sinks.h" // Sink graph fed by every poll
+#include <sstream> // Rendering blocks broadcast to sinks
 
 #ifdef BUILD_CPU
 #include "../tools/cpu/cpu_tools.h"
@@ -41,6 +54,30 @@
 #ifdef BUILD_PDU
 #include "../tools/pdu/pdu_tools.h"
 #endif
+#ifdef BUILD_RAPL
+#include "../tools/rapl/rapl_tools.h"
+#endif
+#ifdef BUILD_CGROUP
+#include "../tools/cgroup/cgroup_tools.h"
+#endif
+#ifdef BUILD_SYSSTAT
+#include "../tools/sysstat/sysstat_tools.h"
+#endif
+#ifdef BUILD_NET
+#include "../tools/net/net_tools.h"
+#endif
+#ifdef BUILD_DISK
+#include "../tools/disk/disk_tools.h"
+#endif
+#ifdef BUILD_THERMAL
+#include "../tools/thermal/thermal_tools.h"
+#endif
+#ifdef BUILD_UNCORE
+#include "../tools/uncore/uncore_tools.h"
+#endif
+#ifdef BUILD_REPLAY
+#include "../tools/replay/replay_tools.h"
+#endif
 
 // End Headers
 
@@ -52,7 +89,6 @@ int main(int argc, char** argv);
 // CALLED FROM MAIN
 void init_libsensorstools(int argc, char** argv);
 // Sub-calls of init_libsensorstools
-void print_csv_header();
 void main_loop();
 // Sub-calls of main_loop
 void init_timing();
@@ -65,10 +101,15 @@ void fork_join_loop();
 void fork_join_parent_poll(pid_t pid, std::chrono::time_point<std::chrono::system_clock> t0, int satisfy);
 // Helpers that may be called at other times
 void shutdown(int signal);
+std::string wrapped_command_string();
+long replay_remaining();
 // End Function declarations
 
 // External variable declarations
 extern std::chrono::time_point<std::chrono::system_clock> t_minus_one;
+extern EventChannel events;
+extern SinkGraph sinks;
+extern uint64_t samples_logged;
 #ifdef SERVER_MAIN
 extern int master_socket;
 extern std::vector<int> client_sockets;
@@ -21,5 +21,135 @@ OutputJSON,
 count_OutputFormats
 };
 
+// Kinds of records that may appear in a framed log
+enum RecordFrameKinds {
+FrameData,
+FrameSync,
+count_RecordFrameKinds
+};
+
+// Typed events marking program and wrapped-command phase boundaries
+// Names used in logs are kept in event_names (io/events.cpp) in the same order
+enum EventTypes {
+EventProgramStart,
+EventInitialization,
+EventServerStart,
+EventServerStop,
+EventClientConnect,
+EventClientPoll, // Each poll of a client between the server's start and stop messages
+EventInitialWaitStart,
+EventInitialWaitEnd,
+EventWrappedCommandEnd,
+EventPostWaitStart,
+EventPostWaitEnd,
+EventMarker, // Phase marker received through -m | --markers
+EventShutdown,
+count_EventTypes
+};
+
+// Value types a sample channel can hold
+enum SampleChannelKinds {
+ChannelNumeric,
+ChannelText,
+count_SampleChannelKinds
+};
+
+// Destinations that can be attached to the sink graph (-S | --sink)
+// Names used in sink specifications are kept in sink_kind_names (io/sinks.cpp) in the same order
+enum SinkKinds {
+SinkFile,
+SinkGzip,
+SinkShm,
+SinkTcp,
+count_SinkKinds
+};
+
+// Work items queued to each sink
+enum SinkItemKinds {
+SinkItemSample,
+SinkItemEvent,
+SinkItemText,
+count_SinkItemKinds
+};
+
+// Encodings the log reader (reader/log_reader.h) understands
+// Names reported to callers are kept in reader_format_names (reader/log_reader.cpp) in the same order
+enum ReaderFormats {
+ReaderAuto, // Detect from the leading bytes
+ReaderCSV,
+ReaderJSON, // One array of records, as written by -f 2
+ReaderNDJSON, // One record per line, no enclosing array
+count_ReaderFormats
+};
+
+// Outcomes of reading a log
+enum ReaderResults {
+ReaderOK,
+ReaderOpenFailed, // The file could not be opened or mapped
+ReaderMalformed, // The contents do not parse as the requested/detected format
+ReaderUnsupported, // Valid log, but in a format the reader does not load (human-readable logs)
+count_ReaderResults
+};
+
+// How collectors' cached sysfs/procfs files are read each poll (-R | --reads), see io/sysfs_reader.h
+enum SysfsEngines {
+SysfsAuto, // io_uring when available, otherwise pread
+SysfsUring,
+SysfsPread,
+count_SysfsEngines
+};
+
+// Feature types the CPU tool reads from each chip, numbered as libsensors' main sensors_feature_type values
+// Names used by -T | --cpu-features and in channel names are kept in cpu_feature_types (tools/cpu/hwmon.h) in the same order
+enum CpuFeatureKinds {
+CpuVoltage,
+CpuFan,
+CpuTemperature,
+CpuPower,
+CpuEnergy,
+CpuCurrent,
+CpuHumidity,
+count_CpuFeatureKinds
+};
+
+// Per-core statistics the CPU tool collects (-K | --core-stats)
+// Names used on the command line are kept in core_stat_types (tools/cpu/core_stats.h) in the same order
+enum CoreStatKinds {
+CoreFrequency,
+CoreUtilization,
+CoreIdleResidency,
+CoreThrottling,
+CorePerfCounters,
+count_CoreStatKinds
+};
+
+// Groups of cores the CPU tool can aggregate per-core statistics over (-A | --aggregate)
+// Names used on the command line are kept in topology_level_types (tools/cpu/topology.h) in the same order
+enum TopologyLevels {
+TopologySocket,
+TopologyDie,
+TopologyNode,
+count_TopologyLevels
+};
+
+// How a system statistics counter is reported (tools/sysstat)
+enum SysstatValueKinds {
+SysstatLevel, // Logged as read, ie: /proc/meminfo
+SysstatRate, // Change per second, ie: /proc/vmstat
+SysstatStallShare, // Stall microseconds as % of the interval, ie: /proc/pressure
+count_SysstatValueKinds
+};
+
+// How simulated device values move over time (-X | --simulate, tools/sim)
+// Names used on the command line are kept in sim_trajectory_types (tools/sim/sim_backend.h) in the same order
+enum SimTrajectories {
+SimConstant,
+SimRamp,
+SimSine,
+SimRandom,
+SimScript,
+count_SimTrajectories
+};
+
 #endif
 
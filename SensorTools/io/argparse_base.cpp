@@ -20,6 +20,11 @@ void parse(int argc, char** argv) {
         #ifndef SERVER_MAIN
             #ifdef BUILD_CPU
             {"cpu", no_argument, 0, 'c'},
+            {"hwmon", no_argument, 0, 'H'},
+            {"cpu-features", required_argument, 0, 'T'},
+            {"core-stats", required_argument, 0, 'K'},
+            {"aggregate", required_argument, 0, 'A'},
+            {"aggregate-only", no_argument, 0, 'O'},
             #endif
             #ifdef BUILD_GPU
             {"gpu", no_argument, 0, 'g'},
@@ -33,18 +38,54 @@ void parse(int argc, char** argv) {
             #ifdef BUILD_PDU
             {"pdu", no_argument, 0, 'P'},
             #endif
+            #ifdef BUILD_RAPL
+            {"rapl", no_argument, 0, 'r'},
+            #endif
+            #ifdef BUILD_CGROUP
+            {"cgroup", no_argument, 0, 'G'},
+            #endif
+            #ifdef BUILD_SYSSTAT
+            {"sysstat", no_argument, 0, 'M'},
+            #endif
+            #ifdef BUILD_NET
+            {"net", no_argument, 0, 'N'},
+            #endif
+            #ifdef BUILD_DISK
+            {"disk", no_argument, 0, 'B'},
+            #endif
+            #ifdef BUILD_THERMAL
+            {"thermal", no_argument, 0, 'z'},
+            #endif
+            #ifdef BUILD_UNCORE
+            {"uncore", no_argument, 0, 'u'},
+            #endif
+            #ifdef BUILD_REPLAY
+            {"replay", required_argument, 0, 'y'},
+            {"replay-speed", required_argument, 0, 'j'},
+            #endif
             {"ipaddr", required_argument, 0, 'I'},
             {"connections", required_argument, 0, 'C'},
+            {"reads", required_argument, 0, 'R'},
+            {"sysfs-root", required_argument, 0, 'Y'},
+            {"procfs-root", required_argument, 0, 'Q'},
+            {"markers", required_argument, 0, 'm'},
+            #ifdef SIMULATED_HW
+            {"simulate", required_argument, 0, 'X'},
+            #endif
         #else
             {"clients", required_argument, 0, 'C'},
         #endif
         {"format", required_argument, 0, 'f'},
         {"log", required_argument, 0, 'l'},
         {"errorlog", required_argument, 0, 'L'},
+        {"frame", required_argument, 0, 'F'},
+        {"events", required_argument, 0, 'E'},
+        {"sink", required_argument, 0, 'S'},
         {"poll", required_argument, 0, 'p'},
         {"initial-wait", required_argument, 0, 'i'},
         {"post-wait", required_argument, 0, 'w'},
         {"timeout", required_argument, 0, 't'},
+        {"virtual-clock", no_argument, 0, 'V'},
         {"debug", required_argument, 0, 'd'},
         {"version", no_argument, 0, 'v'},
         {0,0,0,0}
@@ -52,7 +93,7 @@ void parse(int argc, char** argv) {
     const char* optionstr = "h"
     #ifndef SERVER_MAIN
         #ifdef BUILD_CPU
-        "c"
+        "cHT:K:A:O"
         #endif
         #ifdef BUILD_GPU
         "g"
@@ -66,9 +107,36 @@ void parse(int argc, char** argv) {
         #ifdef BUILD_PDU
         "P"
         #endif
-        "I:"
+        #ifdef BUILD_RAPL
+        "r"
+        #endif
+        #ifdef BUILD_CGROUP
+        "G"
+        #endif
+        #ifdef BUILD_SYSSTAT
+        "M"
+        #endif
+        #ifdef BUILD_NET
+        "N"
+        #endif
+        #ifdef BUILD_DISK
+        "B"
+        #endif
+        #ifdef BUILD_THERMAL
+        "z"
+        #endif
+        #ifdef BUILD_UNCORE
+        "u"
+        #endif
+        #ifdef BUILD_REPLAY
+        "y:j:"
+        #endif
+        "I:R:Y:Q:m:"
+        #ifdef SIMULATED_HW
+        "X:"
+        #endif
     #endif
-    "C:f:l:L:p:i:w:t:d:v";
+    "C:f:l:L:F:E:S:p:i:w:t:Vd:v";
     // Disable getopt's automatic error message -- we'll catch it via the '?' return and shut down
     opterr = 0;
 
@@ -93,6 +161,34 @@ void parse(int argc, char** argv) {
                     #ifdef BUILD_CPU
                     std::cout << "\t-c | --cpu\n\t\t" <<
                                  "Query CPU stats only (default: CPU and GPU)" << std::endl;
+                    std::cout << "\t-H | --hwmon\n\t\t" <<
+                                 "Read CPU temperatures directly from /sys/class/hwmon instead of through libsensors\n\t\t" <<
+                                 "Chip and channel names match libsensors; sensors.conf compute and ignore statements still apply"
+                                 #ifndef CPU_LIBSENSORS_ENABLED
+                                 << "\n\t\t(always on: built without libsensors)"
+                                 #endif
+                                 << std::endl;
+                    std::cout << "\t-T [types] | --cpu-features [types]\n\t\t" <<
+                                 "Comma-separated feature types to read from each CPU/board chip (default: temp)\n\t\t" <<
+                                 "Types: all";
+                    for (int kind = 0; kind < count_CpuFeatureKinds; kind++)
+                        std::cout << ", " << cpu_feature_types[kind].name << " (" << cpu_feature_types[kind].unit << ")";
+                    std::cout << std::endl;
+                    std::cout << "\t-K [stats] | --core-stats [stats]\n\t\t" <<
+                                 "Comma-separated statistics to collect for each core (default: freq)\n\t\t" <<
+                                 "Statistics: all";
+                    for (int kind = 0; kind < count_CoreStatKinds; kind++)
+                        std::cout << ", " << core_stat_types[kind].name << " (" << core_stat_types[kind].description << ")";
+                    std::cout << std::endl;
+                    std::cout << "\t-A [levels] | --aggregate [levels]\n\t\t" <<
+                                 "Comma-separated topology levels to report mean/min/max frequency and utilization over (default: None)\n\t\t" <<
+                                 "Temperatures are aggregated per socket for coretemp, k10temp and zenpower chips\n\t\t" <<
+                                 "Levels: all";
+                    for (int level = 0; level < count_TopologyLevels; level++)
+                        std::cout << ", " << topology_level_types[level].name << " (" << topology_level_types[level].description << ")";
+                    std::cout << std::endl;
+                    std::cout << "\t-O | --aggregate-only\n\t\t" <<
+                                 "Report aggregates instead of per-core frequency and utilization columns (default: socket aggregates when -A is not given)" << std::endl;
                     #endif
                     #ifdef BUILD_GPU
                     std::cout << "\t-g | --gpu\n\t\t" <<
@@ -110,10 +206,65 @@ void parse(int argc, char** argv) {
                     std::cout << "\t-P | --pdu\n\t\t" <<
                                  "Query PDU readings over SNMP (default: Not queried)" << std::endl;
                     #endif
+                    #ifdef BUILD_RAPL
+                    std::cout << "\t-r | --rapl\n\t\t" <<
+                                 "Query RAPL package/DRAM energy and average power from /sys/class/powercap (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_CGROUP
+                    std::cout << "\t-G | --cgroup\n\t\t" <<
+                                 "Run the wrapped command in its own cgroup v2 group and log its CPU, memory, IO and CPU pressure (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_SYSSTAT
+                    std::cout << "\t-M | --sysstat\n\t\t" <<
+                                 "Query pressure stall (PSI), /proc/vmstat and /proc/meminfo statistics (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_NET
+                    std::cout << "\t-N | --net\n\t\t" <<
+                                 "Query network interface throughput from /proc/net/dev (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_DISK
+                    std::cout << "\t-B | --disk\n\t\t" <<
+                                 "Query block device throughput from /proc/diskstats (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_THERMAL
+                    std::cout << "\t-z | --thermal\n\t\t" <<
+                                 "Query Linux thermal zones and cooling devices from /sys/class/thermal (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_UNCORE
+                    std::cout << "\t-u | --uncore\n\t\t" <<
+                                 "Query Intel uncore and devfreq device frequencies (default: Not queried)" << std::endl;
+                    #endif
+                    #ifdef BUILD_REPLAY
+                    std::cout << "\t-y [log] | --replay [log]\n\t\t" <<
+                                 "Replay the samples of a CSV or JSON log (framed and gzip-compressed logs too) as a collector (default: Not replayed)\n\t\t" <<
+                                 "Without -p, rows are emitted at their recorded pace and the program ends with the log" << std::endl;
+                    std::cout << "\t-j [speed] | --replay-speed [speed]\n\t\t" <<
+                                 "Multiple of the recorded speed to replay at, 0 for as fast as possible (default: " << args.replay_speed << ")" << std::endl;
+                    #endif
                     std::cout << "\t-I | --ipaddr\n\t\t" <<
                                  "IP address of a server to coordinate with (server controls start/stop of measurements and any applications)" << std::endl;
                     std::cout << "\t-C [value] | --connections [value]\n\t\t" <<
                                  "Maximum number of attempts to connect to server (default: " << args.connection_attempts << "), use negative value for infinite" << std::endl;
+                    std::cout << "\t-R [engine] | --reads [engine]\n\t\t" <<
+                                 "How cached sysfs files are read each poll [0 = io_uring when available, else pread == default | 1 = io_uring | 2 = pread]" << std::endl;
+                    std::cout << "\t-Y [dir] | --sysfs-root [dir]\n\t\t" <<
+                                 "Read sysfs below [dir] instead of /sys, ie: a tree from sensortools-simtree or a copy of another host's /sys\n\t\t" <<
+                                 "Implies -H: libsensors only reads the live /sys" << std::endl;
+                    std::cout << "\t-Q [dir] | --procfs-root [dir]\n\t\t" <<
+                                 "Read procfs statistics below [dir] instead of /proc (the cgroup tool still uses the live /proc/self)" << std::endl;
+                    std::cout << "\t-m [fifo] | --markers [fifo]\n\t\t" <<
+                                 "Log each line written to the named pipe [fifo] (created if missing) as a marker event, ie: phase edges from sensortools-load\n\t\t" <<
+                                 "A wrapped command finds the pipe in $" << MarkerEnvironment << std::endl;
+                    #ifdef SIMULATED_HW
+                    std::cout << "\t-X [spec] | --simulate [spec]\n\t\t" <<
+                                 "How simulated GPU, NVMe, PDU and Submer values move (default: random,period=" << simulation.period <<
+                                 ",seed=" << simulation.seed << ",gpus=" << SimDefaultGpus << ",nvme=" << SimDefaultNvme << ")\n\t\t" <<
+                                 "Comma-separated trajectory=NAME (or just NAME), period=SECONDS, seed=N, script=FILE, gpus=N, nvme=N\n\t\t" <<
+                                 "Trajectories: ";
+                    for (int trajectory = 0; trajectory < count_SimTrajectories; trajectory++)
+                        std::cout << ((trajectory == 0) ? "" : ", ") << sim_trajectory_types[trajectory].name << " (" << sim_trajectory_types[trajectory].description << ")";
+                    std::cout << std::endl;
+                    #endif
                 #else
                     std::cout << "\t-C | --clients\n\t\t" <<
                                  "Number of clients to connect to server" << std::endl;
@@ -124,6 +275,16 @@ void parse(int argc, char** argv) {
                              "File to write output to" << std::endl;
                 std::cout << "\t-L [file] | --errorlog [file]\n\t\t" <<
                              "File to write extra debug/errors to" << std::endl;
+                std::cout << "\t-F [records] | --frame [records]\n\t\t" <<
+                             "Wrap each log record in a length+CRC frame so sensorlog-recover can repair crashed logs\n\t\t" <<
+                             "Forces a durable sync point to disk every [records] records (records >= 0, 0 == never force)" << std::endl;
+                std::cout << "\t-E [file] | --events [file]\n\t\t" <<
+                             "File to write the typed event timeline to, in the active output format\n\t\t" <<
+                             "(default: JSON logs carry events inline, other formats write legacy timestamp lines to the error log)" << std::endl;
+                std::cout << "\t-S [spec] | --sink [spec]\n\t\t" <<
+                             "Also send every sample to another output, may be repeated. [spec] is KIND:FORMAT:TARGET[:DEPTH]\n\t\t" <<
+                             "KIND is file (path), gzip (path), shm (POSIX shared memory name) or tcp (HOST:PORT); FORMAT is csv, human or json\n\t\t" <<
+                             "Each sink formats on its own thread and drops samples once DEPTH are waiting (default: " << SinkDefaultDepth << ")" << std::endl;
                 std::cout << "\t-p [interval] | --poll [interval]\n\t\t" <<
                              "Floating point interval in seconds to poll stats (interval > 0)" << std::endl;
                 std::cout << "\t-i [interval] | --initial-wait [interval]\n\t\t" <<
@@ -139,6 +300,9 @@ void parse(int argc, char** argv) {
                              "Clients default to attempting to locate the server up to " << args.connection_attempts << " times (regardless of walltime duration)"
                 #endif
                              << std::endl;
+                std::cout << "\t-V | --virtual-clock\n\t\t" <<
+                             "Skip the sleeps between polls and advance timestamps, waits and simulated devices by them instead\n\t\t" <<
+                             "Sleeps stay real while a wrapped command runs; sysfs/procfs collectors still see real time" << std::endl;
                 std::cout << "\t-d [level] | --debug [level]\n\t\t" <<
                              "Debug verbosity (default: " << DebugOFF << ", maximum: " << DebugVerbose << ")" << std::endl;
                 std::cout << "\t-v | --version\n\t\t" <<
@@ -151,6 +315,39 @@ void parse(int argc, char** argv) {
                 case 'c':
                     args.cpu = true;
                     break;
+                case 'H':
+                    args.hwmon = true;
+                    break;
+                case 'T': {
+                    std::string error;
+                    if (!parse_cpu_features(optarg, args.cpu_features, error)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\t" << error << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                }
+                case 'K': {
+                    std::string error;
+                    if (!parse_core_stats(optarg, args.core_stats, error)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\t" << error << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                }
+                case 'A': {
+                    std::string error;
+                    if (!parse_topology_levels(optarg, args.aggregate_levels, error)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\t" << error << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                }
+                case 'O':
+                    args.aggregate_only = true;
+                    break;
                 #endif
                 #ifdef BUILD_GPU
                 case 'g':
@@ -172,12 +369,102 @@ void parse(int argc, char** argv) {
                     args.pdu = true;
                     break;
                 #endif
+                #ifdef BUILD_RAPL
+                case 'r':
+                    args.rapl = true;
+                    break;
+                #endif
+                #ifdef BUILD_CGROUP
+                case 'G':
+                    args.cgroup = true;
+                    break;
+                #endif
+                #ifdef BUILD_SYSSTAT
+                case 'M':
+                    args.sysstat = true;
+                    break;
+                #endif
+                #ifdef BUILD_NET
+                case 'N':
+                    args.net = true;
+                    break;
+                #endif
+                #ifdef BUILD_DISK
+                case 'B':
+                    args.disk = true;
+                    break;
+                #endif
+                #ifdef BUILD_THERMAL
+                case 'z':
+                    args.thermal = true;
+                    break;
+                #endif
+                #ifdef BUILD_UNCORE
+                case 'u':
+                    args.uncore = true;
+                    break;
+                #endif
+                #ifdef BUILD_REPLAY
+                case 'y':
+                    if (!std::filesystem::is_regular_file(optarg)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\tNot a log file" << std::endl;
+                        bad_args += 1;
+                    }
+                    else {
+                        args.replay = true;
+                        args.replay_log = optarg;
+                    }
+                    break;
+                case 'j':
+                    args.replay_speed = atof(optarg);
+                    if (args.replay_speed < 0) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\tReplay speed must be 0 (as fast as possible) or greater" << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                #endif
                 case 'I':
                     args.ip_addr = argv[optind-1];
                     break;
                 case 'C':
                     args.connection_attempts = atoi(optarg);
                     break;
+                case 'R':
+                    args.read_engine = atoi(optarg);
+                    if (args.read_engine < 0 || args.read_engine >= count_SysfsEngines) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                        "\n\tRead engines are specified by integers [0-" << count_SysfsEngines << ")" << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                case 'Y':
+                case 'Q': {
+                    std::string root = optarg;
+                    while (root.size() > 1 && root.back() == '/') root.pop_back();
+                    if (!std::filesystem::is_directory(root)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\tNot a directory" << std::endl;
+                        bad_args += 1;
+                    }
+                    else ((c == 'Y') ? sysfs_root : procfs_root) = root;
+                    break;
+                }
+                case 'm':
+                    args.markers_path = optarg;
+                    break;
+                #ifdef SIMULATED_HW
+                case 'X': {
+                    std::string error;
+                    if (!parse_simulation(optarg, simulation, error)) {
+                        std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                     "\n\t" << error << std::endl;
+                        bad_args += 1;
+                    }
+                    break;
+                }
+                #endif
             #else
                 case 'C':
                     args.clients = atoi(optarg);
@@ -200,6 +487,30 @@ void parse(int argc, char** argv) {
                 args.error_log_path = std::filesystem::path(optarg);
                 if (!args.error_log.redirect(args.error_log_path, false)) exit(EXIT_FAILURE);
                 break;
+            case 'E':
+                args.event_log_path = std::filesystem::path(optarg);
+                if (!args.event_log.redirect(args.event_log_path, false)) exit(EXIT_FAILURE);
+                break;
+            case 'S': {
+                sink_spec spec;
+                std::string error;
+                if (!parse_sink_spec(optarg, spec, error)) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                 "\n\t" << error << std::endl;
+                    bad_args += 1;
+                }
+                else args.sinks.push_back(spec);
+                break;
+            }
+            case 'F':
+                args.frame = atoi(optarg);
+                if (args.frame < 0) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << ": " << optarg <<
+                                 "\n\tRecords between sync points must be >= 0" << std::endl;
+                    bad_args += 1;
+                }
+                else args.log.frame(args.frame);
+                break;
             case 'p':
                 args.poll = atof(optarg);
                 if (args.poll <= 0) {
@@ -234,6 +545,9 @@ void parse(int argc, char** argv) {
                     bad_args += 1;
                 }
                 break;
+            case 'V':
+                args.virtual_clock = true;
+                break;
             case 'v':
                 args.version = true;
                 break;
@@ -244,6 +558,15 @@ void parse(int argc, char** argv) {
         }
     }
     // Post-reading logic
+    #if defined(BUILD_CPU) && !defined(CPU_LIBSENSORS_ENABLED)
+    args.hwmon = true; // Built without libsensors, hwmon is the only CPU temperature backend
+    #endif
+    #if defined(BUILD_CPU) && !defined(SERVER_MAIN)
+    if (!sysfs_root.empty() && !args.hwmon) {
+        args.hwmon = true; // libsensors cannot be pointed at another sysfs root
+        if (args.debug >= DebugMinimal) args.error_log << "Reading CPU temperatures from hwmon below " << sysfs_root << std::endl;
+    }
+    #endif
     if (!args.any_active()) {
         if (args.debug >= DebugVerbose) args.error_log << "Nothing active, enabling defaults" << std::endl;
         args.default_active(); // Ensure defaults always on
@@ -262,12 +585,22 @@ void parse(int argc, char** argv) {
     }
     else args.wrapped = nullptr;
     #ifndef SERVER_MAIN
+    if (args.virtual_clock && args.ip_addr != nullptr) {
+        std::cerr << "Virtual clock cannot be used by a client!" << std::endl <<
+                     "Clients poll until their server, which runs in real time, stops them" << std::endl;
+        bad_args += 1;
+    }
     if (args.wrapped != nullptr && args.ip_addr != nullptr) {
         std::cerr << "IP address for server given, but also a wrapped command!" << std::endl <<
                      "Server should run the wrapped command for proper synchronization" << std::endl;
         bad_args += 1;
     }
     #else
+    if (args.virtual_clock && args.clients > 0) {
+        std::cerr << "Virtual clock cannot be used by a server with clients!" << std::endl <<
+                     "Clients poll in real time until the server stops them" << std::endl;
+        bad_args += 1;
+    }
     if (args.wrapped == nullptr && args.poll != 0)
         std::cerr << "Warning! No wrapped command but polling indefinitely. You may wish to omit your polling argument for a demo or provide a wrapped command after the -- separator" << std::endl;
     #endif
@@ -277,6 +610,4 @@ void parse(int argc, char** argv) {
 
 // Definition of external variables for IO tools
 arguments args;
-// Flag that permits update logging upon collection (prevents first row from being logged prior to CSV headers)
-bool update = false;
 
@@ -11,9 +11,28 @@
 #cmakedefine BUILD_SUBMER
 #cmakedefine BUILD_NVME
 #cmakedefine BUILD_PDU
+#cmakedefine BUILD_RAPL
+#cmakedefine BUILD_CGROUP
+#cmakedefine BUILD_SYSSTAT
+#cmakedefine BUILD_NET
+#cmakedefine BUILD_DISK
+#cmakedefine BUILD_THERMAL
+#cmakedefine BUILD_UNCORE
+#cmakedefine BUILD_REPLAY
 #cmakedefine SERVER_MAIN
 
 #include "output.h" // Output class definition
+#include "sinks.h" // Sink specifications, sample schema for collectors
+#include "host_paths.h" // Root overrides for sysfs/procfs reads
+#include "markers.h" // Phase markers from other programs
+#ifdef BUILD_CPU
+#include "../tools/cpu/hwmon.h" // CPU feature type names and defaults
+#include "../tools/cpu/core_stats.h" // Per-core statistic names and defaults
+#include "../tools/cpu/topology.h" // Topology level names and defaults
+#endif
+#ifdef SIMULATED_HW
+#include "../tools/sim/sim_backend.h" // Simulation settings and trajectory names
+#endif
 #include "../enums.h" // Enums for output formats, debug levels
 #include "../definitions.h" // Debug levels, versioning, etc
 
@@ -23,6 +42,7 @@
 #include <iostream> // std file descriptors
 #include <chrono> // durations and duration_casts
 #include <filesystem> // filesystem path
+#include <vector> // Additional sinks
 // !! May require linker flag: -lstdc++fs
 
 // Argument values stored here
@@ -31,6 +51,7 @@ typedef struct argstruct {
          #ifndef SERVER_MAIN
              #ifdef BUILD_CPU
              cpu = 0,
+             hwmon = 0, // Read CPU temperatures from hwmon rather than through libsensors
              #endif
              #ifdef BUILD_GPU
              gpu = 0,
@@ -44,17 +65,56 @@ typedef struct argstruct {
              #ifdef BUILD_PDU
              pdu = 0,
              #endif
+             #ifdef BUILD_RAPL
+             rapl = 0,
+             #endif
+             #ifdef BUILD_CGROUP
+             cgroup = 0,
+             #endif
+             #ifdef BUILD_SYSSTAT
+             sysstat = 0,
+             #endif
+             #ifdef BUILD_NET
+             net = 0,
+             #endif
+             #ifdef BUILD_DISK
+             disk = 0,
+             #endif
+             #ifdef BUILD_THERMAL
+             thermal = 0,
+             #endif
+             #ifdef BUILD_UNCORE
+             uncore = 0,
+             #endif
+             #ifdef BUILD_REPLAY
+             replay = 0,
+             #endif
          #endif
+         virtual_clock = 0, // Skip sleeps between polls, see io/poll_clock.h
          version = 0,
          shutdown = 0;
     #ifdef SERVER_MAIN
     int clients = 0;
     #else
     int connection_attempts = 10;
+    #ifdef BUILD_CPU
+    unsigned cpu_features = CpuDefaultFeatures; // Bits of CpuFeatureKinds read from each chip
+    unsigned core_stats = CoreDefaultStats; // Bits of CoreStatKinds collected per core
+    unsigned aggregate_levels = 0; // Bits of TopologyLevels to aggregate per-core statistics over
+    bool aggregate_only = false; // Drop per-core frequency and utilization columns in favor of the aggregates
+    #endif
+    short read_engine = SysfsAuto; // SysfsEngines used for cached sysfs/procfs files
+    std::string markers_path; // FIFO phase markers are read from, empty == none
+    #ifdef BUILD_REPLAY
+    std::string replay_log; // CSV or JSON log replayed by -y
+    double replay_speed = 1.; // Multiple of the recorded speed, 0 == as fast as possible
+    #endif
     #endif
     short format = 0, debug = 0;
-    std::filesystem::path log_path, error_log_path;
-    Output log, error_log = Output(false, true);
+    int frame = -1; // Records per forced sync point when framing the log, negative == unframed
+    std::filesystem::path log_path, error_log_path, event_log_path;
+    Output log, error_log = Output(false, true), event_log;
+    std::vector<sink_spec> sinks; // Additional outputs fed the same samples as log
     double poll = 0., initial_wait = 0., post_wait = 0., timeout = -1.;
     std::chrono::duration<double> poll_duration, initial_duration, post_duration;
     char **wrapped, *ip_addr = nullptr;
@@ -76,6 +136,30 @@ typedef struct argstruct {
             #ifdef BUILD_PDU
             ret = ret | pdu;
             #endif
+            #ifdef BUILD_RAPL
+            ret = ret | rapl;
+            #endif
+            #ifdef BUILD_CGROUP
+            ret = ret | cgroup;
+            #endif
+            #ifdef BUILD_SYSSTAT
+            ret = ret | sysstat;
+            #endif
+            #ifdef BUILD_NET
+            ret = ret | net;
+            #endif
+            #ifdef BUILD_DISK
+            ret = ret | disk;
+            #endif
+            #ifdef BUILD_THERMAL
+            ret = ret | thermal;
+            #endif
+            #ifdef BUILD_UNCORE
+            ret = ret | uncore;
+            #endif
+            #ifdef BUILD_REPLAY
+            ret = ret | replay;
+            #endif
         #endif
         return ret;
     }
@@ -99,6 +183,9 @@ typedef struct argstruct {
                 #ifdef BUILD_PDU
                 pdu = 1;
                 #endif
+                #ifdef BUILD_RAPL
+                rapl = 1;
+                #endif
             #endif
             #endif
         #endif
@@ -108,6 +195,5 @@ typedef struct argstruct {
 void parse(int argc, char** argv);
 
 extern arguments args;
-extern bool update;
 #endif
 
@@ -0,0 +1,158 @@
+#include "events.h"
+
+// Names as they appear in logs, in EventTypes order
+static const char* event_names[count_EventTypes] = {
+    "program-start",
+    "initialization",
+    "server-start",
+    "server-stop",
+    "client-connect",
+    "client-poll",
+    "initial-wait-start",
+    "initial-wait-end",
+    "wrapped-command-end",
+    "post-wait-start",
+    "post-wait-end",
+    "marker",
+    "shutdown",
+};
+
+const char* event_name(int type) {
+    if (type < 0 || type >= count_EventTypes) return "unknown";
+    return event_names[type];
+}
+
+void EventChannel::configure(short active_format, std::ostream* legacy_destination,
+                             std::chrono::time_point<std::chrono::system_clock> time_origin) {
+    format = active_format;
+    legacy = legacy_destination;
+    origin = time_origin;
+}
+
+void EventChannel::add_destination(std::ostream* stream, bool sidecar) {
+    structured.push_back({stream, sidecar, sidecar});
+}
+
+void EventChannel::add_listener(std::function<void(const event_record&)> listener) {
+    listeners.push_back(listener);
+}
+
+bool EventChannel::is_structured(void) const { return !structured.empty(); }
+
+event_record EventChannel::emit(int type, uint64_t sample, nlohmann::json payload) {
+    std::chrono::time_point<std::chrono::system_clock> wall = poll_clock.now();
+    std::chrono::time_point<std::chrono::steady_clock> mono = std::chrono::steady_clock::now();
+    event_record record;
+    record.type = type;
+    record.index = next_index++;
+    record.sample = sample;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(wall-origin).count() / 1e9;
+    record.monotonic_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mono.time_since_epoch()).count();
+    record.wallclock_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count();
+    record.payload = std::move(payload);
+    for (std::vector<std::function<void(const event_record&)>>::iterator i = listeners.begin(); i != listeners.end(); i++) (*i)(record);
+    for (std::vector<destination>::iterator i = structured.begin(); i != structured.end(); i++) writeStructured(*i, record);
+    if (legacy != nullptr) writeLegacy(record);
+    return record;
+}
+
+void EventChannel::writeStructured(destination& dest, const event_record& record) {
+    std::ostream& out = *dest.stream;
+    switch (format) {
+        case OutputCSV:
+            if (dest.needs_header) {
+                out << "index,event,sample,timestamp,monotonic_ns,wallclock_ns,payload" << std::endl;
+                dest.needs_header = false;
+            }
+            {
+                // Payload is a JSON object; quote it and double any embedded quotes for CSV
+                std::string payload = record.payload.dump(), escaped;
+                escaped.reserve(payload.size() + 2);
+                for (char c : payload) {
+                    if (c == '"') escaped += '"';
+                    escaped += c;
+                }
+                out << record.index << "," << event_name(record.type) << "," << record.sample << "," <<
+                       record.timestamp << "," << record.monotonic_ns << "," << record.wallclock_ns <<
+                       ",\"" << escaped << "\"" << std::endl;
+            }
+            break;
+        case OutputHuman:
+            out << "Event #" << record.index << " " << event_name(record.type) << " at " << record.timestamp <<
+                   "s (sample " << record.sample << ", monotonic " << record.monotonic_ns << "ns, wallclock " <<
+                   record.wallclock_ns << "ns)";
+            if (!record.payload.empty()) out << ": " << record.payload.dump();
+            out << std::endl;
+            break;
+        case OutputJSON:
+            if (dest.needs_header) {
+                out << "[" << std::endl;
+                dest.needs_header = false;
+            }
+            write_event_json(out, record);
+            if (dest.sidecar && record.type == EventShutdown) out << "]" << std::endl;
+            break;
+    }
+}
+
+void write_event_json(std::ostream& out, const event_record& record) {
+    out << "{\"event\": \"" << event_name(record.type) << "\", \"timestamp\": " << record.timestamp <<
+           ", \"index\": " << record.index << ", \"sample\": " << record.sample <<
+           ", \"monotonic-ns\": " << record.monotonic_ns << ", \"wallclock-ns\": " << record.wallclock_ns;
+    for (nlohmann::json::const_iterator i = record.payload.begin(); i != record.payload.end(); i++)
+        out << ", \"" << i.key() << "\": " << i.value().dump();
+    // Shutdown is the final element of the JSON array, so it carries no separator
+    out << ((record.type == EventShutdown) ? "}" : "},") << std::endl;
+}
+
+// Free-text lines that earlier analysis scripts use as timestamp synchronization points
+// The set is frozen: events added since, such as markers, reach only the structured destinations and listeners
+void EventChannel::writeLegacy(const event_record& record) {
+    std::ostream& out = *legacy;
+    const nlohmann::json& p = record.payload;
+    switch (record.type) {
+        case EventProgramStart:
+            out << "The program lives" << std::endl;
+            break;
+        case EventInitialization:
+            out << "@@Initialized at " << record.timestamp << "s" << std::endl;
+            break;
+        case EventServerStart:
+            out << "Server sends 'START' message to all clients" << std::endl;
+            break;
+        case EventServerStop:
+            out << "Server sends 'STOP' message to all clients" << std::endl;
+            break;
+        case EventClientConnect:
+            out << "Client process attempts to connect to server at " << p.value("server", "") << std::endl;
+            break;
+        case EventClientPoll:
+            out << "Client polls iteration #" << p.value("iteration", 0) << std::endl;
+            break;
+        case EventInitialWaitStart:
+            out << "Begin initial wait. Should last " << p.value("duration", 0.) << " seconds" << std::endl;
+            break;
+        case EventInitialWaitEnd:
+            out << "@@Initial wait concludes at " << record.timestamp << "s" << std::endl <<
+                   "@@Launching wrapped command: " << p.value("wrapped-command", "") << std::endl;
+            break;
+        case EventWrappedCommandEnd:
+            out << "@@Wrapped command concludes at " << record.timestamp << "s" << std::endl;
+            if (p.contains("exit-status")) out << "Child process exits with status " << p["exit-status"].get<int>() << std::endl;
+            else if (p.contains("signal")) out << "Child process caught/terminated by signal " << p["signal"].get<int>() << std::endl;
+            break;
+        case EventPostWaitStart:
+            out << "@@Post wait begins at " << record.timestamp << "s" << std::endl;
+            break;
+        case EventPostWaitEnd:
+            out << "@@Post wait ends at " << record.timestamp << "s" << std::endl;
+            if (p.value("reason", "") == "temperature-early-exit") out << "@@Post wait terminates due to temperature early exit" << std::endl;
+            else out << "@@Post wait terminates due to timeout" << std::endl;
+            break;
+        case EventShutdown:
+            out << "@@Shutdown at " << record.timestamp << "s" << std::endl <<
+                   "Run shutdown with signal " << p.value("signal", 0) << std::endl;
+            break;
+    }
+}
+
@@ -0,0 +1,64 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Events
+#define LibSensorTools_Events
+
+#include "../enums.h" // EventTypes, OutputFormats
+
+#include <iostream> // std file descriptors
+#include <string> // String class and manipulation
+#include <cstdint> // uint64_t, int64_t
+#include <vector> // Destination list
+#include <chrono> // Monotonic and wall clocks
+#include <functional> // Listener callbacks
+#include "poll_clock.h" // Timestamps follow the poll clock
+#include <nlohmann/json.hpp> // Event payloads
+
+// One entry on the event timeline
+typedef struct event_record_t {
+    int type; // EventTypes
+    uint64_t index; // Position of this event on the timeline
+    uint64_t sample; // Number of poll samples logged before this event, so phases map directly to row ranges
+    double timestamp; // Seconds since program start, same base as the poll timestamps
+    int64_t monotonic_ns, wallclock_ns; // steady_clock and poll clock (wall or virtual) readings at emission
+    nlohmann::json payload; // Event-specific fields (exit status, signal, reasons, ...)
+} event_record;
+
+// Structured event channel
+// Events go to every listener (the sink graph, which inlines them in JSON sinks) and to a sidecar in the active format.
+// The pre-existing free-text error-log lines are always written as well, whatever the format, so older tooling
+// (ie: aligning runs through the aux file) keeps working.
+class EventChannel {
+private:
+    typedef struct destination_t {
+        std::ostream* stream;
+        bool sidecar, needs_header;
+    } destination;
+    std::vector<destination> structured;
+    std::vector<std::function<void(const event_record&)>> listeners;
+    std::ostream* legacy = nullptr;
+    short format = OutputCSV;
+    uint64_t next_index = 0;
+    std::chrono::time_point<std::chrono::system_clock> origin;
+
+    void writeStructured(destination& dest, const event_record& record);
+    void writeLegacy(const event_record& record);
+public:
+    // legacy is the error log, which receives the free-text lines of the lifecycle events that predate this channel
+    void configure(short format, std::ostream* legacy, std::chrono::time_point<std::chrono::system_clock> origin);
+    // Sidecars are standalone documents (CSV header, JSON array brackets)
+    void add_destination(std::ostream* stream, bool sidecar);
+    // Listeners receive every event record as it is emitted
+    void add_listener(std::function<void(const event_record&)> listener);
+    bool is_structured(void) const;
+    event_record emit(int type, uint64_t sample, nlohmann::json payload = nlohmann::json::object());
+};
+
+const char* event_name(int type);
+// JSON object for one event, including the trailing separator (none for shutdown, the final array element)
+void write_event_json(std::ostream& out, const event_record& record);
+#endif
+
@@ -0,0 +1,19 @@
+#include "host_paths.h"
+
+// Replace a leading mount ("/sys") by root when path is that mount or lies below it
+static bool rebase(const std::string& path, const char* mount, const std::string& root, std::string& rebased) {
+    size_t n = std::char_traits<char>::length(mount);
+    if (root.empty() || path.compare(0, n, mount) != 0 || (path.size() > n && path[n] != '/')) return false;
+    rebased = root + path.substr(n);
+    return true;
+}
+
+std::string host_path(const std::string& path) {
+    std::string rebased;
+    if (rebase(path, "/sys", sysfs_root, rebased) || rebase(path, "/proc", procfs_root, rebased)) return rebased;
+    return path;
+}
+
+// Definition of external variables for host paths
+std::string sysfs_root, procfs_root;
+
@@ -0,0 +1,18 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_HostPaths
+#define LibSensorTools_HostPaths
+
+#include <string> // Roots and rewritten paths
+
+// Collectors name kernel files by their usual absolute paths (/sys/class/hwmon, /proc/stat, ...)
+// host_path() moves those under another root, so a captured or generated tree (see sensortools-simtree) is read instead
+// Resolve paths at cache time: the roots are only known once arguments are parsed
+std::string host_path(const std::string& path);
+
+extern std::string sysfs_root, procfs_root; // Empty == the live /sys and /proc
+#endif
+
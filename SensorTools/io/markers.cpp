@@ -0,0 +1,60 @@
+#include "markers.h"
+
+#include <cerrno> // errno, EEXIST
+#include <cstring> // strerror()
+#include <fcntl.h> // open() flags
+#include <unistd.h> // read(), close(), unlink()
+#include <sys/stat.h> // mkfifo(), stat()
+
+bool MarkerInbox::open(const std::string& fifo_path, std::ostream& error_log) {
+    path = fifo_path;
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        if (mkfifo(path.c_str(), 0600) != 0) {
+            error_log << "Unable to create marker FIFO " << path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        created = true;
+    }
+    else if (!S_ISFIFO(info.st_mode)) {
+        error_log << "Marker path " << path << " exists and is not a FIFO" << std::endl;
+        return false;
+    }
+    // Holding a write end as well keeps reads returning EAGAIN instead of EOF while no sender has it open
+    fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        error_log << "Unable to open marker FIFO " << path << ": " << strerror(errno) << std::endl;
+        if (created) unlink(path.c_str());
+        created = false;
+        return false;
+    }
+    return true;
+}
+
+std::vector<nlohmann::json> MarkerInbox::drain(void) {
+    std::vector<nlohmann::json> received;
+    if (fd < 0) return received;
+    char buf[MarkerReadSize];
+    ssize_t nbytes;
+    while ((nbytes = read(fd, buf, sizeof(buf))) > 0) pending.append(buf, nbytes);
+    size_t start = 0;
+    for (size_t end = pending.find('\n'); end != std::string::npos; start = end + 1, end = pending.find('\n', start)) {
+        std::string line = pending.substr(start, end - start);
+        if (line.empty()) continue;
+        nlohmann::json payload = nlohmann::json::parse(line, nullptr, false);
+        if (payload.is_discarded() || !payload.is_object()) payload = {{"text", line}};
+        received.push_back(payload);
+    }
+    pending.erase(0, start);
+    return received;
+}
+
+void MarkerInbox::close(void) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    if (created) unlink(path.c_str());
+    created = false;
+}
+
+// Definition of external variables for markers
+MarkerInbox markers;
@@ -0,0 +1,40 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Markers
+#define LibSensorTools_Markers
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <string> // FIFO path, partial lines
+#include <vector> // Markers received per drain
+#include <ostream> // Diagnostics go to the caller's error log
+#include <nlohmann/json.hpp> // Marker payloads
+// End Headers
+
+#define MarkerEnvironment "SENSORTOOLS_MARKERS" // Set for the wrapped command to the FIFO path given by -m | --markers
+#define MarkerReadSize 4096
+
+// Phase markers written by other programs (ie: sensortools-load) into a named pipe, one JSON object per line
+// Lines of at most PIPE_BUF bytes are written atomically, so several writers may share the pipe
+// Each poll drains whatever has arrived; senders put their own CLOCK_MONOTONIC edge time in the payload
+// (edge-monotonic-ns), which shares the base of every event's monotonic-ns, so edges are placed more precisely than the poll interval
+class MarkerInbox {
+public:
+    // Create the FIFO when it does not exist yet and open it without blocking
+    bool open(const std::string& path, std::ostream& error_log);
+    bool is_open(void) const { return fd >= 0; }
+    // Every complete line received since the last drain; lines that are not JSON objects arrive as {"text": line}
+    std::vector<nlohmann::json> drain(void);
+    // Close, removing the FIFO if open() created it
+    void close(void);
+private:
+    int fd = -1;
+    bool created = false;
+    std::string path, pending;
+};
+
+extern MarkerInbox markers;
+#endif
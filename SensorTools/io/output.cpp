@@ -50,6 +50,11 @@ std::ostream& operator<<(std::ostream& os, Output& obj) {
 // Properly close any open file handles and maintain internal state
 void Output::closeFile(void) {
     if (fileStream.is_open() && is_custom()) fileStream.close();
+    if (syncFd != -1) {
+        close(syncFd);
+        syncFd = -1;
+        buffer.setSyncFd(-1);
+    }
     std::memset(fname, 0, NAME_BUFFER_SIZE);
 }
 // Open a given file, return if open was OK or not (optional pre-existence check)
@@ -66,6 +71,11 @@ bool Output::openFile(const char * openName, bool exists_ok = true) {
         if (detectedAsSudo && (chown(openName, sudo_uid, sudo_gid) == -1))
             std::cerr << "Failed to change ownership of file '" << openName <<"', will be owned by root" << std::endl;
         std::strncpy(fname, openName, NAME_BUFFER_SIZE);
+        // Framed files need a raw descriptor to push sync points to disk
+        if (buffer.isFramed()) {
+            syncFd = open(openName, O_WRONLY);
+            buffer.setSyncFd(syncFd);
+        }
         return true;
     }
     else {
@@ -96,3 +106,16 @@ bool Output::redirect(const char * openName, bool exists_ok=true) {
 // Change output destination to given filesystem path
 bool Output::redirect(std::filesystem::path fpath, bool exists_ok=true) { return redirect(fpath.string().c_str(), exists_ok); }
 
+// Enable record framing, including a sync descriptor when already writing to a file
+void Output::frame(int per_sync) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    buffer.setFraming(true, per_sync);
+    if (syncFd == -1 && fname[0]) {
+        syncFd = open(fname, O_WRONLY);
+        buffer.setSyncFd(syncFd);
+    }
+}
+bool Output::is_framed() { return buffer.isFramed(); }
+// Record grouping for multi-line output
+void Output::beginRecord() { buffer.beginRecord(); }
+void Output::endRecord() { buffer.endRecord(); }
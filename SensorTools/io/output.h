@@ -12,6 +12,7 @@
 #include <iostream> // std file descriptors
 #include <fstream> // for ostream classes/types
 #include <unistd.h> // for chown() and the uid_t, gid_t types
+#include <fcntl.h> // open() for the descriptor used at framed sync points
 #include <mutex> // Currently single-threaded, but permit thread safety for IO
 #include <string> // String class and manipulation
 #include <cstring> // strncopy(), memset()
@@ -29,6 +30,7 @@ private:
     std::mutex fileMutex;
     std::ofstream fileStream;
     char fname[NAME_BUFFER_SIZE];
+    int syncFd = -1;
 
     bool detectSudo(void);
     bool openFile(const char* openName, bool exists_ok);
@@ -51,6 +53,12 @@ public:
     bool redirect(std::filesystem::path fpath, bool exists_ok);
     // Safely close any existing file (except std::cout/std::cerr) and return output to std descriptor
     void revert();
+    // Wrap each record in a length+CRC frame, forcing a sync point to disk every per_sync records (0 == never)
+    void frame(int per_sync);
+    bool is_framed();
+    // Group multiple flushes into a single record (no effect when unframed)
+    void beginRecord();
+    void endRecord();
 };
 #endif
 
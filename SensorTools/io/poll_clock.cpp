@@ -0,0 +1,28 @@
+#include "poll_clock.h"
+
+void PollClock::configure(bool use_virtual_time) {
+    virtual_time = use_virtual_time;
+}
+
+bool PollClock::is_virtual(void) const { return virtual_time; }
+
+void PollClock::pace(bool real_time) {
+    paced = real_time;
+}
+
+PollClock::time_point PollClock::now(void) const {
+    return std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(skipped_ns.load(std::memory_order_relaxed)));
+}
+
+void PollClock::sleep_for(std::chrono::duration<double> duration) {
+    if (virtual_time && !paced) skipped_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+    else std::this_thread::sleep_for(duration);
+}
+
+double PollClock::skipped(void) const {
+    return skipped_ns.load(std::memory_order_relaxed) / 1e9;
+}
+
+// Definition of external variables for the poll clock
+PollClock poll_clock;
+
@@ -0,0 +1,37 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_PollClock
+#define LibSensorTools_PollClock
+
+#include <chrono> // Wall clock, durations
+#include <thread> // Real sleeps
+#include <atomic> // Skipped time may be read from sink threads
+#include <cstdint> // int64_t
+
+// Time source for polling, waits and timestamps
+// On the real clock this is system_clock and std::this_thread::sleep_for
+// On the virtual clock every sleep between polls is skipped and added to now() instead, so virtual time
+// runs at the speed of collection: a day of polling every second costs 86400 poll cycles of real time
+// A wrapped command runs in real time, so pace(true) keeps sleeps real while one is alive
+class PollClock {
+public:
+    typedef std::chrono::time_point<std::chrono::system_clock> time_point;
+    void configure(bool virtual_time);
+    bool is_virtual(void) const;
+    // Real sleeps while paced, even on the virtual clock
+    void pace(bool paced);
+    time_point now(void) const;
+    void sleep_for(std::chrono::duration<double> duration);
+    // Seconds of sleep skipped so far
+    double skipped(void) const;
+private:
+    bool virtual_time = false, paced = false;
+    std::atomic<int64_t> skipped_ns{0};
+};
+
+extern PollClock poll_clock;
+#endif
+
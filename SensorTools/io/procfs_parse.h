@@ -0,0 +1,80 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_ProcfsParse
+#define LibSensorTools_ProcfsParse
+
+#include <cstdint> // uint64_t
+#include <cstddef> // size_t
+#include <cstring> // strlen(), memcmp()
+#include <unistd.h> // pread()
+
+// Keyed counters in procfs/cgroupfs text files, ie:
+//     "usage_usec 123" (cpu.stat, /proc/vmstat), "MemFree:  123 kB" (/proc/meminfo),
+//     "8:0 rbytes=123 wbytes=..." (io.stat), "some avg10=0.00 ... total=123" (pressure files)
+// Keys include their separator ("usage_usec ", "rbytes=", "MemFree:") and only match at the start of a token
+// Nothing here allocates, so collectors can parse a pread buffer at every poll
+
+// Current length of a generated procfs file, which stat() reports as 0; sizes a collector's read buffer at cache time
+static inline size_t procfs_length(int fd) {
+    char chunk[4096];
+    size_t total = 0;
+    ssize_t n;
+    while ((n = pread(fd, chunk, sizeof(chunk), total)) > 0) total += n;
+    return total;
+}
+
+// Decimal digits at p, skipping leading spaces; stops at end
+static inline uint64_t procfs_number(const char* p, const char* end) {
+    while (p < end && *p == ' ') p++;
+    uint64_t value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) value = value * 10 + (*p - '0');
+    return value;
+}
+
+// Up to n numbers following p on its line, ie: the columns after a device name; returns how many were read
+static inline int procfs_numbers(const char* p, const char* end, uint64_t* values, int n) {
+    int count = 0;
+    while (count < n && p < end && *p != '\n') {
+        if (*p < '0' || *p > '9') { p++; continue; }
+        uint64_t value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) value = value * 10 + (*p - '0');
+        values[count++] = value;
+    }
+    return count;
+}
+
+// Start of the first token key in buf[0..len), or nullptr
+static inline const char* procfs_find(const char* buf, size_t len, const char* key) {
+    size_t n = strlen(key);
+    for (size_t i = 0; i + n <= len; i++)
+        if ((i == 0 || buf[i-1] == ' ' || buf[i-1] == '\n') && memcmp(buf + i, key, n) == 0) return buf + i;
+    return nullptr;
+}
+
+// Value after the first key; found (when given) reports whether the key exists
+static inline uint64_t procfs_field(const char* buf, size_t len, const char* key, bool* found = nullptr) {
+    const char* at = procfs_find(buf, len, key);
+    if (found != nullptr) *found = (at != nullptr);
+    return (at == nullptr) ? 0 : procfs_number(at + strlen(key), buf + len);
+}
+
+// Sum of the values after every key, ie: rbytes= across every device line of io.stat
+static inline uint64_t procfs_field_sum(const char* buf, size_t len, const char* key) {
+    uint64_t sum = 0;
+    size_t n = strlen(key);
+    for (const char* at = procfs_find(buf, len, key); at != nullptr; at = procfs_find(at + n, len - (at + n - buf), key))
+        sum += procfs_number(at + n, buf + len);
+    return sum;
+}
+
+// Cumulative stall microseconds of a pressure file's "some" or "full" line ("full" is absent for cpu on older kernels)
+static inline uint64_t procfs_pressure_total(const char* buf, size_t len, const char* line) {
+    const char* at = procfs_find(buf, len, line);
+    if (at == nullptr) return 0;
+    const char* eol = static_cast<const char*>(memchr(at, '\n', len - (at - buf)));
+    return procfs_field(at, ((eol == nullptr) ? buf + len : eol) - at, "total=");
+}
+#endif
@@ -0,0 +1,67 @@
+#include "record_frame.h"
+
+#include <cstring> // memcpy()
+
+// Slicing-by-8 tables for the reflected zlib polynomial, built once at startup
+static uint32_t crc_table[8][256];
+static bool init_crc_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+        for (int t = 1; t < 8; t++)
+            crc_table[t][i] = (crc_table[t-1][i] >> 8) ^ crc_table[0][crc_table[t-1][i] & 0xFF];
+    return true;
+}
+static const bool crc_table_ready = init_crc_table();
+
+uint32_t record_crc32(uint32_t crc, const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    // Eight bytes per step while possible (little-endian load order is assumed, as everywhere else in this tool)
+    while (len >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p+4, 4);
+        lo ^= crc;
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = crc_table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void append_record_frame(std::string& out, uint16_t kind, uint64_t sequence, const char* payload, size_t len) {
+    record_frame_header header = {RecordFrameMagic, kind, 0, static_cast<uint32_t>(len), 0, sequence};
+    uint32_t crc = record_crc32(0, &header, sizeof(header));
+    header.crc = record_crc32(crc, payload, len);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(payload, len);
+}
+
+int scan_record_frame(const char* buf, size_t len, record_frame_header* header) {
+    if (len < sizeof(record_frame_header)) {
+        // Reject early if even the partial magic is wrong
+        uint32_t magic = RecordFrameMagic;
+        if (std::memcmp(buf, &magic, (len < 4) ? len : 4) != 0) return ScanCorrupt;
+        return ScanIncomplete;
+    }
+    std::memcpy(header, buf, sizeof(record_frame_header));
+    if (header->magic != RecordFrameMagic ||
+        header->kind >= count_RecordFrameKinds ||
+        header->length > RecordFrameMaxPayload) return ScanCorrupt;
+    if (len - sizeof(record_frame_header) < header->length) return ScanIncomplete;
+    uint32_t expected = header->crc;
+    header->crc = 0;
+    uint32_t crc = record_crc32(0, header, sizeof(record_frame_header));
+    crc = record_crc32(crc, buf + sizeof(record_frame_header), header->length);
+    header->crc = expected;
+    return (crc == expected) ? ScanComplete : ScanCorrupt;
+}
+
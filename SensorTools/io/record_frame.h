@@ -0,0 +1,46 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_RecordFrame
+#define LibSensorTools_RecordFrame
+
+#include "../enums.h" // RecordFrameKinds
+
+#include <cstdint> // fixed-width integer types
+#include <cstddef> // size_t
+#include <string> // String class used as an append buffer
+
+// Framed logs wrap every record as [header][payload]
+// The CRC covers the header (with its crc field zeroed) and the payload, so a torn write anywhere in the record is detected
+// The CRC is the same CRC-32 used by zlib, so analysis scripts can validate frames with zlib.crc32()
+#define RecordFrameMagic 0x46524C53 // Reads as "SLRF" on disk for little-endian hosts
+#define RecordFrameMaxPayload (64u << 20) // Anything longer than this is treated as corruption
+
+typedef struct record_frame_header_t {
+    uint32_t magic;
+    uint16_t kind; // RecordFrameKinds
+    uint16_t reserved;
+    uint32_t length; // Bytes of payload following this header
+    uint32_t crc;
+    uint64_t sequence; // Monotonic record counter within one writer
+} record_frame_header;
+static_assert(sizeof(record_frame_header) == 24, "record_frame_header must not contain padding");
+
+// Results of inspecting the bytes at the start of a buffer
+enum RecordFrameScanResults {
+ScanComplete, // A full, valid frame is present
+ScanIncomplete, // Not enough bytes yet to decide
+ScanCorrupt, // Bytes can never form a valid frame
+count_RecordFrameScanResults
+};
+
+// Incremental CRC-32 (zlib polynomial); pass 0 as the initial crc
+uint32_t record_crc32(uint32_t crc, const void* data, size_t len);
+// Append one complete frame (header + payload) to out
+void append_record_frame(std::string& out, uint16_t kind, uint64_t sequence, const char* payload, size_t len);
+// Validate the frame at the start of buf; on ScanComplete the header is copied out and the payload follows it in buf
+int scan_record_frame(const char* buf, size_t len, record_frame_header* header);
+#endif
+
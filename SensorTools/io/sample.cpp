@@ -0,0 +1,21 @@
+#include "sample.h"
+
+#include <cmath> // NAN
+
+int SampleBuilder::add_channel(const std::string& csv_name, const std::string& json_name, const std::string& human_name, int kind) {
+    channels.push_back({csv_name, json_name, human_name, kind});
+    staged.values.push_back(NAN);
+    staged.text.emplace_back();
+    return static_cast<int>(channels.size()) - 1;
+}
+
+std::shared_ptr<const sample_record> SampleBuilder::finish(uint64_t index, double timestamp, double update_duration) {
+    staged.index = index;
+    staged.timestamp = timestamp;
+    staged.update_duration = update_duration;
+    return std::make_shared<const sample_record>(staged);
+}
+
+// Definition of external variables for sample tools
+SampleBuilder samples;
+
@@ -0,0 +1,51 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Sample
+#define LibSensorTools_Sample
+
+#include "../enums.h" // SampleChannelKinds
+
+#include <cstdint> // uint64_t
+#include <string> // String class and manipulation
+#include <vector> // Channel and value storage
+#include <memory> // shared_ptr so one sample can be handed to every sink
+
+// One named value reported by a collector on every poll
+typedef struct sample_channel_t {
+    std::string csv_name, json_name, human_name;
+    int kind; // SampleChannelKinds
+} sample_channel;
+
+// One poll's worth of values, immutable once published
+typedef struct sample_record_t {
+    uint64_t index; // Samples published before this one
+    double timestamp; // Seconds since the polling time origin
+    double update_duration; // Seconds spent collecting this sample
+    std::vector<double> values; // Indexed by channel; NaN until a collector reports
+    std::vector<std::string> text; // Indexed by channel; only used by ChannelText channels
+} sample_record;
+
+// Collectors register their channels while caching and set values while updating
+// Each poll is then published as a single immutable record shared by every sink
+// Values persist between polls, so a collector that fails to update repeats its last reading as before
+class SampleBuilder {
+private:
+    std::vector<sample_channel> channels;
+    sample_record staged;
+public:
+    int add_channel(const std::string& csv_name, const std::string& json_name, const std::string& human_name, int kind = ChannelNumeric);
+    void set(int channel, double value) { staged.values[channel] = value; }
+    void set_text(int channel, const std::string& value) { staged.text[channel] = value; }
+    double get(int channel) const { return staged.values[channel]; }
+    const std::vector<sample_channel>& schema(void) const { return channels; }
+    size_t size(void) const { return channels.size(); }
+    // Snapshot the staged values into a new record
+    std::shared_ptr<const sample_record> finish(uint64_t index, double timestamp, double update_duration);
+};
+
+extern SampleBuilder samples;
+#endif
+
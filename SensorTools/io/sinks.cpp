@@ -0,0 +1,569 @@
+#include "sinks.h"
+
+#include <cmath> // isnan(), isinf(), floor(), fabs()
+#include <cstdlib> // atexit(), atol()
+#include <cstring> // memcpy(), strerror()
+#include <cerrno> // errno
+#include <csignal> // sigset_t, pthread_sigmask()
+#include <filesystem> // Pre-existence checks for file sinks
+#include <sys/mman.h> // shm_open(), mmap(), munmap(), shm_unlink()
+#include <sys/socket.h> // socket(), connect(), send(), setsockopt()
+#include <sys/time.h> // timeval for SO_SNDTIMEO
+#include <netdb.h> // getaddrinfo()
+#include <fcntl.h> // O_* flags
+#include <unistd.h> // ftruncate(), close()
+#include <nlohmann/json.hpp> // String escaping for JSON text values
+
+// Names as they appear in sink specifications, in SinkKinds order
+static const char* sink_kind_names[count_SinkKinds] = {
+    "file",
+    "gzip",
+    "shm",
+    "tcp",
+};
+
+const char* sink_kind_name(int kind) {
+    if (kind < 0 || kind >= count_SinkKinds) return "unknown";
+    return sink_kind_names[kind];
+}
+
+// Signals that run shutdown() must not interrupt a queue operation (shutdown drains those same queues),
+// and sink threads must never be the ones to receive them
+class ShutdownSignalBlock {
+private:
+    sigset_t previous;
+public:
+    ShutdownSignalBlock(void) {
+        sigset_t blocked;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGINT);
+        sigaddset(&blocked, SIGTERM);
+        sigaddset(&blocked, SIGABRT);
+        pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+    }
+    ~ShutdownSignalBlock(void) { pthread_sigmask(SIG_SETMASK, &previous, nullptr); }
+};
+
+// Whole numbers are written without a fraction (frequencies, byte counts), anything else at stream precision
+static void put_value(std::ostream& out, double value, bool json) {
+    if (std::isnan(value) || std::isinf(value)) {
+        if (json) out << "null";
+        else out << value;
+    }
+    else if (value == std::floor(value) && std::fabs(value) < 1e15) out << static_cast<long long>(value);
+    else out << value;
+}
+
+/*
+    Sink
+*/
+Sink::Sink(short format, size_t depth, const std::string& description) :
+           format(format), depth(depth), description(description) {}
+
+void Sink::push(const sink_item& item) {
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        // Events and text count against depth too, so a stalled sink never grows without bound
+        if (lossless) room.wait(guard, [this]{ return queue.size() < depth || finished; });
+        if (queue.size() >= depth) {
+            dropped++;
+            return;
+        }
+        queue.push_back(item);
+    }
+    ready.notify_one();
+}
+
+void Sink::start(const std::vector<sample_channel>* sample_schema) {
+    schema = sample_schema;
+    worker = std::thread(&Sink::run, this);
+}
+
+bool Sink::stop(double timeout) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    if (!worker.joinable()) return true;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        if (!done.wait_for(guard, std::chrono::duration<double>(timeout), [this]{ return finished; })) {
+            worker.detach();
+            return false;
+        }
+    }
+    worker.join();
+    return true;
+}
+
+void Sink::run(void) {
+    bool opened = false, last = false;
+    std::chrono::steady_clock::time_point next_open = std::chrono::steady_clock::now();
+    std::string out;
+    while (!last) {
+        std::deque<sink_item> batch;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this]{ return stopping || !queue.empty(); });
+            batch.swap(queue);
+            last = stopping;
+        }
+        room.notify_all();
+        if (!opened && std::chrono::steady_clock::now() >= next_open) {
+            opened = open();
+            if (opened) {
+                out.clear();
+                if (wantsHeader()) renderHeader(out);
+                if (!out.empty() && !write(out)) {
+                    close();
+                    opened = false;
+                }
+            }
+            if (!opened) next_open = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SinkReopenDelay));
+        }
+        for (std::deque<sink_item>::iterator i = batch.begin(); i != batch.end(); i++) {
+            if (opened) {
+                out.clear();
+                render(*i, out);
+                if (write(out)) {
+                    delivered++;
+                    continue;
+                }
+                close();
+                opened = false;
+                next_open = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SinkReopenDelay));
+            }
+            dropped++;
+        }
+        if (opened) flush();
+    }
+    if (opened) {
+        out.clear();
+        renderFooter(out);
+        if (!out.empty()) write(out);
+        flush();
+        close();
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        finished = true;
+    }
+    done.notify_all();
+    room.notify_all();
+}
+
+void Sink::renderHeader(std::string& out) {
+    switch (format) {
+        case OutputCSV:
+            out += "timestamp";
+            if (schema != nullptr)
+                for (std::vector<sample_channel>::const_iterator i = schema->begin(); i != schema->end(); i++)
+                    out += "," + i->csv_name;
+            out += "\n";
+            break;
+        case OutputHuman:
+            break;
+        case OutputJSON:
+            out += "[\n";
+            break;
+    }
+}
+
+void Sink::renderFooter(std::string& out) {
+    if (format == OutputJSON) out += "]\n";
+}
+
+void Sink::render(const sink_item& item, std::string& out) {
+    if (item.kind == SinkItemText) {
+        out = *item.text;
+        return;
+    }
+    render_buffer.str("");
+    render_buffer.clear();
+    std::ostream& os = render_buffer;
+    if (item.kind == SinkItemEvent) {
+        // Events are only queued to JSON sinks
+        write_event_json(os, *item.event);
+        out = render_buffer.str();
+        return;
+    }
+    const sample_record& sample = *item.sample;
+    size_t n = (schema == nullptr) ? 0 : schema->size();
+    switch (format) {
+        case OutputCSV:
+            os << sample.timestamp;
+            for (size_t i = 0; i < n; i++) {
+                os << ",";
+                if ((*schema)[i].kind == ChannelText) os << sample.text[i];
+                else put_value(os, sample.values[i], false);
+            }
+            os << "\n";
+            break;
+        case OutputHuman:
+            os << "Poll update at " << sample.timestamp << "\n";
+            for (size_t i = 0; i < n; i++) {
+                os << (*schema)[i].human_name << ": ";
+                if ((*schema)[i].kind == ChannelText) os << sample.text[i];
+                else put_value(os, sample.values[i], false);
+                os << "\n";
+            }
+            break;
+        case OutputJSON:
+            os << "{\"event\": \"poll-data\", \"timestamp\": " << sample.timestamp << ",\n";
+            for (size_t i = 0; i < n; i++) {
+                os << "\t\"" << (*schema)[i].json_name << "\": ";
+                if ((*schema)[i].kind == ChannelText) os << nlohmann::json(sample.text[i]).dump();
+                else put_value(os, sample.values[i], true);
+                os << ",\n";
+            }
+            os << "\"poll-update-duration\": " << sample.update_duration << "\n},\n";
+            break;
+    }
+    out = render_buffer.str();
+}
+
+/*
+    OutputSink
+*/
+OutputSink::OutputSink(Output* out, short format, size_t depth, const std::string& description) :
+                       Sink(format, depth, description), out(out) {}
+OutputSink::OutputSink(std::unique_ptr<Output> owned_output, short format, size_t depth, const std::string& description) :
+                       Sink(format, depth, description), out(owned_output.get()), owned(std::move(owned_output)) {}
+
+bool OutputSink::write(const std::string& data) {
+    // Each rendered item is one record when the output is framed
+    out->beginRecord();
+    out->write(data.data(), data.size());
+    out->flush();
+    out->endRecord();
+    return true;
+}
+
+// Skip the CSV header if appending to a file that already has content
+bool OutputSink::wantsHeader(void) {
+    return !(format == OutputCSV && out->tellp() > 0);
+}
+
+/*
+    GzipSink
+*/
+#ifdef SINK_GZIP_ENABLED
+GzipSink::GzipSink(const std::string& path, gzFile file, short format, size_t depth, const std::string& description) :
+                   Sink(format, depth, description), path(path), file(file),
+                   last_flush(std::chrono::steady_clock::now()) {}
+
+// The file opened in SinkGraph::add() is used first; after a failure it is reopened for appending,
+// and gzip readers see the appended member as a continuation of the same stream
+bool GzipSink::open(void) {
+    if (file == nullptr) {
+        file = gzopen(path.c_str(), "ab");
+        reopened = true;
+    }
+    return file != nullptr;
+}
+
+bool GzipSink::write(const std::string& data) {
+    if (data.empty()) return true;
+    if (gzwrite(file, data.data(), static_cast<unsigned>(data.size())) > 0) return true;
+    close();
+    return false;
+}
+
+// A sync flush per poll would ruin the compression ratio; readers see data at most GzipFlushInterval late
+void GzipSink::flush(void) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last_flush).count() < GzipFlushInterval) return;
+    gzflush(file, Z_SYNC_FLUSH);
+    last_flush = now;
+}
+
+void GzipSink::close(void) {
+    if (file != nullptr) gzclose(file);
+    file = nullptr;
+}
+#endif
+
+/*
+    ShmSink
+*/
+ShmSink::ShmSink(const std::string& name, shm_sink_header* segment, size_t mapped, short format, size_t depth, const std::string& description) :
+                 Sink(format, depth, description), name(name), segment(segment), mapped(mapped) {}
+
+bool ShmSink::open(void) {
+    if (segment == nullptr) return false;
+    // Each published record is self-contained, so CSV records carry the header with them
+    prefix.clear();
+    if (format == OutputCSV) renderHeader(prefix);
+    return true;
+}
+
+bool ShmSink::write(const std::string& data) {
+    std::string record = prefix + data;
+    // JSON records stand alone rather than as array elements
+    if (format == OutputJSON) {
+        size_t end = record.find_last_not_of(" \t\r\n");
+        if (end != std::string::npos && record[end] == ',') record.erase(end, 1);
+        if (record == "[\n" || record == "]\n") return true;
+    }
+    size_t length = (record.size() < segment->capacity) ? record.size() : segment->capacity;
+    char* payload = reinterpret_cast<char*>(segment + 1);
+    uint64_t sequence = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&segment->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    std::memcpy(payload, record.data(), length);
+    segment->length = length;
+    segment->records++;
+    __atomic_store_n(&segment->sequence, sequence + 2, __ATOMIC_RELEASE);
+    return true;
+}
+
+void ShmSink::close(void) {
+    if (segment == nullptr) return;
+    munmap(segment, mapped);
+    shm_unlink(name.c_str());
+    segment = nullptr;
+}
+
+/*
+    TcpSink
+*/
+TcpSink::TcpSink(const std::string& host, const std::string& port, short format, size_t depth, const std::string& description) :
+                 Sink(format, depth, description), host(host), port(port) {}
+
+bool TcpSink::open(void) {
+    struct addrinfo hints, *found = nullptr;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) return false;
+    for (struct addrinfo* candidate = found; candidate != nullptr; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (fd == -1) continue;
+        if (connect(fd, candidate->ai_addr, candidate->ai_addrlen) == 0) break;
+        ::close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(found);
+    if (fd == -1) return false;
+    // A stalled peer only ever blocks this sink's thread, but it must not hold up shutdown indefinitely
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    return true;
+}
+
+bool TcpSink::write(const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+void TcpSink::close(void) {
+    if (fd != -1) ::close(fd);
+    fd = -1;
+}
+
+/*
+    SinkGraph
+*/
+bool SinkGraph::add(const sink_spec& spec, std::ostream& errors) {
+    std::string description = std::string(sink_kind_name(spec.kind)) + ":" + spec.target;
+    switch (spec.kind) {
+        case SinkFile: {
+            std::unique_ptr<Output> out(new Output());
+            if (!out->redirect(spec.target.c_str(), false)) {
+                errors << "Unable to open sink " << description << std::endl;
+                return false;
+            }
+            sinks.emplace_back(new OutputSink(std::move(out), spec.format, spec.depth, description));
+            return true;
+        }
+        case SinkGzip: {
+            #ifdef SINK_GZIP_ENABLED
+            if (std::filesystem::exists(spec.target)) {
+                errors << "File '" << spec.target << "' already exists!" << std::endl;
+                return false;
+            }
+            gzFile file = gzopen(spec.target.c_str(), "wb");
+            if (file == nullptr) {
+                errors << "Unable to open sink " << description << std::endl;
+                return false;
+            }
+            sinks.emplace_back(new GzipSink(spec.target, file, spec.format, spec.depth, description));
+            return true;
+            #else
+            errors << "Sink " << description << " requires building with zlib" << std::endl;
+            return false;
+            #endif
+        }
+        case SinkShm: {
+            std::string name = (spec.target[0] == '/') ? spec.target : "/" + spec.target;
+            int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+            if (fd == -1) {
+                errors << "Unable to create shared memory segment '" << name << "': " << strerror(errno) << std::endl;
+                return false;
+            }
+            size_t mapped = sizeof(shm_sink_header) + ShmSinkCapacity;
+            void* region = MAP_FAILED;
+            if (ftruncate(fd, mapped) == 0) region = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (region == MAP_FAILED) {
+                errors << "Unable to map shared memory segment '" << name << "': " << strerror(errno) << std::endl;
+                shm_unlink(name.c_str());
+                return false;
+            }
+            shm_sink_header* segment = static_cast<shm_sink_header*>(region);
+            std::memset(segment, 0, sizeof(shm_sink_header));
+            segment->version = ShmSinkVersion;
+            segment->capacity = ShmSinkCapacity;
+            segment->format = spec.format;
+            __atomic_store_n(&segment->magic, static_cast<uint32_t>(ShmSinkMagic), __ATOMIC_RELEASE);
+            sinks.emplace_back(new ShmSink(name, segment, mapped, spec.format, spec.depth, description));
+            return true;
+        }
+        case SinkTcp: {
+            size_t split = spec.target.rfind(':');
+            sinks.emplace_back(new TcpSink(spec.target.substr(0, split), spec.target.substr(split+1), spec.format, spec.depth, description));
+            return true;
+        }
+    }
+    return false;
+}
+
+void SinkGraph::add_output(Output* out, short format, const std::string& description) {
+    sinks.emplace_back(new OutputSink(out, format, SinkDefaultDepth, description));
+    // The main log must hold every sample, so it waits for room where auxiliary sinks drop
+    main_log = sinks.back().get();
+    main_log->set_lossless(true);
+}
+
+bool SinkGraph::has_format(short format) const {
+    for (std::vector<std::unique_ptr<Sink>>::const_iterator i = sinks.begin(); i != sinks.end(); i++)
+        if ((*i)->get_format() == format) return true;
+    return false;
+}
+
+void SinkGraph::set_lossless(bool wait_for_room) {
+    for (std::vector<std::unique_ptr<Sink>>::iterator i = sinks.begin(); i != sinks.end(); i++)
+        if (i->get() != main_log) (*i)->set_lossless(wait_for_room);
+}
+
+std::vector<std::string> SinkGraph::describe(void) const {
+    std::vector<std::string> descriptions;
+    for (std::vector<std::unique_ptr<Sink>>::const_iterator i = sinks.begin(); i != sinks.end(); i++)
+        descriptions.push_back((*i)->get_description());
+    return descriptions;
+}
+
+// Error paths call exit() directly; sink threads must be drained before static destructors run
+static SinkGraph* running_graph = nullptr;
+static void stop_running_graph(void) {
+    if (running_graph != nullptr) running_graph->stop(std::cerr);
+}
+
+void SinkGraph::start(void) {
+    if (started) return;
+    started = true;
+    running_graph = this;
+    std::atexit(stop_running_graph);
+    // Threads inherit the mask, keeping shutdown signals on the collection thread
+    ShutdownSignalBlock block;
+    for (std::vector<std::unique_ptr<Sink>>::iterator i = sinks.begin(); i != sinks.end(); i++)
+        (*i)->start(&samples.schema());
+}
+
+void SinkGraph::push(const sink_item& item, short only_format) {
+    ShutdownSignalBlock block;
+    for (std::vector<std::unique_ptr<Sink>>::iterator i = sinks.begin(); i != sinks.end(); i++)
+        if (only_format < 0 || (*i)->get_format() == only_format) (*i)->push(item);
+}
+
+void SinkGraph::publish(std::shared_ptr<const sample_record> sample) {
+    push({SinkItemSample, sample, nullptr, nullptr}, -1);
+}
+
+void SinkGraph::publish_event(const event_record& record) {
+    push({SinkItemEvent, nullptr, std::make_shared<const event_record>(record), nullptr}, OutputJSON);
+}
+
+void SinkGraph::broadcast(short format, const std::string& text) {
+    push({SinkItemText, nullptr, nullptr, std::make_shared<const std::string>(text)}, format);
+}
+
+void SinkGraph::stop(std::ostream& errors) {
+    if (stopped) return;
+    // Interrupted before polling began: still deliver everything queued so far
+    start();
+    stopped = true;
+    for (std::vector<std::unique_ptr<Sink>>::iterator i = sinks.begin(); i != sinks.end(); i++) {
+        if ((*i)->stop(SinkStopTimeout)) {
+            if ((*i)->get_dropped() > 0)
+                errors << "Sink " << (*i)->get_description() << " dropped " << (*i)->get_dropped() << " of " <<
+                          (*i)->get_dropped() + (*i)->get_delivered() << " records" << std::endl;
+        }
+        else {
+            errors << "Sink " << (*i)->get_description() << " did not drain within " << SinkStopTimeout << "s; abandoning its remaining output" << std::endl;
+            // Its detached thread still uses the sink, so it is never destroyed
+            i->release();
+        }
+    }
+}
+
+bool parse_sink_spec(const std::string& text, sink_spec& spec, std::string& error) {
+    std::vector<std::string> fields;
+    size_t begin = 0, end;
+    while ((end = text.find(':', begin)) != std::string::npos) {
+        fields.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    fields.push_back(text.substr(begin));
+    if (fields.size() < 3) {
+        error = "Sinks are specified as KIND:FORMAT:TARGET[:DEPTH]";
+        return false;
+    }
+    spec.kind = -1;
+    for (int k = 0; k < count_SinkKinds; k++)
+        if (fields[0] == sink_kind_names[k]) spec.kind = k;
+    if (spec.kind == -1) {
+        error = "Unknown sink kind '" + fields[0] + "'";
+        return false;
+    }
+    if (fields[1] == "csv" || fields[1] == "0") spec.format = OutputCSV;
+    else if (fields[1] == "human" || fields[1] == "1") spec.format = OutputHuman;
+    else if (fields[1] == "json" || fields[1] == "2") spec.format = OutputJSON;
+    else {
+        error = "Unknown sink format '" + fields[1] + "' (csv, human or json)";
+        return false;
+    }
+    // TCP targets are HOST:PORT
+    size_t target_fields = (spec.kind == SinkTcp) ? 2 : 1;
+    if (fields.size() < 2 + target_fields || fields.size() > 3 + target_fields) {
+        error = (spec.kind == SinkTcp) ? "TCP sinks are specified as tcp:FORMAT:HOST:PORT[:DEPTH]"
+                                       : "Sinks are specified as KIND:FORMAT:TARGET[:DEPTH]";
+        return false;
+    }
+    spec.target = fields[2];
+    if (target_fields == 2) spec.target += ":" + fields[3];
+    if (spec.target.empty() || spec.target == ":") {
+        error = "Sink target must not be empty";
+        return false;
+    }
+    spec.depth = SinkDefaultDepth;
+    if (fields.size() == 3 + target_fields) {
+        long depth = atol(fields.back().c_str());
+        if (depth <= 0) {
+            error = "Sink depth must be greater than 0";
+            return false;
+        }
+        spec.depth = depth;
+    }
+    return true;
+}
+
@@ -0,0 +1,202 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Sinks
+#define LibSensorTools_Sinks
+
+#include "../enums.h" // SinkKinds, SinkItemKinds, OutputFormats
+#include "sample.h" // Sample schema and records
+#include "events.h" // Event records are inlined in JSON sinks
+#include "output.h" // Output class used by file sinks
+
+#include <cstdint> // uint64_t, fixed-width shared memory layout
+#include <string> // String class and manipulation
+#include <vector> // Sink list
+#include <deque> // Per-sink queues
+#include <memory> // unique_ptr, shared_ptr
+#include <thread> // One worker per sink
+#include <mutex> // Queue protection
+#include <condition_variable> // Worker wakeups
+#include <atomic> // Drop counters shared with the producer
+#include <chrono> // Stop deadlines, flush pacing
+#include <iostream> // std file descriptors
+#include <sstream> // Rendering buffers
+#ifdef SINK_GZIP_ENABLED
+#include <zlib.h> // gzip sink
+// Must compile with: -lz
+#endif
+
+#define SinkDefaultDepth 1024 // Records a sink may fall behind before it starts dropping (or, for the main log, waiting)
+#define SinkStopTimeout 2.0 // Seconds a sink may take to drain at shutdown before it is abandoned
+#define SinkReopenDelay 1.0 // Seconds between attempts to (re)open a sink that failed
+#define GzipFlushInterval 1.0 // Seconds between gzip sync flushes, trading latency for compression
+
+// Live shared memory segment: a seqlock-protected copy of the most recent record
+// Readers copy the payload while sequence is even and unchanged before/after the copy
+#define ShmSinkMagic 0x4B4E4953 // Reads as "SINK" on disk for little-endian hosts
+#define ShmSinkVersion 1
+#define ShmSinkCapacity (1u << 20) // Payload bytes; larger records are truncated
+typedef struct shm_sink_header_t {
+    uint32_t magic, version;
+    uint64_t capacity;
+    uint64_t sequence; // Odd while the writer is updating the payload
+    uint64_t length; // Valid payload bytes
+    uint64_t records; // Records published so far
+    int32_t format; // OutputFormats
+    uint32_t reserved;
+} shm_sink_header;
+static_assert(sizeof(shm_sink_header) == 48, "shm_sink_header must not contain padding");
+
+// Parsed form of KIND:FORMAT:TARGET[:DEPTH]
+typedef struct sink_spec_t {
+    int kind; // SinkKinds
+    short format; // OutputFormats
+    std::string target;
+    size_t depth = SinkDefaultDepth;
+} sink_spec;
+
+// One unit of work for a sink; exactly one pointer is set according to kind
+typedef struct sink_item_t {
+    int kind; // SinkItemKinds
+    std::shared_ptr<const sample_record> sample;
+    std::shared_ptr<const event_record> event;
+    std::shared_ptr<const std::string> text;
+} sink_item;
+
+// A sink formats and delivers queued items on its own thread
+// Producers never wait on an auxiliary sink: once depth records are queued, further records are dropped and counted
+// Lossless sinks instead make the producer wait for room: always the main log, and every sink for a replayed log
+class Sink {
+private:
+    std::deque<sink_item> queue;
+    std::mutex lock;
+    std::condition_variable ready, done, room;
+    std::thread worker;
+    bool stopping = false, finished = false, lossless = false;
+    std::atomic<uint64_t> dropped{0}, delivered{0};
+    std::ostringstream render_buffer;
+
+    void run(void);
+    void render(const sink_item& item, std::string& out);
+protected:
+    short format;
+    size_t depth;
+    std::string description;
+    const std::vector<sample_channel>* schema = nullptr;
+
+    // Called on the sink thread; retried every SinkReopenDelay seconds while it fails
+    virtual bool open(void) = 0;
+    // Deliver one rendered item; returning false closes the sink until it can be reopened
+    virtual bool write(const std::string& data) = 0;
+    // Called after each batch of queued items has been written
+    virtual void flush(void) {}
+    virtual void close(void) = 0;
+    // Whether the CSV header (or JSON array opening) should be written after opening
+    virtual bool wantsHeader(void) { return true; }
+    void renderHeader(std::string& out);
+    void renderFooter(std::string& out);
+public:
+    Sink(short format, size_t depth, const std::string& description);
+    virtual ~Sink(void) {}
+    short get_format(void) const { return format; }
+    const std::string& get_description(void) const { return description; }
+    uint64_t get_dropped(void) const { return dropped; }
+    uint64_t get_delivered(void) const { return delivered; }
+    void set_lossless(bool wait_for_room) { lossless = wait_for_room; }
+    void push(const sink_item& item);
+    void start(const std::vector<sample_channel>* schema);
+    // Drain and close; returns false when the sink had to be abandoned after timeout seconds
+    bool stop(double timeout);
+};
+
+// Writes through an Output object, so framing, sudo ownership and std descriptors behave as for the main log
+class OutputSink : public Sink {
+private:
+    Output* out;
+    std::unique_ptr<Output> owned;
+protected:
+    bool open(void) override { return true; }
+    bool write(const std::string& data) override;
+    void close(void) override { out->flush(); }
+    bool wantsHeader(void) override;
+public:
+    OutputSink(Output* out, short format, size_t depth, const std::string& description);
+    OutputSink(std::unique_ptr<Output> owned, short format, size_t depth, const std::string& description);
+};
+
+#ifdef SINK_GZIP_ENABLED
+class GzipSink : public Sink {
+private:
+    std::string path;
+    gzFile file;
+    bool reopened = false; // Appends continue the same document, so the header is not repeated
+    std::chrono::steady_clock::time_point last_flush;
+protected:
+    bool open(void) override;
+    bool write(const std::string& data) override;
+    void flush(void) override;
+    void close(void) override;
+    bool wantsHeader(void) override { return !reopened; }
+public:
+    GzipSink(const std::string& path, gzFile file, short format, size_t depth, const std::string& description);
+};
+#endif
+
+class ShmSink : public Sink {
+private:
+    std::string name, prefix;
+    shm_sink_header* segment;
+    size_t mapped;
+protected:
+    bool open(void) override;
+    bool write(const std::string& data) override;
+    void close(void) override;
+    bool wantsHeader(void) override { return false; }
+public:
+    ShmSink(const std::string& name, shm_sink_header* segment, size_t mapped, short format, size_t depth, const std::string& description);
+};
+
+class TcpSink : public Sink {
+private:
+    std::string host, port;
+    int fd = -1;
+protected:
+    bool open(void) override;
+    bool write(const std::string& data) override;
+    void close(void) override;
+public:
+    TcpSink(const std::string& host, const std::string& port, short format, size_t depth, const std::string& description);
+};
+
+// Every published sample, event and text block is produced once and handed to each interested sink
+class SinkGraph {
+private:
+    std::vector<std::unique_ptr<Sink>> sinks;
+    Sink* main_log = nullptr; // Always lossless
+    bool started = false, stopped = false;
+    void push(const sink_item& item, short only_format);
+public:
+    // Create the sink described by spec; errors are reported to errors
+    bool add(const sink_spec& spec, std::ostream& errors);
+    // Attach an existing Output (the main log); it is not closed by the graph and never drops records
+    void add_output(Output* out, short format, const std::string& description);
+    bool has_format(short format) const;
+    std::vector<std::string> describe(void) const;
+    // Make the auxiliary sinks wait for room instead of dropping records too; set before start()
+    void set_lossless(bool wait_for_room);
+    // Freeze the sample schema and start every sink thread
+    void start(void);
+    void publish(std::shared_ptr<const sample_record> sample);
+    void publish_event(const event_record& record);
+    // Pre-rendered text for every sink using format
+    void broadcast(short format, const std::string& text);
+    // Drain every sink and report any data they dropped
+    void stop(std::ostream& errors);
+};
+
+const char* sink_kind_name(int kind);
+bool parse_sink_spec(const std::string& text, sink_spec& spec, std::string& error);
+#endif
+
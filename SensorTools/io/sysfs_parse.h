@@ -0,0 +1,38 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_SysfsParse
+#define LibSensorTools_SysfsParse
+
+#include <cstdint> // uint64_t, int64_t
+#include <cstddef> // size_t
+
+#define SysfsReadSize 32 // Bytes read per sysfs/procfs value; every numeric attribute fits
+#define SysfsMaxDigits 20 // Digits in the largest uint64_t
+
+// Parse the leading decimal digits of buf[0..len), stopping at the first non-digit (sysfs values end in '\n')
+// Runs a fixed number of steps with no data-dependent branches, so polling hundreds of cores never mispredicts
+// buf must hold at least SysfsMaxDigits initialized bytes (pass the whole read buffer, not just the bytes read)
+static inline uint64_t parse_sysfs_uint(const char* buf, size_t len) {
+    uint64_t value = 0, live = ~static_cast<uint64_t>(0);
+    for (size_t i = 0; i < SysfsMaxDigits; i++) {
+        uint64_t digit = static_cast<uint64_t>(static_cast<unsigned char>(buf[i])) - '0';
+        // live stays all-ones while every byte so far was a digit inside the read
+        live &= -static_cast<uint64_t>((digit < 10) & (i < len));
+        value = ((value * 10 + digit) & live) | (value & ~live);
+    }
+    return value;
+}
+
+// As above, accepting a leading '-' (hwmon temperatures can be negative)
+// buf must hold at least SysfsMaxDigits+1 initialized bytes
+static inline int64_t parse_sysfs_int(const char* buf, size_t len) {
+    uint64_t negative = (len > 0) & (buf[0] == '-');
+    uint64_t magnitude = parse_sysfs_uint(buf + negative, len - negative);
+    // Two's complement negation when negative, identity otherwise
+    return static_cast<int64_t>((magnitude ^ -negative) + negative);
+}
+#endif
+
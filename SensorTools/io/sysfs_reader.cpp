@@ -0,0 +1,269 @@
+#include "sysfs_reader.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <cstdlib> // aligned_alloc(), free()
+#include <cstring> // memset(), memcpy(), strerror()
+#include <cerrno> // errno
+#include <algorithm> // std::min
+#include <unistd.h> // pread(), syscall(), close()
+#ifdef SYSFS_URING_ENABLED
+#include <linux/io_uring.h> // io_uring ABI: params, SQE/CQE layouts, opcodes
+#include <sys/syscall.h> // __NR_io_uring_setup, __NR_io_uring_enter, __NR_io_uring_register
+#include <sys/mman.h> // mmap() of the submission and completion rings
+#include <sys/uio.h> // iovec for buffer registration
+#endif
+// End Headers
+
+#define SysfsBufferAlign 4096 // Registered buffers are pinned whole pages
+#define SysfsProbeOps 256 // Opcodes io_uring_probe may describe
+#define SysfsInitialSlots 64
+
+SysfsReader::~SysfsReader(void) {
+    stop();
+    free(buffer);
+}
+
+bool SysfsReader::grow(void) {
+    size_t slots = (capacity == 0) ? SysfsInitialSlots : capacity * 2,
+           bytes = slots * SysfsReadSize;
+    bytes = (bytes + SysfsBufferAlign - 1) / SysfsBufferAlign * SysfsBufferAlign;
+    char* larger = static_cast<char*>(aligned_alloc(SysfsBufferAlign, bytes));
+    if (larger == nullptr) return false;
+    // Zeroed so the parser's fixed-length scan never touches uninitialized bytes
+    memset(larger, 0, bytes);
+    if (buffer != nullptr) memcpy(larger, buffer, capacity * SysfsReadSize);
+    free(buffer);
+    buffer = larger;
+    capacity = bytes / SysfsReadSize;
+    return true;
+}
+
+int SysfsReader::add(int fd) {
+    #ifdef SYSFS_URING_ENABLED
+    // Registration covers a fixed file table and buffer; late additions re-register on the next read
+    if (registered) unregister_uring();
+    #endif
+    if (fds.size() == capacity && !grow()) return -1;
+    fds.push_back(fd);
+    lengths.push_back(0);
+    return static_cast<int>(fds.size() - 1);
+}
+
+void SysfsReader::start(int requested, std::ostream& error_log, short debug) {
+    engine = SysfsPread;
+    #ifdef SYSFS_URING_ENABLED
+    if (requested != SysfsPread && !fds.empty()) {
+        if (setup_uring(error_log, debug)) engine = SysfsUring;
+        else if (requested == SysfsUring || debug >= DebugMinimal)
+            error_log << "io_uring could not be set up for sysfs reads, falling back to pread" << std::endl;
+    }
+    #else
+    if (requested == SysfsUring)
+        error_log << "Built without io_uring support, sysfs reads use pread" << std::endl;
+    #endif
+    if (debug >= DebugMinimal)
+        error_log << "Reading " << fds.size() << " sysfs files per poll via " << engine_name() << std::endl;
+}
+
+const char* SysfsReader::engine_name(void) const {
+    return (engine == SysfsUring) ? "io_uring" : "pread";
+}
+
+int SysfsReader::read_all(void) {
+    if (fds.empty()) return 0;
+    int failed;
+    #ifdef SYSFS_URING_ENABLED
+    if (engine == SysfsUring) failed = read_uring();
+    else
+    #endif
+    failed = read_pread();
+    read_time = poll_clock.now();
+    return failed;
+}
+
+int SysfsReader::read_pread(void) {
+    int failed = 0;
+    for (size_t i = 0; i < fds.size(); i++) {
+        lengths[i] = pread(fds[i], buffer + i * SysfsReadSize, SysfsReadSize, 0);
+        failed += (lengths[i] <= 0);
+    }
+    return failed;
+}
+
+void SysfsReader::stop(void) {
+    #ifdef SYSFS_URING_ENABLED
+    teardown_uring();
+    #endif
+    engine = SysfsPread;
+}
+
+#ifdef SYSFS_URING_ENABLED
+bool SysfsReader::setup_uring(std::ostream& error_log, short debug) {
+    // Smallest power of two covering the registry, capped so huge registries use several batches
+    uint32_t entries = 1;
+    while (entries < fds.size() && entries < SysfsUringDepth) entries <<= 1;
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd < 0) {
+        if (debug >= DebugMinimal) error_log << "io_uring_setup failed: " << strerror(errno) << std::endl;
+        ring_fd = -1;
+        return false;
+    }
+    sq_entries = params.sq_entries;
+    // Map the rings; newer kernels share one mapping for both
+    sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+    sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_map == MAP_FAILED) sq_map = nullptr;
+    if (sq_map != nullptr && single_mmap) cq_map = sq_map;
+    else if (sq_map != nullptr) {
+        cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) cq_map = nullptr;
+    }
+    sqe_map_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    if (cq_map != nullptr) {
+        sqe_map = mmap(nullptr, sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED) sqe_map = nullptr;
+    }
+    if (sqe_map == nullptr) {
+        if (debug >= DebugMinimal) error_log << "Unable to map io_uring rings: " << strerror(errno) << std::endl;
+        teardown_uring();
+        return false;
+    }
+    char *sq = static_cast<char*>(sq_map), *cq = static_cast<char*>(cq_map);
+    sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    sqes = static_cast<struct io_uring_sqe*>(sqe_map);
+    if (!probe_uring(error_log, debug)) {
+        teardown_uring();
+        return false;
+    }
+    register_uring();
+    if (debug >= DebugVerbose)
+        error_log << "io_uring ring of " << sq_entries << " entries, fixed files " << fixed_files <<
+                     ", fixed buffer " << fixed_buffer << std::endl;
+    return true;
+}
+
+// The ring can exist on kernels that lack the read opcodes; every read would then complete with -EINVAL
+bool SysfsReader::probe_uring(std::ostream& error_log, short debug) {
+    std::vector<char> storage(sizeof(struct io_uring_probe) + SysfsProbeOps * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(storage.data());
+    // IORING_REGISTER_PROBE arrived in the same kernel (5.6) as IORING_OP_READ, so failing it rules the ring out
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, SysfsProbeOps) < 0) {
+        if (debug >= DebugMinimal) error_log << "io_uring opcode probe failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    const int needed[] = {IORING_OP_READ, IORING_OP_READ_FIXED};
+    for (int op : needed) {
+        if (op >= probe->ops_len || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            if (debug >= DebugMinimal) error_log << "io_uring does not support opcode " << op << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SysfsReader::register_uring(void) {
+    // Either registration may fail (old kernel, RLIMIT_MEMLOCK); plain reads still work without them
+    fixed_files = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_FILES, fds.data(), fds.size()) == 0;
+    struct iovec region = {buffer, capacity * SysfsReadSize};
+    fixed_buffer = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, &region, 1) == 0;
+    registered = true;
+    return fixed_files && fixed_buffer;
+}
+
+void SysfsReader::unregister_uring(void) {
+    if (fixed_files) syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_FILES, nullptr, 0);
+    if (fixed_buffer) syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    fixed_files = fixed_buffer = registered = false;
+}
+
+void SysfsReader::teardown_uring(void) {
+    if (ring_fd < 0) return;
+    if (sqe_map != nullptr) munmap(sqe_map, sqe_map_size);
+    if (cq_map != nullptr && cq_map != sq_map) munmap(cq_map, cq_map_size);
+    if (sq_map != nullptr) munmap(sq_map, sq_map_size);
+    sq_map = cq_map = sqe_map = nullptr;
+    // Closing the ring drops any registrations with it
+    close(ring_fd);
+    ring_fd = -1;
+    fixed_files = fixed_buffer = registered = false;
+}
+
+int SysfsReader::read_uring(void) {
+    if (!registered) register_uring();
+    int failed = 0;
+    ssize_t rejected = -1; // A slot whose read completed with -EINVAL or -EOPNOTSUPP
+    size_t next = 0;
+    while (next < fds.size()) {
+        uint32_t batch = static_cast<uint32_t>(std::min<size_t>(sq_entries, fds.size() - next)),
+                 tail = *sq_tail, mask = *sq_mask;
+        for (uint32_t b = 0; b < batch; b++) {
+            size_t slot = next + b;
+            uint32_t index = (tail + b) & mask;
+            struct io_uring_sqe* sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = fixed_buffer ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = fixed_files ? static_cast<int>(slot) : fds[slot];
+            sqe->flags = fixed_files ? IOSQE_FIXED_FILE : 0;
+            sqe->addr = reinterpret_cast<uint64_t>(buffer + slot * SysfsReadSize);
+            sqe->len = SysfsReadSize;
+            sqe->off = 0;
+            sqe->buf_index = 0;
+            sqe->user_data = slot;
+            sq_array[index] = index;
+        }
+        // Publish the entries before the kernel can see the new tail
+        __atomic_store_n(sq_tail, tail + batch, __ATOMIC_RELEASE);
+        // Submit and wait in one call; repeat only if interrupted or the kernel took part of the batch
+        uint32_t to_submit = batch, reaped = 0;
+        while (reaped < batch) {
+            long ret = syscall(__NR_io_uring_enter, ring_fd, to_submit, batch - reaped, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                // The ring is unusable; finish this poll and every later one with pread
+                teardown_uring();
+                engine = SysfsPread;
+                return read_pread();
+            }
+            to_submit -= static_cast<uint32_t>(ret);
+            uint32_t head = *cq_head, ready = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != ready; head++, reaped++) {
+                struct io_uring_cqe* cqe = &cqes[head & *cq_mask];
+                lengths[cqe->user_data] = cqe->res;
+                failed += (cqe->res <= 0);
+                if (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) rejected = cqe->user_data;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        // When pread can read a file the ring could not, the kernel rejected the opcode or fixed file/buffer
+        // combination rather than the file; redo this poll and every later one with pread instead of failing each poll
+        if (rejected >= 0) {
+            ssize_t direct = pread(fds[rejected], buffer + rejected * SysfsReadSize, SysfsReadSize, 0);
+            lengths[rejected] = direct;
+            if (direct >= 0) {
+                teardown_uring();
+                engine = SysfsPread;
+                return read_pread();
+            }
+            rejected = -1;
+        }
+        next += batch;
+    }
+    return failed;
+}
+#endif
+
+// Definition of external variables for sysfs reads
+SysfsReader sysfs_reads;
@@ -0,0 +1,81 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_SysfsReader
+#define LibSensorTools_SysfsReader
+
+#include "../enums.h" // SysfsEngines
+#include "sysfs_parse.h" // SysfsReadSize, parse_sysfs_uint()
+#include "poll_clock.h" // When the most recent batch completed
+
+#include <cstdint> // uint64_t, int64_t, uint32_t
+#include <cstddef> // size_t
+#include <sys/types.h> // ssize_t
+#include <vector> // Registered files and results
+#include <ostream> // Diagnostics go to the caller's error log
+
+#define SysfsUringDepth 256 // Submission queue entries; larger registries are read in several batches per poll
+
+// Batched reads of small sysfs/procfs files shared by every collector
+// Collectors register cached fds while caching and read parsed values while updating
+// read_all() refreshes every registered file once per poll:
+//     io_uring   one io_uring_enter() per batch, using registered (fixed) files and one registered buffer
+//     pread      one pread() per file, used when io_uring is unavailable or not requested, or when the running
+//                kernel rejects the read opcodes (checked by probing at setup and again on the first completions)
+// The reader never closes the fds it is given; collectors keep ownership
+class SysfsReader {
+    public:
+        ~SysfsReader(void);
+        // Register an open fd and return its slot, valid for the rest of the run
+        int add(int fd);
+        // Choose the engine once every collector has registered; falls back to pread when io_uring cannot be set up
+        void start(int engine, std::ostream& error_log, short debug);
+        // Read every registered file at offset 0, returns the number of reads that failed
+        int read_all(void);
+        // Results of the most recent read_all() for one slot
+        ssize_t length(int slot) const { return lengths[slot]; }
+        const char* data(int slot) const { return buffer + static_cast<size_t>(slot) * SysfsReadSize; }
+        uint64_t value(int slot) const { return parse_sysfs_uint(data(slot), lengths[slot] > 0 ? lengths[slot] : 0); }
+        int64_t signed_value(int slot) const { return parse_sysfs_int(data(slot), lengths[slot] > 0 ? lengths[slot] : 0); }
+        // Completion time of the most recent read_all() on the poll clock, for collectors that turn counters into rates
+        PollClock::time_point last_read(void) const { return read_time; }
+        size_t size(void) const { return fds.size(); }
+        int active_engine(void) const { return engine; }
+        const char* engine_name(void) const;
+        void stop(void);
+    private:
+        std::vector<int> fds;
+        std::vector<ssize_t> lengths;
+        char* buffer = nullptr; // SysfsReadSize bytes per slot, page-aligned so it can be registered
+        size_t capacity = 0; // Slots the buffer can hold
+        int engine = SysfsPread;
+        PollClock::time_point read_time;
+        bool registered = false; // Files and buffer currently registered with the ring
+        bool grow(void);
+        int read_pread(void);
+        #ifdef SYSFS_URING_ENABLED
+        // Raw io_uring state (liburing is not required)
+        int ring_fd = -1;
+        void *sq_map = nullptr, *cq_map = nullptr, *sqe_map = nullptr;
+        size_t sq_map_size = 0, cq_map_size = 0, sqe_map_size = 0;
+        uint32_t *sq_head = nullptr, *sq_tail = nullptr, *sq_mask = nullptr, *sq_array = nullptr,
+                 *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+        uint32_t sq_entries = 0;
+        struct io_uring_sqe* sqes = nullptr;
+        struct io_uring_cqe* cqes = nullptr;
+        bool fixed_files = false, fixed_buffer = false;
+        bool setup_uring(std::ostream& error_log, short debug);
+        bool probe_uring(std::ostream& error_log, short debug);
+        bool register_uring(void);
+        void unregister_uring(void);
+        void teardown_uring(void);
+        int read_uring(void);
+        #endif
+};
+
+// External variable declarations
+extern SysfsReader sysfs_reads;
+#endif
+
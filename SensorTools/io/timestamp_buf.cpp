@@ -10,6 +10,7 @@ TimestampStringBuf::TimestampStringBuf(std::ostream& stream, bool timestamped =
                     output(&stream) {}
 // Destructor cannot call virtual methods, ensure final flush always occurs
 TimestampStringBuf::~TimestampStringBuf(void) {
+    held = 0;
     if (pbase() != pptr()) putOutput();
 }
 // Ensure buffer properly clears on synchronization
@@ -18,6 +19,11 @@ int TimestampStringBuf::sync(void) {
     return 0;
 }
 void TimestampStringBuf::putOutput() {
+    // Held records are only emitted by endRecord()
+    if (framed && held > 0) return;
+    // Framed records need the timestamp inside the payload, so stage it locally first
+    std::ostringstream staged;
+    std::ostream& destination = framed ? static_cast<std::ostream&>(staged) : *output;
     // Output the timestamp
     if (timestamped) {
         std::chrono::time_point<std::chrono::system_clock> currentTimePoint =
@@ -27,8 +33,20 @@ void TimestampStringBuf::putOutput() {
         std::time_t current_time =
                 std::chrono::system_clock::to_time_t(currentTimePoint);
         std::tm* localTime = std::localtime(&current_time);
-        (*output) << std::put_time(localTime, "[%F %T.")
-                  << std::setfill('0') << std::setw(9) << ns.count() << "] ";
+        destination << std::put_time(localTime, "[%F %T.")
+                    << std::setfill('0') << std::setw(9) << ns.count() << "] ";
+    }
+    if (framed) {
+        // One frame per flush; empty flushes produce no record
+        std::string payload = staged.str() + str();
+        str("");
+        if (payload.empty()) return;
+        frame.clear();
+        append_record_frame(frame, FrameData, sequence++, payload.data(), payload.size());
+        output->write(frame.data(), frame.size());
+        output->flush();
+        if (records_per_sync > 0 && ++records_since_sync >= records_per_sync) putSyncPoint();
+        return;
     }
     // Output the buffer and reset it
     (*output) << str();
@@ -36,6 +54,16 @@ void TimestampStringBuf::putOutput() {
     // Flush the output stream
     output->flush();
 }
+// Sync points mark a position known to be durable on disk
+void TimestampStringBuf::putSyncPoint(void) {
+    records_since_sync = 0;
+    frame.clear();
+    append_record_frame(frame, FrameSync, sequence, reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+    sequence++;
+    output->write(frame.data(), frame.size());
+    output->flush();
+    if (sync_fd != -1) fdatasync(sync_fd);
+}
 // Determine where the output is currently going
 std::ostream* TimestampStringBuf::getOutput() const {
     return output;
@@ -45,3 +73,23 @@ void TimestampStringBuf::changeStream(std::ostream& changedStream) {
     output = &changedStream;
 }
 
+// Enable or disable framing; per_sync > 0 inserts a durable sync point every per_sync records
+void TimestampStringBuf::setFraming(bool enable, int per_sync) {
+    framed = enable;
+    records_per_sync = per_sync;
+}
+// File descriptor used to force data to disk at sync points (-1 when unavailable)
+void TimestampStringBuf::setSyncFd(int fd) {
+    sync_fd = fd;
+}
+bool TimestampStringBuf::isFramed(void) const {
+    return framed;
+}
+// Multi-line records (JSON objects, human-readable polls) are held until complete so they occupy exactly one frame
+void TimestampStringBuf::beginRecord(void) {
+    if (framed) held++;
+}
+void TimestampStringBuf::endRecord(void) {
+    if (!framed || held == 0) return;
+    if (--held == 0) putOutput();
+}
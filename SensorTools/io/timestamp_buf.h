@@ -12,6 +12,9 @@
 #include <sstream> // stringbuf
 #include <chrono> // chrono namespace, time_point, etc
 #include <iomanip> // setw, setfill manipulators
+#include <cstdint> // uint64_t
+#include <unistd.h> // fdatasync()
+#include "record_frame.h" // Framing for crash-consistent records
 
 // Buffering for injecting timestamps with flush
 // Implemented based on SO answer: https://stackoverflow.com/a/2212940/13189459
@@ -19,6 +22,12 @@ class TimestampStringBuf : public std::stringbuf {
     private:
         std::ostream* output;
         bool timestamped;
+        // Framing state: when framed, each flush becomes one length+CRC record unless a record is being held open
+        bool framed = false;
+        int held = 0, records_per_sync = 0, records_since_sync = 0, sync_fd = -1;
+        uint64_t sequence = 0;
+        std::string frame;
+        void putSyncPoint(void);
     public:
         TimestampStringBuf(void);
         TimestampStringBuf(std::ostream& stream, bool timestamped);
@@ -27,6 +36,12 @@ class TimestampStringBuf : public std::stringbuf {
         void putOutput(void);
         std::ostream* getOutput(void) const;
         void changeStream(std::ostream& changedStream);
+        // Framing controls
+        void setFraming(bool enable, int per_sync);
+        void setSyncFd(int fd);
+        bool isFramed(void) const;
+        void beginRecord(void);
+        void endRecord(void);
 };
 #endif
 
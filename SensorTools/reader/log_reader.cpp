@@ -0,0 +1,862 @@
+#include "log_reader.h"
+#include "../io/record_frame.h" // Framed logs are unwrapped before parsing
+
+#include <cmath> // NAN, isnan()
+#include <cstring> // memchr(), memcmp(), memcpy(), strerror()
+#include <cerrno> // errno
+#include <charconv> // from_chars(), to_chars()
+#include <string_view> // Keys and values still inside the log buffer
+#include <unordered_map> // Column lookup by name
+#include <deque> // Stable storage behind string_view keys
+#include <thread> // Parallel chunk parsing
+#include <algorithm> // min(), rotate()
+#include <functional> // std::function
+#include <fcntl.h> // open()
+#include <unistd.h> // close()
+#include <sys/mman.h> // mmap(), madvise(), munmap()
+#include <sys/stat.h> // fstat() for the file size
+#ifdef SINK_GZIP_ENABLED
+#include <zlib.h> // gzip-compressed logs (gzip sinks)
+// Must compile with: -lz
+#endif
+
+// Names reported to callers, in ReaderFormats order
+static const char* reader_format_names[count_ReaderFormats] = {
+    "auto",
+    "csv",
+    "json",
+    "ndjson",
+};
+
+const char* reader_format_name(int format) {
+    if (format < 0 || format >= count_ReaderFormats) return "unknown";
+    return reader_format_names[format];
+}
+
+int find_log_column(const sensor_log& log, const std::string& name) {
+    for (size_t i = 0; i < log.columns.size(); i++)
+        if (log.columns[i].name == name) return static_cast<int>(i);
+    return -1;
+}
+
+/*
+    Shared helpers
+*/
+
+// Results of scanning one JSON value; running off the end of the buffer means a torn record rather than garbage
+enum ParseStatus {
+ParseOK,
+ParseIncomplete,
+ParseBad,
+};
+
+// Shortest text that reads back as the same double, used when a column mixes numbers and text
+static std::string number_text(double value) {
+    if (std::isnan(value)) return std::string();
+    char buffer[32];
+    std::to_chars_result r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, r.ptr);
+}
+
+// Run work(0..n-1), each on its own thread except the first, which uses the calling thread
+template <typename Work>
+static void run_parallel(size_t n, Work work) {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < n; i++) workers.emplace_back(work, i);
+    if (n > 0) work(0);
+    for (std::vector<std::thread>::iterator i = workers.begin(); i != workers.end(); i++) i->join();
+}
+
+// Columns found by one chunk of the log; every column is padded to the same number of rows
+class ChunkTable {
+private:
+    std::deque<std::string> names; // Stable storage for the views used as index keys
+    std::unordered_map<std::string_view, int> index;
+    std::vector<int> position_hint; // Column found at each field position of the previous row
+public:
+    std::vector<std::vector<double>> values;
+    std::vector<std::vector<std::string>> text; // Empty unless the column holds text
+    std::vector<char> is_text;
+    size_t rows = 0;
+
+    const std::string& name(int column) const { return names[column]; }
+    size_t size(void) const { return names.size(); }
+
+    int lookup(std::string_view name) const {
+        std::unordered_map<std::string_view, int>::const_iterator found = index.find(name);
+        return (found == index.end()) ? -1 : found->second;
+    }
+
+    int add(std::string_view name) {
+        std::unordered_map<std::string_view, int>::iterator found = index.find(name);
+        if (found != index.end()) return found->second;
+        names.emplace_back(name);
+        index.emplace(names.back(), static_cast<int>(names.size()) - 1);
+        values.emplace_back();
+        text.emplace_back();
+        is_text.push_back(0);
+        return static_cast<int>(names.size()) - 1;
+    }
+
+    // Records usually repeat their key order, so check the column seen at this position last time before hashing
+    int find(std::string_view name, size_t position) {
+        if (position < position_hint.size()) {
+            int hint = position_hint[position];
+            if (hint >= 0 && names[hint] == name) return hint;
+        }
+        else position_hint.resize(position + 1, -1);
+        int column = add(name);
+        position_hint[position] = column;
+        return column;
+    }
+
+    void set(int column, double value) {
+        std::vector<double>& col = values[column];
+        if (col.size() > rows) col.back() = value; // Repeated key within one record: last one wins
+        else {
+            if (col.size() < rows) col.resize(rows, NAN);
+            col.push_back(value);
+        }
+        if (is_text[column]) set_cell_text(column, number_text(value));
+    }
+
+    void set_text(int column, std::string value) {
+        if (!is_text[column]) {
+            // First text in this column: earlier numbers become their text form
+            is_text[column] = 1;
+            std::vector<std::string>& strings = text[column];
+            strings.reserve(values[column].size());
+            for (std::vector<double>::iterator i = values[column].begin(); i != values[column].end() && strings.size() < rows; i++)
+                strings.push_back(number_text(*i));
+        }
+        std::vector<double>& col = values[column];
+        if (col.size() > rows) col.back() = NAN;
+        else {
+            if (col.size() < rows) col.resize(rows, NAN);
+            col.push_back(NAN);
+        }
+        set_cell_text(column, std::move(value));
+    }
+
+    void end_row(void) { rows++; }
+
+    // Forget any values set since the last end_row()
+    void abort_row(void) {
+        for (size_t i = 0; i < values.size(); i++) {
+            if (values[i].size() > rows) values[i].pop_back();
+            if (text[i].size() > rows) text[i].pop_back();
+        }
+    }
+
+    void finish(void) {
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i].resize(rows, NAN);
+            if (is_text[i]) text[i].resize(rows);
+        }
+    }
+private:
+    void set_cell_text(int column, std::string value) {
+        std::vector<std::string>& strings = text[column];
+        if (strings.size() > rows) strings.back() = std::move(value);
+        else {
+            if (strings.size() < rows) strings.resize(rows);
+            strings.push_back(std::move(value));
+        }
+    }
+};
+
+// Everything one thread found in its chunk
+typedef struct chunk_result_t {
+    ChunkTable table;
+    std::vector<log_event> events;
+    std::vector<std::string> metadata;
+    int status = ReaderOK;
+    std::string error;
+    const char* stop = nullptr; // Where parsing actually ended
+    bool truncated = false;
+} chunk_result;
+
+// Cut [data, end) into at most n pieces, each starting right after a match of separator
+// The returned boundaries include data and end
+static std::vector<const char*> split_chunks(const char* data, const char* end, size_t n, std::string_view separator, size_t skip) {
+    std::vector<const char*> bounds(1, data);
+    size_t len = end - data;
+    for (size_t k = 1; k < n; k++) {
+        const char* target = data + (len / n) * k;
+        if (target <= bounds.back()) continue;
+        const char* found = static_cast<const char*>(memmem(target, end - target, separator.data(), separator.size()));
+        if (found == nullptr) break;
+        if (found + skip > bounds.back() && found + skip < end) bounds.push_back(found + skip);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+// Combine per-chunk results in chunk order; columns are copied in parallel
+static void merge_chunks(std::vector<chunk_result>& chunks, sensor_log& log, unsigned threads) {
+    std::vector<std::string> order;
+    std::unordered_map<std::string, int> seen;
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    for (size_t c = 0; c < chunks.size(); c++) {
+        ChunkTable& table = chunks[c].table;
+        table.finish();
+        for (size_t i = 0; i < table.size(); i++)
+            if (seen.emplace(table.name(i), 0).second) order.push_back(table.name(i));
+        offsets[c+1] = offsets[c] + table.rows;
+    }
+    // Timestamp leads, whatever order the log used
+    std::vector<std::string>::iterator ts = std::find(order.begin(), order.end(), std::string("timestamp"));
+    if (ts != order.end()) std::rotate(order.begin(), ts, ts + 1);
+
+    log.rows = offsets.back();
+    log.columns.resize(order.size());
+    size_t workers = std::min<size_t>(threads, order.size());
+    run_parallel(workers, [&](size_t worker) {
+        for (size_t g = worker; g < order.size(); g += workers) {
+            log_column& column = log.columns[g];
+            column.name = order[g];
+            std::vector<int> local(chunks.size());
+            for (size_t c = 0; c < chunks.size(); c++) {
+                local[c] = chunks[c].table.lookup(column.name);
+                if (local[c] >= 0 && chunks[c].table.is_text[local[c]]) column.kind = ChannelText;
+            }
+            column.values.assign(log.rows, NAN);
+            if (column.kind == ChannelText) column.text.resize(log.rows);
+            for (size_t c = 0; c < chunks.size(); c++) {
+                if (local[c] < 0) continue;
+                ChunkTable& table = chunks[c].table;
+                std::vector<double>& values = table.values[local[c]];
+                std::copy(values.begin(), values.end(), column.values.begin() + offsets[c]);
+                if (column.kind != ChannelText) continue;
+                if (table.is_text[local[c]])
+                    std::move(table.text[local[c]].begin(), table.text[local[c]].end(), column.text.begin() + offsets[c]);
+                else
+                    for (size_t r = 0; r < values.size(); r++) column.text[offsets[c] + r] = number_text(values[r]);
+            }
+            // Text columns hold no numbers
+            if (column.kind == ChannelText) std::fill(column.values.begin(), column.values.end(), NAN);
+        }
+    });
+    for (size_t c = 0; c < chunks.size(); c++) {
+        std::move(chunks[c].events.begin(), chunks[c].events.end(), std::back_inserter(log.events));
+        std::move(chunks[c].metadata.begin(), chunks[c].metadata.end(), std::back_inserter(log.metadata));
+    }
+}
+
+/*
+    JSON and NDJSON
+*/
+
+// Value types found while scanning a record
+enum JsonValueTypes {
+JsonNumber,
+JsonString,
+JsonNull,
+JsonBool,
+JsonNested, // Object or array, kept as raw text
+};
+
+typedef struct json_field_t {
+    const char *key, *key_end; // Between the quotes
+    bool key_escaped;
+    int type; // JsonValueTypes
+    double number;
+    const char *raw, *raw_end; // Whole value token, including any quotes
+    bool escaped;
+} json_field;
+
+static inline void skip_json_space(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+}
+
+// p is at the opening quote; on success it is left just past the closing quote
+static int scan_json_string(const char*& p, const char* end, bool& escaped) {
+    p++;
+    escaped = false;
+    while (1) {
+        while (p < end && *p != '"' && *p != '\\') p++;
+        if (p >= end) return ParseIncomplete;
+        if (*p == '"') {
+            p++;
+            return ParseOK;
+        }
+        if (end - p < 2) return ParseIncomplete;
+        escaped = true;
+        p += 2;
+    }
+}
+
+static int skip_json_nested(const char*& p, const char* end) {
+    int depth = 0;
+    bool escaped;
+    while (p < end) {
+        switch (*p) {
+            case '"':
+                if (int r = scan_json_string(p, end, escaped)) return r;
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    p++;
+                    return ParseOK;
+                }
+                break;
+        }
+        p++;
+    }
+    return ParseIncomplete;
+}
+
+static int scan_json_value(const char*& p, const char* end, json_field& field) {
+    field.raw = p;
+    field.escaped = false;
+    field.number = NAN;
+    int r = ParseOK;
+    switch (*p) {
+        case '"':
+            field.type = JsonString;
+            r = scan_json_string(p, end, field.escaped);
+            break;
+        case '{':
+        case '[':
+            field.type = JsonNested;
+            r = skip_json_nested(p, end);
+            break;
+        case 't':
+        case 'f':
+        case 'n': {
+            const char* word = (*p == 't') ? "true" : ((*p == 'f') ? "false" : "null");
+            size_t len = strlen(word);
+            if (static_cast<size_t>(end - p) >= len && memcmp(p, word, len) == 0) {
+                field.type = (*p == 'n') ? JsonNull : JsonBool;
+                if (*p != 'n') field.number = (*p == 't') ? 1 : 0;
+                p += len;
+                break;
+            }
+            // Not a JSON literal; "nan" is accepted as a number below
+        }
+        [[fallthrough]];
+        default: {
+            const char* token = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+            if (p >= end) return ParseIncomplete; // The number may have been cut short
+            field.type = JsonNumber;
+            std::from_chars_result parsed = std::from_chars(token, p, field.number);
+            if (token == p || parsed.ptr != p) return ParseBad;
+        }
+    }
+    field.raw_end = p;
+    return r;
+}
+
+// p is at the opening brace; fields receive every top-level key of the object
+static int scan_json_object(const char*& p, const char* end, std::vector<json_field>& fields) {
+    fields.clear();
+    p++;
+    skip_json_space(p, end);
+    if (p >= end) return ParseIncomplete;
+    if (*p == '}') {
+        p++;
+        return ParseOK;
+    }
+    while (1) {
+        json_field field;
+        skip_json_space(p, end);
+        if (p >= end) return ParseIncomplete;
+        if (*p != '"') return ParseBad;
+        field.key = p + 1;
+        if (int r = scan_json_string(p, end, field.key_escaped)) return r;
+        field.key_end = p - 1;
+        skip_json_space(p, end);
+        if (p >= end) return ParseIncomplete;
+        if (*p++ != ':') return ParseBad;
+        skip_json_space(p, end);
+        if (p >= end) return ParseIncomplete;
+        if (int r = scan_json_value(p, end, field)) return r;
+        fields.push_back(field);
+        skip_json_space(p, end);
+        if (p >= end) return ParseIncomplete;
+        if (*p == '}') {
+            p++;
+            return ParseOK;
+        }
+        if (*p++ != ',') return ParseBad;
+    }
+}
+
+static void append_utf8(std::string& out, uint32_t code) {
+    if (code < 0x80) out += static_cast<char>(code);
+    else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Contents of a JSON string (between the quotes) with escapes resolved
+static std::string json_unescape(const char* p, const char* end, bool escaped) {
+    if (!escaped) return std::string(p, end);
+    std::string out;
+    out.reserve(end - p);
+    while (p < end) {
+        if (*p != '\\') {
+            out += *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (end - p < 5 || std::from_chars(p + 1, p + 5, code, 16).ptr != p + 5) {
+                    out += 'u';
+                    break;
+                }
+                p += 4;
+                // Surrogate pairs arrive as two escapes
+                uint32_t low = 0;
+                if (code >= 0xD800 && code < 0xDC00 && end - p >= 7 && p[1] == '\\' && p[2] == 'u' &&
+                    std::from_chars(p + 3, p + 7, low, 16).ptr == p + 7 && low >= 0xDC00 && low < 0xE000) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default: out += *p; // \" \\ \/
+        }
+        p++;
+    }
+    return out;
+}
+
+static int64_t json_integer(const json_field& field) {
+    // Nanosecond clocks exceed double precision, so read integers directly when possible
+    int64_t value = 0;
+    if (field.type == JsonNumber && std::from_chars(field.raw, field.raw_end, value).ptr == field.raw_end) return value;
+    return std::isnan(field.number) ? -1 : static_cast<int64_t>(field.number);
+}
+
+// Sort one record into samples (poll-data), events (any other "event") or metadata (everything else)
+static void store_json_record(const char* record, const char* record_end, std::vector<json_field>& fields, chunk_result& result) {
+    const json_field* event = nullptr;
+    for (std::vector<json_field>::iterator i = fields.begin(); i != fields.end(); i++)
+        if (i->type == JsonString && std::string_view(i->key, i->key_end - i->key) == "event") event = &*i;
+    if (event == nullptr) {
+        result.metadata.emplace_back(record, record_end);
+        return;
+    }
+    std::string name = json_unescape(event->raw + 1, event->raw_end - 1, event->escaped);
+    if (name == "poll-data") {
+        ChunkTable& table = result.table;
+        size_t position = 0;
+        for (std::vector<json_field>::iterator i = fields.begin(); i != fields.end(); i++) {
+            if (&*i == event) continue;
+            std::string unescaped;
+            std::string_view key(i->key, i->key_end - i->key);
+            if (i->key_escaped) key = unescaped = json_unescape(i->key, i->key_end, true);
+            int column = table.find(key, position++);
+            switch (i->type) {
+                case JsonNumber:
+                case JsonBool:
+                case JsonNull:
+                    table.set(column, i->number);
+                    break;
+                case JsonString:
+                    table.set_text(column, json_unescape(i->raw + 1, i->raw_end - 1, i->escaped));
+                    break;
+                case JsonNested:
+                    table.set_text(column, std::string(i->raw, i->raw_end));
+                    break;
+            }
+        }
+        table.end_row();
+        return;
+    }
+    log_event entry;
+    entry.name = std::move(name);
+    entry.payload = "{";
+    for (std::vector<json_field>::iterator i = fields.begin(); i != fields.end(); i++) {
+        if (&*i == event) continue;
+        std::string_view key(i->key, i->key_end - i->key);
+        if (key == "timestamp") entry.timestamp = i->number;
+        else if (key == "index") entry.index = json_integer(*i);
+        else if (key == "sample") entry.sample = json_integer(*i);
+        else if (key == "monotonic-ns") entry.monotonic_ns = json_integer(*i);
+        else if (key == "wallclock-ns") entry.wallclock_ns = json_integer(*i);
+        else {
+            if (entry.payload.size() > 1) entry.payload += ", ";
+            entry.payload.append(i->key - 1, i->key_end + 1);
+            entry.payload += ": ";
+            entry.payload.append(i->raw, i->raw_end);
+        }
+    }
+    entry.payload += "}";
+    result.events.push_back(std::move(entry));
+}
+
+// Parse every record starting in [begin, stop); the last record may run past stop, but never past end
+static void parse_json_chunk(const char* base, const char* begin, const char* stop, const char* end, chunk_result& result) {
+    std::vector<json_field> fields;
+    const char* p = begin;
+    while (1) {
+        // Array brackets and separators between records are optional, which also covers NDJSON
+        while (p < stop && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ',' || *p == '[' || *p == ']')) p++;
+        if (p >= stop) break;
+        if (*p != '{') {
+            result.status = ReaderMalformed;
+            result.error = "Expected a JSON object at byte " + std::to_string(p - base);
+            return;
+        }
+        const char* record = p;
+        int r = scan_json_object(p, end, fields);
+        if (r == ParseIncomplete) {
+            // Torn final record from a writer that was killed
+            result.truncated = true;
+            p = end;
+            break;
+        }
+        if (r == ParseBad) {
+            result.status = ReaderMalformed;
+            result.error = "Malformed JSON record at byte " + std::to_string(record - base);
+            return;
+        }
+        store_json_record(record, p, fields, result);
+    }
+    result.stop = p;
+}
+
+static int read_json(const char* data, const char* end, size_t chunks, unsigned threads, sensor_log& log, std::string& error) {
+    // Records written by this tool always start on a new line, so chunks start at a line opening with '{'
+    // A guess that lands inside a nested object is caught below, because the previous chunk's last record then runs past it
+    std::vector<const char*> bounds = split_chunks(data, end, chunks, "\n{", 1);
+    std::vector<chunk_result> results(bounds.size() - 1);
+    run_parallel(results.size(), [&](size_t c) {
+        parse_json_chunk(data, bounds[c], bounds[c+1], end, results[c]);
+    });
+    bool consistent = true;
+    for (size_t c = 0; c < results.size() && consistent; c++)
+        consistent = (results[c].status == ReaderOK) && (c + 1 == results.size() || results[c].stop == bounds[c+1]);
+    if (!consistent && results.size() > 1) {
+        results.clear();
+        results.resize(1);
+        parse_json_chunk(data, data, end, end, results[0]);
+    }
+    for (size_t c = 0; c < results.size(); c++) {
+        if (results[c].status != ReaderOK) {
+            error = results[c].error;
+            return results[c].status;
+        }
+    }
+    log.truncated |= results.back().truncated;
+    merge_chunks(results, log, threads);
+    return ReaderOK;
+}
+
+/*
+    CSV
+*/
+
+// Split one line into fields; quoted fields may contain commas and doubled quotes, but not newlines
+static void split_csv_line(const char* p, const char* end, std::vector<std::string_view>& fields, std::vector<char>& quoted, std::deque<std::string>& unquoted) {
+    fields.clear();
+    quoted.clear();
+    unquoted.clear();
+    while (1) {
+        if (p < end && *p == '"') {
+            std::string value;
+            const char* q = p + 1;
+            while (q < end) {
+                if (*q == '"') {
+                    if (q + 1 < end && q[1] == '"') {
+                        value += '"';
+                        q += 2;
+                        continue;
+                    }
+                    q++;
+                    break;
+                }
+                value += *q++;
+            }
+            unquoted.push_back(std::move(value));
+            fields.push_back(unquoted.back());
+            quoted.push_back(1);
+            p = static_cast<const char*>(memchr(q, ',', end - q));
+        }
+        else {
+            const char* comma = static_cast<const char*>(memchr(p, ',', end - p));
+            fields.emplace_back(p, ((comma == nullptr) ? end : comma) - p);
+            quoted.push_back(0);
+            p = comma;
+        }
+        if (p == nullptr) return;
+        p++;
+    }
+}
+
+static void parse_csv_chunk(const char* begin, const char* stop, std::string_view header, size_t columns, chunk_result& result) {
+    ChunkTable& table = result.table;
+    std::vector<std::string> names;
+    std::vector<std::string_view> fields;
+    std::vector<char> quoted;
+    std::deque<std::string> unquoted;
+    split_csv_line(header.data(), header.data() + header.size(), fields, quoted, unquoted);
+    for (size_t i = 0; i < columns; i++) table.add(fields[i]);
+
+    const char* p = begin;
+    while (p < stop) {
+        const char* newline = static_cast<const char*>(memchr(p, '\n', stop - p));
+        const char* line_end = (newline == nullptr) ? stop : newline;
+        const char* content_end = line_end;
+        if (content_end > p && content_end[-1] == '\r') content_end--;
+        const char* line = p;
+        p = (newline == nullptr) ? stop : newline + 1;
+        // Skip blank lines and headers repeated by appended runs
+        if (content_end == line) continue;
+        if (static_cast<size_t>(content_end - line) == header.size() && memcmp(line, header.data(), header.size()) == 0) continue;
+        split_csv_line(line, content_end, fields, quoted, unquoted);
+        if (newline == nullptr && fields.size() < columns) {
+            // Torn final line from a writer that was killed
+            result.truncated = true;
+            break;
+        }
+        size_t n = std::min(fields.size(), columns);
+        for (size_t i = 0; i < n; i++) {
+            std::string_view field = fields[i];
+            if (field.empty()) continue; // Missing value
+            double value;
+            std::from_chars_result parsed = std::from_chars(field.data(), field.data() + field.size(), value);
+            if (!quoted[i] && parsed.ptr == field.data() + field.size() && parsed.ec == std::errc()) table.set(i, value);
+            else table.set_text(i, std::string(field));
+        }
+        table.end_row();
+    }
+    result.stop = p;
+}
+
+static int read_csv(const char* data, const char* end, size_t chunks, unsigned threads, sensor_log& log, std::string& error) {
+    const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+    const char* body = (newline == nullptr) ? end : newline + 1;
+    const char* header_end = (newline == nullptr) ? end : newline;
+    if (header_end > data && header_end[-1] == '\r') header_end--;
+    std::string_view header(data, header_end - data);
+    std::vector<std::string_view> fields;
+    std::vector<char> quoted;
+    std::deque<std::string> unquoted;
+    split_csv_line(header.data(), header.data() + header.size(), fields, quoted, unquoted);
+    size_t columns = fields.size();
+
+    std::vector<const char*> bounds = split_chunks(body, end, chunks, "\n", 1);
+    std::vector<chunk_result> results(bounds.size() - 1);
+    run_parallel(results.size(), [&](size_t c) {
+        parse_csv_chunk(bounds[c], bounds[c+1], header, columns, results[c]);
+    });
+    if (results.empty()) {
+        // Header only
+        results.resize(1);
+        parse_csv_chunk(end, end, header, columns, results[0]);
+    }
+    log.truncated |= results.back().truncated;
+    merge_chunks(results, log, threads);
+    return ReaderOK;
+}
+
+/*
+    Containers: framing and gzip
+*/
+
+// Concatenate the payloads of every valid data frame; frames are located serially but their CRCs are checked in parallel
+static int unframe_log(const char* data, size_t len, unsigned threads, std::string& payload, bool& truncated) {
+    std::vector<std::pair<size_t, record_frame_header>> frames;
+    size_t offset = 0;
+    while (len - offset >= sizeof(record_frame_header)) {
+        record_frame_header header;
+        memcpy(&header, data + offset, sizeof(header));
+        if (header.magic != RecordFrameMagic || header.kind >= count_RecordFrameKinds ||
+            header.length > RecordFrameMaxPayload || len - offset - sizeof(header) < header.length) break;
+        frames.emplace_back(offset, header);
+        offset += sizeof(header) + header.length;
+    }
+    if (offset != len) truncated = true;
+
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threads, frames.size() / 1024));
+    std::vector<size_t> first_bad(workers, frames.size());
+    run_parallel(workers, [&](size_t worker) {
+        size_t from = frames.size() * worker / workers, to = frames.size() * (worker + 1) / workers;
+        record_frame_header header;
+        for (size_t f = from; f < to; f++) {
+            if (scan_record_frame(data + frames[f].first, len - frames[f].first, &header) != ScanComplete) {
+                first_bad[worker] = f;
+                return;
+            }
+        }
+    });
+    size_t valid = *std::min_element(first_bad.begin(), first_bad.end());
+    if (valid != frames.size()) truncated = true;
+
+    size_t total = 0;
+    for (size_t f = 0; f < valid; f++)
+        if (frames[f].second.kind == FrameData) total += frames[f].second.length;
+    payload.clear();
+    payload.reserve(total);
+    for (size_t f = 0; f < valid; f++)
+        if (frames[f].second.kind == FrameData)
+            payload.append(data + frames[f].first + sizeof(record_frame_header), frames[f].second.length);
+    return ReaderOK;
+}
+
+#ifdef SINK_GZIP_ENABLED
+// Decompress every gzip member; a stream cut short (killed writer) keeps everything up to its last sync flush
+static int inflate_log(const char* data, size_t len, std::string& out, bool& truncated, std::string& error) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        error = "Unable to initialize zlib";
+        return ReaderMalformed;
+    }
+    // zlib counts in 32 bits, so input is fed in pieces
+    const char* next = data;
+    size_t remaining = len, produced = 0;
+    std::function<void(void)> feed = [&](void) {
+        uInt piece = static_cast<uInt>(std::min<size_t>(remaining, 1u << 30));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(next));
+        stream.avail_in = piece;
+        next += piece;
+        remaining -= piece;
+    };
+    feed();
+    out.resize(std::max<size_t>(len * 4, 1 << 16));
+    while (1) {
+        if (out.size() - produced < (1 << 16)) out.resize(out.size() * 2);
+        uInt space = static_cast<uInt>(std::min<size_t>(out.size() - produced, 1u << 30)), available = stream.avail_in;
+        stream.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        stream.avail_out = space;
+        int status = inflate(&stream, Z_NO_FLUSH);
+        produced += space - stream.avail_out;
+        bool progress = (stream.avail_out != space) || (stream.avail_in != available);
+        if (stream.avail_in == 0 && remaining > 0) feed();
+        if (status == Z_STREAM_END) {
+            if (stream.avail_in == 0) break;
+            inflateReset(&stream); // Another member follows; the input position is kept
+            continue;
+        }
+        if (status == Z_OK && progress) continue;
+        // Out of input mid-stream, or corrupt data: keep what was recovered before it, as for torn framed logs
+        truncated = true;
+        break;
+    }
+    out.resize(produced);
+    inflateEnd(&stream);
+    return ReaderOK;
+}
+#endif
+
+/*
+    Entry points
+*/
+
+int parse_sensor_log(const char* data, size_t len, const reader_options& options, sensor_log& log, std::string& error) {
+    log = sensor_log();
+    std::string inflated, unframed;
+    if (len >= 2 && static_cast<unsigned char>(data[0]) == 0x1F && static_cast<unsigned char>(data[1]) == 0x8B) {
+#ifdef SINK_GZIP_ENABLED
+        if (int r = inflate_log(data, len, inflated, log.truncated, error)) return r;
+        data = inflated.data();
+        len = inflated.size();
+        log.compressed = true;
+#else
+        error = "gzip-compressed logs need zlib at build time";
+        return ReaderUnsupported;
+#endif
+    }
+    unsigned threads = options.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t magic = 0;
+    if (len >= sizeof(magic)) memcpy(&magic, data, sizeof(magic));
+    if (magic == RecordFrameMagic) {
+        if (int r = unframe_log(data, len, threads, unframed, log.truncated)) return r;
+        data = unframed.data();
+        len = unframed.size();
+        log.framed = true;
+    }
+    // The decompressed copy is no longer needed once its frames have been unwrapped
+    if (log.framed) std::string().swap(inflated);
+
+    const char* end = data + len;
+    const char* first = data;
+    skip_json_space(first, end);
+    if (first == end) {
+        error = "Log is empty";
+        return ReaderMalformed;
+    }
+    int format = options.format;
+    if (format == ReaderAuto) {
+        if (*first == '[') format = ReaderJSON;
+        else if (*first == '{') format = ReaderNDJSON;
+        else if (static_cast<size_t>(end - first) >= 14 && memcmp(first, "Poll update at", 14) == 0) {
+            error = "Human-readable logs are not supported; record with -f 0 (CSV) or -f 2 (JSON)";
+            return ReaderUnsupported;
+        }
+        else format = ReaderCSV;
+    }
+    size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, len / chunk_size));
+    int r = (format == ReaderCSV) ? read_csv(data, end, chunks, threads, log, error) :
+                                    read_json(data, end, chunks, threads, log, error);
+    if (r != ReaderOK) {
+        log = sensor_log();
+        return r;
+    }
+    log.format = format;
+    return ReaderOK;
+}
+
+int read_sensor_log(const std::string& path, const reader_options& options, sensor_log& log, std::string& error) {
+    log = sensor_log();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Unable to open " + path + ": " + strerror(errno);
+        return ReaderOpenFailed;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error = "Unable to stat " + path + ": " + strerror(errno);
+        close(fd);
+        return ReaderOpenFailed;
+    }
+    size_t len = info.st_size;
+    if (len == 0) {
+        close(fd);
+        error = path + " is empty";
+        return ReaderMalformed;
+    }
+    void* mapped = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "Unable to map " + path + ": " + strerror(errno);
+        return ReaderOpenFailed;
+    }
+    // Chunks are read front to back by each thread
+    madvise(mapped, len, MADV_SEQUENTIAL);
+    int r = parse_sensor_log(static_cast<const char*>(mapped), len, options, log, error);
+    munmap(mapped, len);
+    if (r != ReaderOK) error = path + ": " + error;
+    return r;
+}
@@ -0,0 +1,62 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_LogReader
+#define LibSensorTools_LogReader
+
+#include "../enums.h" // ReaderFormats, ReaderResults, SampleChannelKinds
+
+#include <cstdint> // int64_t
+#include <cstddef> // size_t
+#include <string> // String class and manipulation
+#include <vector> // Column storage
+
+#define ReaderMinChunk (1u << 20) // Bytes below which splitting work across threads costs more than it saves
+
+// One channel of a log, stored contiguously so it can be handed out without copies
+typedef struct log_column_t {
+    std::string name;
+    int kind = ChannelNumeric; // SampleChannelKinds
+    std::vector<double> values; // One entry per row; NaN where missing or for ChannelText columns
+    std::vector<std::string> text; // One entry per row, only for ChannelText columns
+} log_column;
+
+// One entry of the event timeline (io/events.h); any extra fields are kept as a JSON object
+typedef struct log_event_t {
+    std::string name;
+    double timestamp = 0;
+    int64_t index = -1, sample = -1, monotonic_ns = -1, wallclock_ns = -1;
+    std::string payload; // JSON object text, "{}" when the event carried no payload
+} log_event;
+
+// Everything recovered from one log
+typedef struct sensor_log_t {
+    int format = ReaderAuto; // ReaderFormats actually parsed
+    bool framed = false; // Records were wrapped with -F | --frame
+    bool compressed = false; // The file was gzip-compressed
+    bool truncated = false; // The log ends in a torn record (killed writer), which was dropped
+    size_t rows = 0;
+    std::vector<log_column> columns; // "timestamp" first when the log has one
+    std::vector<log_event> events;
+    std::vector<std::string> metadata; // Raw JSON of records that are neither samples nor events (arguments, versions)
+} sensor_log;
+
+typedef struct reader_options_t {
+    int format = ReaderAuto; // ReaderFormats
+    unsigned threads = 0; // 0 uses every hardware thread
+    size_t chunk_size = ReaderMinChunk; // Smallest piece of the log given to one thread
+} reader_options;
+
+// Load a CSV or JSON/NDJSON log, optionally framed and/or gzip-compressed
+// Large logs are split into chunks at record boundaries and parsed in parallel
+// On failure, log is left empty and error describes the problem
+int read_sensor_log(const std::string& path, const reader_options& options, sensor_log& log, std::string& error);
+// As above for a log that is already in memory
+int parse_sensor_log(const char* data, size_t len, const reader_options& options, sensor_log& log, std::string& error);
+// Index of the named column, or -1
+int find_log_column(const sensor_log& log, const std::string& name);
+const char* reader_format_name(int format);
+#endif
+
@@ -0,0 +1,424 @@
+/*
+    sensorlog: Python extension around the log reader
+
+        import sensorlog, numpy
+        log = sensorlog.read("run.json") # or sensorlog.parse(bytes_like)
+        temps = numpy.asarray(log["coretemp_isa_0000_Package_id_0_temperature"])
+
+    Numeric columns support the buffer protocol, so numpy wraps the reader's own storage without copying.
+    Every view keeps the log alive; the storage is never modified after reading, so views are read-only.
+    Text columns are returned as lists of str.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#define PY_SSIZE_T_CLEAN
+#include <Python.h> // CPython API and buffer protocol; 3.10+ for buffer slots in type specs and PyModule_AddObjectRef()
+#include "log_reader.h" // The reader itself
+
+#include <string> // String class and manipulation
+// End Headers
+
+// Class and Type declarations
+typedef struct log_object_t {
+    PyObject_HEAD
+    sensor_log* log;
+} log_object;
+
+typedef struct column_object_t {
+    PyObject_HEAD
+    log_object* owner; // Strong reference keeping the storage alive
+    Py_ssize_t column;
+    Py_ssize_t shape, stride; // Referenced by exported buffers
+} column_object;
+// End Class and Type declarations
+
+static PyObject* LogType = nullptr;
+static PyObject* ColumnType = nullptr;
+
+/*
+    Column: one numeric channel exposed as a 1-D array of doubles
+*/
+static const log_column& column_of(column_object* self) {
+    return self->owner->log->columns[self->column];
+}
+
+static int column_getbuffer(PyObject* obj, Py_buffer* view, int flags) {
+    column_object* self = reinterpret_cast<column_object*>(obj);
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "sensorlog columns are read-only");
+        return -1;
+    }
+    const log_column& column = column_of(self);
+    view->buf = const_cast<double*>(column.values.data());
+    view->obj = obj;
+    Py_INCREF(obj);
+    view->len = self->shape * sizeof(double);
+    view->readonly = 1;
+    view->itemsize = sizeof(double);
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : nullptr;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->shape : nullptr;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &self->stride : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+static void column_releasebuffer(PyObject* obj, Py_buffer* view) {}
+
+static Py_ssize_t column_length(PyObject* obj) {
+    return reinterpret_cast<column_object*>(obj)->shape;
+}
+
+static PyObject* column_item(PyObject* obj, Py_ssize_t i) {
+    column_object* self = reinterpret_cast<column_object*>(obj);
+    if (i < 0 || i >= self->shape) {
+        PyErr_SetString(PyExc_IndexError, "column index out of range");
+        return nullptr;
+    }
+    return PyFloat_FromDouble(column_of(self).values[i]);
+}
+
+static PyObject* column_name(PyObject* obj, void* closure) {
+    return PyUnicode_FromString(column_of(reinterpret_cast<column_object*>(obj)).name.c_str());
+}
+
+static PyObject* column_repr(PyObject* obj) {
+    column_object* self = reinterpret_cast<column_object*>(obj);
+    return PyUnicode_FromFormat("<sensorlog.Column '%s' (%zd values)>", column_of(self).name.c_str(), self->shape);
+}
+
+static void column_dealloc(PyObject* obj) {
+    column_object* self = reinterpret_cast<column_object*>(obj);
+    PyTypeObject* type = Py_TYPE(obj);
+    Py_XDECREF(self->owner);
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+static PyGetSetDef column_getset[] = {
+    {"name", column_name, nullptr, "Channel name", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+static PyType_Slot column_slots[] = {
+    {Py_bf_getbuffer, reinterpret_cast<void*>(column_getbuffer)},
+    {Py_bf_releasebuffer, reinterpret_cast<void*>(column_releasebuffer)},
+    {Py_sq_length, reinterpret_cast<void*>(column_length)},
+    {Py_sq_item, reinterpret_cast<void*>(column_item)},
+    {Py_tp_getset, column_getset},
+    {Py_tp_repr, reinterpret_cast<void*>(column_repr)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(column_dealloc)},
+    {Py_tp_doc, const_cast<char*>("One numeric channel of a log; supports the buffer protocol (float64, read-only)")},
+    {0, nullptr},
+};
+
+static PyType_Spec column_spec = {
+    "sensorlog.Column", sizeof(column_object), 0, Py_TPFLAGS_DEFAULT, column_slots,
+};
+
+/*
+    Log: everything read from one file, indexed by channel name
+*/
+static int column_index(log_object* self, PyObject* key) {
+    if (!PyUnicode_Check(key)) {
+        PyErr_SetString(PyExc_TypeError, "column names are str");
+        return -2;
+    }
+    const char* name = PyUnicode_AsUTF8(key);
+    if (name == nullptr) return -2;
+    return find_log_column(*self->log, name);
+}
+
+static PyObject* log_subscript(PyObject* obj, PyObject* key) {
+    log_object* self = reinterpret_cast<log_object*>(obj);
+    int index = column_index(self, key);
+    if (index == -2) return nullptr;
+    if (index < 0) {
+        PyErr_SetObject(PyExc_KeyError, key);
+        return nullptr;
+    }
+    const log_column& column = self->log->columns[index];
+    if (column.kind == ChannelText) {
+        PyObject* list = PyList_New(column.text.size());
+        if (list == nullptr) return nullptr;
+        for (size_t i = 0; i < column.text.size(); i++) {
+            PyObject* text = PyUnicode_DecodeUTF8(column.text[i].data(), column.text[i].size(), "replace");
+            if (text == nullptr) {
+                Py_DECREF(list);
+                return nullptr;
+            }
+            PyList_SET_ITEM(list, i, text);
+        }
+        return list;
+    }
+    column_object* view = PyObject_New(column_object, reinterpret_cast<PyTypeObject*>(ColumnType));
+    if (view == nullptr) return nullptr;
+    Py_INCREF(self);
+    view->owner = self;
+    view->column = index;
+    view->shape = static_cast<Py_ssize_t>(column.values.size());
+    view->stride = sizeof(double);
+    return reinterpret_cast<PyObject*>(view);
+}
+
+static Py_ssize_t log_length(PyObject* obj) {
+    return static_cast<Py_ssize_t>(reinterpret_cast<log_object*>(obj)->log->columns.size());
+}
+
+static int log_contains(PyObject* obj, PyObject* key) {
+    int index = column_index(reinterpret_cast<log_object*>(obj), key);
+    return (index == -2) ? -1 : (index >= 0);
+}
+
+static PyObject* log_keys(PyObject* obj, PyObject* unused) {
+    const sensor_log& log = *reinterpret_cast<log_object*>(obj)->log;
+    PyObject* list = PyList_New(log.columns.size());
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < log.columns.size(); i++) {
+        PyObject* name = PyUnicode_FromString(log.columns[i].name.c_str());
+        if (name == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, name);
+    }
+    return list;
+}
+
+static PyObject* log_iter(PyObject* obj) {
+    PyObject* keys = log_keys(obj, nullptr);
+    if (keys == nullptr) return nullptr;
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+static PyObject* log_text_columns(PyObject* obj, void* closure) {
+    const sensor_log& log = *reinterpret_cast<log_object*>(obj)->log;
+    PyObject* list = PyList_New(0);
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < log.columns.size(); i++) {
+        if (log.columns[i].kind != ChannelText) continue;
+        PyObject* name = PyUnicode_FromString(log.columns[i].name.c_str());
+        if (name == nullptr || PyList_Append(list, name) != 0) {
+            Py_XDECREF(name);
+            Py_DECREF(list);
+            return nullptr;
+        }
+        Py_DECREF(name);
+    }
+    return list;
+}
+
+static PyObject* log_events(PyObject* obj, void* closure) {
+    const sensor_log& log = *reinterpret_cast<log_object*>(obj)->log;
+    PyObject* list = PyList_New(log.events.size());
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < log.events.size(); i++) {
+        const log_event& event = log.events[i];
+        PyObject* entry = Py_BuildValue("{s:s#,s:d,s:L,s:L,s:L,s:L,s:s#}",
+                                        "event", event.name.data(), static_cast<Py_ssize_t>(event.name.size()),
+                                        "timestamp", event.timestamp,
+                                        "index", static_cast<long long>(event.index),
+                                        "sample", static_cast<long long>(event.sample),
+                                        "monotonic-ns", static_cast<long long>(event.monotonic_ns),
+                                        "wallclock-ns", static_cast<long long>(event.wallclock_ns),
+                                        "payload", event.payload.data(), static_cast<Py_ssize_t>(event.payload.size()));
+        if (entry == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, entry);
+    }
+    return list;
+}
+
+static PyObject* log_metadata(PyObject* obj, void* closure) {
+    const sensor_log& log = *reinterpret_cast<log_object*>(obj)->log;
+    PyObject* list = PyList_New(log.metadata.size());
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < log.metadata.size(); i++) {
+        PyObject* text = PyUnicode_DecodeUTF8(log.metadata[i].data(), log.metadata[i].size(), "replace");
+        if (text == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, text);
+    }
+    return list;
+}
+
+static PyObject* log_format(PyObject* obj, void* closure) {
+    return PyUnicode_FromString(reader_format_name(reinterpret_cast<log_object*>(obj)->log->format));
+}
+static PyObject* log_rows(PyObject* obj, void* closure) {
+    return PyLong_FromSize_t(reinterpret_cast<log_object*>(obj)->log->rows);
+}
+static PyObject* log_framed(PyObject* obj, void* closure) {
+    return PyBool_FromLong(reinterpret_cast<log_object*>(obj)->log->framed);
+}
+static PyObject* log_compressed(PyObject* obj, void* closure) {
+    return PyBool_FromLong(reinterpret_cast<log_object*>(obj)->log->compressed);
+}
+static PyObject* log_truncated(PyObject* obj, void* closure) {
+    return PyBool_FromLong(reinterpret_cast<log_object*>(obj)->log->truncated);
+}
+
+static PyObject* log_repr(PyObject* obj) {
+    const sensor_log& log = *reinterpret_cast<log_object*>(obj)->log;
+    return PyUnicode_FromFormat("<sensorlog.Log %s, %zu columns x %zu rows, %zu events%s>",
+                                reader_format_name(log.format), log.columns.size(), log.rows, log.events.size(),
+                                log.truncated ? ", truncated" : "");
+}
+
+static void log_dealloc(PyObject* obj) {
+    log_object* self = reinterpret_cast<log_object*>(obj);
+    PyTypeObject* type = Py_TYPE(obj);
+    delete self->log;
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+static PyMethodDef log_methods[] = {
+    {"keys", log_keys, METH_NOARGS, "Column names, timestamp first"},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static PyGetSetDef log_getset[] = {
+    {"format", log_format, nullptr, "Encoding that was parsed: 'csv', 'json' or 'ndjson'", nullptr},
+    {"rows", log_rows, nullptr, "Number of samples", nullptr},
+    {"framed", log_framed, nullptr, "Records were wrapped with -F | --frame", nullptr},
+    {"compressed", log_compressed, nullptr, "The file was gzip-compressed", nullptr},
+    {"truncated", log_truncated, nullptr, "A torn final record was dropped", nullptr},
+    {"text_columns", log_text_columns, nullptr, "Names of columns holding text rather than numbers", nullptr},
+    {"events", log_events, nullptr, "Event timeline as dicts; 'payload' holds any extra fields as JSON text", nullptr},
+    {"metadata", log_metadata, nullptr, "Raw JSON of non-sample, non-event records (arguments, versions)", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+static PyType_Slot log_slots[] = {
+    {Py_mp_subscript, reinterpret_cast<void*>(log_subscript)},
+    {Py_mp_length, reinterpret_cast<void*>(log_length)},
+    {Py_sq_contains, reinterpret_cast<void*>(log_contains)},
+    {Py_tp_iter, reinterpret_cast<void*>(log_iter)},
+    {Py_tp_methods, log_methods},
+    {Py_tp_getset, log_getset},
+    {Py_tp_repr, reinterpret_cast<void*>(log_repr)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(log_dealloc)},
+    {Py_tp_doc, const_cast<char*>("Columns, events and metadata read from one log; index by column name")},
+    {0, nullptr},
+};
+
+static PyType_Spec log_spec = {
+    "sensorlog.Log", sizeof(log_object), 0, Py_TPFLAGS_DEFAULT, log_slots,
+};
+
+/*
+    Module functions
+*/
+static bool parse_options(const char* format, long threads, Py_ssize_t chunk_size, reader_options& options) {
+    options.format = -1;
+    for (int i = 0; i < count_ReaderFormats; i++)
+        if (std::string(format) == reader_format_name(i)) options.format = i;
+    if (options.format < 0) {
+        PyErr_Format(PyExc_ValueError, "Unknown format '%s' (auto, csv, json or ndjson)", format);
+        return false;
+    }
+    if (threads < 0 || chunk_size < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads and chunk_size must not be negative");
+        return false;
+    }
+    options.threads = static_cast<unsigned>(threads);
+    if (chunk_size > 0) options.chunk_size = static_cast<size_t>(chunk_size);
+    return true;
+}
+
+static PyObject* wrap_result(int result, sensor_log* log, const std::string& error) {
+    if (result != ReaderOK) {
+        delete log;
+        PyErr_SetString((result == ReaderOpenFailed) ? PyExc_OSError : PyExc_ValueError, error.c_str());
+        return nullptr;
+    }
+    log_object* self = PyObject_New(log_object, reinterpret_cast<PyTypeObject*>(LogType));
+    if (self == nullptr) {
+        delete log;
+        return nullptr;
+    }
+    self->log = log;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static PyObject* sensorlog_read(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"path", "format", "threads", "chunk_size", nullptr};
+    PyObject* path_object = nullptr;
+    const char* format = "auto";
+    long threads = 0;
+    Py_ssize_t chunk_size = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|$sln", const_cast<char**>(keywords),
+                                     PyUnicode_FSConverter, &path_object, &format, &threads, &chunk_size)) return nullptr;
+    std::string path(PyBytes_AS_STRING(path_object), PyBytes_GET_SIZE(path_object));
+    Py_DECREF(path_object);
+    reader_options options;
+    if (!parse_options(format, threads, chunk_size, options)) return nullptr;
+    sensor_log* log = new sensor_log;
+    std::string error;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = read_sensor_log(path, options, *log, error);
+    Py_END_ALLOW_THREADS
+    return wrap_result(result, log, error);
+}
+
+static PyObject* sensorlog_parse(PyObject* module, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"data", "format", "threads", "chunk_size", nullptr};
+    Py_buffer data;
+    const char* format = "auto";
+    long threads = 0;
+    Py_ssize_t chunk_size = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|$sln", const_cast<char**>(keywords),
+                                     &data, &format, &threads, &chunk_size)) return nullptr;
+    reader_options options;
+    if (!parse_options(format, threads, chunk_size, options)) {
+        PyBuffer_Release(&data);
+        return nullptr;
+    }
+    sensor_log* log = new sensor_log;
+    std::string error;
+    int result;
+    Py_BEGIN_ALLOW_THREADS
+    result = parse_sensor_log(static_cast<const char*>(data.buf), data.len, options, *log, error);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&data);
+    return wrap_result(result, log, error);
+}
+
+static PyMethodDef sensorlog_methods[] = {
+    {"read", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(sensorlog_read)), METH_VARARGS | METH_KEYWORDS,
+     "read(path, *, format='auto', threads=0, chunk_size=0) -> Log\n\n"
+     "Load a CSV or JSON/NDJSON log (framed and/or gzip-compressed logs are unwrapped first).\n"
+     "threads=0 uses every hardware thread; chunk_size=0 uses the default minimum chunk."},
+    {"parse", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)(void)>(sensorlog_parse)), METH_VARARGS | METH_KEYWORDS,
+     "parse(data, *, format='auto', threads=0, chunk_size=0) -> Log\n\n"
+     "As read(), for a log already held in a bytes-like object."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+static PyModuleDef sensorlog_module = {
+    PyModuleDef_HEAD_INIT, "sensorlog", "Fast loader for LibSensorTools logs", -1, sensorlog_methods,
+};
+
+PyMODINIT_FUNC PyInit_sensorlog(void) {
+    PyObject* module = PyModule_Create(&sensorlog_module);
+    if (module == nullptr) return nullptr;
+    LogType = PyType_FromSpec(&log_spec);
+    ColumnType = PyType_FromSpec(&column_spec);
+    if (LogType == nullptr || ColumnType == nullptr ||
+        PyModule_AddObjectRef(module, "Log", LogType) != 0 ||
+        PyModule_AddObjectRef(module, "Column", ColumnType) != 0) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
+
@@ -0,0 +1,226 @@
+#include "cgroup_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <fstream> // /proc/self/mountinfo, /proc/self/cgroup
+#include <sstream> // Splitting mountinfo fields
+#include <algorithm> // std::replace
+#include <cstring> // strerror()
+#include <cerrno> // errno
+// End Headers
+
+// Mount point of the cgroup v2 hierarchy: /sys/fs/cgroup on unified systems, /sys/fs/cgroup/unified on hybrid ones
+static std::filesystem::path cgroup2_mount(void) {
+    std::ifstream mountinfo("/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        if (line.find(" - cgroup2 ") == std::string::npos) continue;
+        std::istringstream fields(line);
+        std::string id, parent, devno, root, mountpoint;
+        fields >> id >> parent >> devno >> root >> mountpoint;
+        return mountpoint;
+    }
+    return "";
+}
+
+// Our own group below the hierarchy's root, from the "0::" line of /proc/self/cgroup
+static std::string own_cgroup(void) {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line))
+        if (line.compare(0, 3, "0::") == 0) return line.substr(3);
+    return "";
+}
+
+// Write one request to a cgroup interface file, ie: "+memory" to cgroup.subtree_control or "0" to cgroup.procs
+static bool write_cgroup_request(const std::filesystem::path& file, const std::string& request) {
+    int fd = open(file.c_str(), O_WRONLY | O_CLOEXEC);
+    bool written = (fd >= 0 && write(fd, request.c_str(), request.size()) == static_cast<ssize_t>(request.size()));
+    int saved = errno;
+    if (fd >= 0) close(fd);
+    errno = saved;
+    return written;
+}
+
+// Whether a whitespace-separated list (cgroup.controllers, cgroup.subtree_control, cgroup.procs) holds entry
+static bool lists_entry(const std::filesystem::path& file, const std::string& entry) {
+    std::ifstream in(file);
+    std::string name;
+    while (in >> name)
+        if (name == entry) return true;
+    return false;
+}
+
+// Delegate a controller to dir's children; a group refuses (EBUSY) while it holds processes of its own
+static bool enable_controller(const std::filesystem::path& dir, const std::string& controller) {
+    if (!lists_entry(dir / "cgroup.controllers", controller) || lists_entry(dir / "cgroup.subtree_control", controller)) return false;
+    if (write_cgroup_request(dir / "cgroup.subtree_control", "+" + controller)) return true;
+    if (args.debug >= DebugMinimal)
+        args.error_log << "Unable to enable the " << controller << " controller under " << dir << ": " << strerror(errno) << std::endl;
+    return false;
+}
+
+static void remove_cgroup_dir(const std::filesystem::path& dir) {
+    if (!dir.empty() && rmdir(dir.c_str()) != 0 && errno != ENOENT && args.debug >= DebugMinimal)
+        args.error_log << "Unable to remove cgroup " << dir << ": " << strerror(errno) << std::endl;
+}
+
+static void open_cgroup_file(cgroup_file& file) {
+    file.fd = open((wrapped_cgroup.dir / file.name).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file.fd < 0 && args.debug >= DebugMinimal)
+        args.error_log << "Wrapped command cgroup has no " << file.name << " (controller not enabled), its channels are skipped" << std::endl;
+}
+
+static void add_cgroup_channel(cgroup_file& file, const std::string& field, const std::string& human) {
+    if (file.fd < 0) return;
+    std::string json = field;
+    std::replace(json.begin(), json.end(), '_', '-');
+    file.channels.push_back(samples.add_channel("cgroup_" + field, "cgroup-" + json, "Cgroup " + human));
+}
+
+void cache_cgroup(void) {
+    // No caching if we aren't going to account the wrapped command
+    if (!args.cgroup) return;
+    if (args.wrapped == nullptr) {
+        args.error_log << "No wrapped command to account, no cgroup created" << std::endl;
+        args.cgroup = false;
+        return;
+    }
+    std::filesystem::path mount = cgroup2_mount();
+    std::string own = own_cgroup();
+    if (mount.empty() || own.empty()) {
+        args.error_log << "No cgroup v2 hierarchy mounted, no longer tracking" << std::endl;
+        args.cgroup = false;
+        return;
+    }
+    cgroup_cache& g = wrapped_cgroup;
+    g.parent = mount.string() + own;
+    g.top = g.parent / ("sensortools-" + std::to_string(getpid()));
+    g.monitor = g.top / "monitor";
+    g.dir = g.top / "workload";
+    std::error_code ec;
+    bool created = std::filesystem::create_directory(g.top, ec) && std::filesystem::create_directory(g.monitor, ec) &&
+                   std::filesystem::create_directory(g.dir, ec);
+    // Leaving our own group empties it (unless other processes share it), so it can delegate controllers to the new groups
+    if (!created || !write_cgroup_request(g.monitor / "cgroup.procs", "0") ||
+        (g.procs_fd = open((g.dir / "cgroup.procs").c_str(), O_WRONLY | O_CLOEXEC)) < 0) {
+        args.error_log << "Unable to set up cgroups below " << g.top << ": " << (ec ? ec.message() : strerror(errno)) << ", no longer tracking" << std::endl;
+        remove_cgroup();
+        args.cgroup = false;
+        return;
+    }
+    // cpu.stat and cpu.pressure exist without any controller; the rest need theirs delegated down both levels
+    for (const char* controller : {"cpu", "memory", "io"}) {
+        if (enable_controller(g.parent, controller)) g.parent_enabled.push_back(controller);
+        enable_controller(g.top, controller);
+    }
+    std::string missing;
+    for (const char* controller : {"memory", "io"})
+        if (!lists_entry(g.dir / "cgroup.controllers", controller)) missing += std::string(missing.empty() ? "" : ", ") + controller;
+    if (!missing.empty())
+        args.error_log << "Controllers " << missing << " are not available below " << g.parent <<
+                          " (it is not delegated, or other processes still run in it); the wrapped command's memory and IO are not recorded" << std::endl;
+    g.attach_error = "Unable to start the wrapped command in " + g.dir.string() + "\n";
+
+    open_cgroup_file(wrapped_cgroup.cpu_stat);
+    open_cgroup_file(wrapped_cgroup.memory_current);
+    open_cgroup_file(wrapped_cgroup.memory_peak);
+    open_cgroup_file(wrapped_cgroup.io_stat);
+    open_cgroup_file(wrapped_cgroup.cpu_pressure);
+    add_cgroup_channel(wrapped_cgroup.cpu_stat, "cpu_usage", "CPU Usage (cores)");
+    add_cgroup_channel(wrapped_cgroup.cpu_stat, "cpu_user", "CPU User (cores)");
+    add_cgroup_channel(wrapped_cgroup.cpu_stat, "cpu_system", "CPU System (cores)");
+    add_cgroup_channel(wrapped_cgroup.memory_current, "memory_current", "Memory Current (bytes)");
+    add_cgroup_channel(wrapped_cgroup.memory_peak, "memory_peak", "Memory Peak (bytes)");
+    add_cgroup_channel(wrapped_cgroup.io_stat, "io_read_bytes", "IO Read (bytes/s)");
+    add_cgroup_channel(wrapped_cgroup.io_stat, "io_write_bytes", "IO Write (bytes/s)");
+    add_cgroup_channel(wrapped_cgroup.io_stat, "io_read_ops", "IO Read (IOs/s)");
+    add_cgroup_channel(wrapped_cgroup.io_stat, "io_write_ops", "IO Write (IOs/s)");
+    add_cgroup_channel(wrapped_cgroup.cpu_pressure, "cpu_pressure_some", "CPU Pressure Some (%)");
+    add_cgroup_channel(wrapped_cgroup.cpu_pressure, "cpu_pressure_full", "CPU Pressure Full (%)");
+    // The group is empty until the wrapped command starts, so every counter starts from zero
+    wrapped_cgroup.last_read = poll_clock.now();
+    if (args.debug >= DebugMinimal)
+        args.error_log << "Wrapped command will run in cgroup " << wrapped_cgroup.dir << std::endl;
+}
+
+// Counter change since the previous poll, times scale; counters that step back (ie: a removed device) count as no change
+static inline double cgroup_rate(uint64_t& last, uint64_t now, double scale) {
+    double rate = (now > last) ? (now - last) * scale : 0;
+    last = now;
+    return rate;
+}
+
+static char cgroup_buf[CgroupReadSize];
+
+static ssize_t read_cgroup_file(const cgroup_file& file) {
+    return (file.fd < 0) ? -1 : pread(file.fd, cgroup_buf, sizeof(cgroup_buf), 0);
+}
+
+void update_cgroup(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update cgroup" << std::endl;
+    cgroup_cache& g = wrapped_cgroup;
+    PollClock::time_point now = poll_clock.now();
+    double elapsed_us = std::chrono::duration_cast<std::chrono::nanoseconds>(now - g.last_read).count() / 1e3;
+    if (elapsed_us <= 0) return;
+    g.last_read = now;
+    ssize_t n;
+    // CPU time in microseconds, as cores kept busy over the interval
+    if ((n = read_cgroup_file(g.cpu_stat)) > 0) {
+        samples.set(g.cpu_stat.channels[0], cgroup_rate(g.usage_usec, procfs_field(cgroup_buf, n, "usage_usec "), 1. / elapsed_us));
+        samples.set(g.cpu_stat.channels[1], cgroup_rate(g.user_usec, procfs_field(cgroup_buf, n, "user_usec "), 1. / elapsed_us));
+        samples.set(g.cpu_stat.channels[2], cgroup_rate(g.system_usec, procfs_field(cgroup_buf, n, "system_usec "), 1. / elapsed_us));
+    }
+    if ((n = read_cgroup_file(g.memory_current)) > 0)
+        samples.set(g.memory_current.channels[0], procfs_number(cgroup_buf, cgroup_buf + n));
+    if ((n = read_cgroup_file(g.memory_peak)) > 0)
+        samples.set(g.memory_peak.channels[0], procfs_number(cgroup_buf, cgroup_buf + n));
+    // One line per device; the workload's total is their sum
+    if ((n = read_cgroup_file(g.io_stat)) >= 0) {
+        samples.set(g.io_stat.channels[0], cgroup_rate(g.rbytes, procfs_field_sum(cgroup_buf, n, "rbytes="), 1e6 / elapsed_us));
+        samples.set(g.io_stat.channels[1], cgroup_rate(g.wbytes, procfs_field_sum(cgroup_buf, n, "wbytes="), 1e6 / elapsed_us));
+        samples.set(g.io_stat.channels[2], cgroup_rate(g.rios, procfs_field_sum(cgroup_buf, n, "rios="), 1e6 / elapsed_us));
+        samples.set(g.io_stat.channels[3], cgroup_rate(g.wios, procfs_field_sum(cgroup_buf, n, "wios="), 1e6 / elapsed_us));
+    }
+    // Stall microseconds as a share of the interval
+    if ((n = read_cgroup_file(g.cpu_pressure)) > 0) {
+        samples.set(g.cpu_pressure.channels[0], cgroup_rate(g.some_usec, procfs_pressure_total(cgroup_buf, n, "some "), 100. / elapsed_us));
+        samples.set(g.cpu_pressure.channels[1], cgroup_rate(g.full_usec, procfs_pressure_total(cgroup_buf, n, "full "), 100. / elapsed_us));
+    }
+}
+
+void attach_cgroup_child(void) {
+    // Writing 0 moves the writer; children forked later inherit the group
+    // Only write(2) here: another thread may have held the allocator or error log's locks at fork
+    if (wrapped_cgroup.procs_fd >= 0 && write(wrapped_cgroup.procs_fd, "0", 1) < 0)
+        if (write(STDERR_FILENO, wrapped_cgroup.attach_error.data(), wrapped_cgroup.attach_error.size()) < 0) return;
+}
+
+void remove_cgroup(void) {
+    cgroup_cache& g = wrapped_cgroup;
+    if (g.top.empty()) return;
+    for (cgroup_file* file : {&g.cpu_stat, &g.memory_current, &g.memory_peak, &g.io_stat, &g.cpu_pressure})
+        if (file->fd >= 0) close(file->fd);
+    if (g.procs_fd >= 0) close(g.procs_fd);
+    // Fails while processes the wrapped command left behind still run there
+    remove_cgroup_dir(g.dir);
+    // Undo the delegation bottom-up, so our own group may hold this process again, then leave the monitor group
+    for (const char* controller : {"cpu", "memory", "io"})
+        if (lists_entry(g.top / "cgroup.subtree_control", controller))
+            write_cgroup_request(g.top / "cgroup.subtree_control", std::string("-") + controller);
+    for (std::vector<std::string>::iterator i = g.parent_enabled.begin(); i != g.parent_enabled.end(); i++)
+        if (!write_cgroup_request(g.parent / "cgroup.subtree_control", "-" + *i) && args.debug >= DebugMinimal)
+            args.error_log << "Unable to disable the " << *i << " controller under " << g.parent << ": " << strerror(errno) << std::endl;
+    if (lists_entry(g.monitor / "cgroup.procs", std::to_string(getpid())) &&
+        !write_cgroup_request(g.parent / "cgroup.procs", "0") && args.debug >= DebugMinimal)
+        args.error_log << "Unable to return to cgroup " << g.parent << ": " << strerror(errno) << std::endl;
+    remove_cgroup_dir(g.monitor);
+    remove_cgroup_dir(g.top);
+    g.top.clear();
+    g.dir.clear();
+    g.parent_enabled.clear();
+}
+
+// Definition of external variables for cgroup tools
+cgroup_cache wrapped_cgroup;
+
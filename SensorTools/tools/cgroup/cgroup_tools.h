@@ -0,0 +1,60 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), write(), close(), getpid()
+#include <filesystem> // cgroup directory creation
+// May require on some systems: -lstdc++fs
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/procfs_parse.h" // Keyed counter parsing of cgroupfs files
+#include "io/poll_clock.h" // Poll intervals for rates
+// End Headers
+
+#define CgroupReadSize 16384 // io.stat holds a line per device
+
+
+// Class and Type declarations
+// One interface file of the wrapped command's cgroup, kept open and re-read every poll
+typedef struct cgroup_file_t {
+    const char* name; // ie: cpu.stat
+    int fd = -1;
+    std::vector<int> channels; // Sample channels fed from this file
+} cgroup_file;
+
+// The cgroup v2 groups created below the sensors program's own group:
+//     sensortools-<pid>/          controllers for the wrapped command are enabled here, so it must hold no processes
+//     sensortools-<pid>/monitor   the sensors program itself, moved out of its own group so that group can delegate too
+//     sensortools-<pid>/workload  the wrapped command and everything it forks
+typedef struct cgroup_cache_t {
+    std::filesystem::path parent, top, monitor, dir; // dir is the workload group
+    std::vector<std::string> parent_enabled; // Controllers this program enabled in the parent's subtree_control
+    int procs_fd = -1; // workload cgroup.procs, written by the forked child before exec
+    std::string attach_error; // Reported by the forked child with write(2) alone
+    cgroup_file cpu_stat = {"cpu.stat", -1, {}}, memory_current = {"memory.current", -1, {}}, memory_peak = {"memory.peak", -1, {}},
+                io_stat = {"io.stat", -1, {}}, cpu_pressure = {"cpu.pressure", -1, {}};
+    // Counters at the previous poll
+    uint64_t usage_usec = 0, user_usec = 0, system_usec = 0,
+             rbytes = 0, wbytes = 0, rios = 0, wios = 0,
+             some_usec = 0, full_usec = 0;
+    PollClock::time_point last_read;
+} cgroup_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_cgroup(void);
+void update_cgroup(void);
+// Called in the forked child before exec, so the wrapped command starts inside the group; async-signal-safe
+void attach_cgroup_child(void);
+// Move the sensors program back and remove the groups once the wrapped command's processes have exited
+void remove_cgroup(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern cgroup_cache wrapped_cgroup;
+// End External variable declarations
+
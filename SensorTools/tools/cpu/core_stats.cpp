@@ -0,0 +1,67 @@
+#include "core_stats.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <sstream> // Splitting the statistics list
+// End Headers
+
+#define ProcStatFields 10 // user nice system idle iowait irq softirq steal guest guest_nice
+
+bool parse_core_stats(const std::string& list, unsigned& stats, std::string& error) {
+    stats = 0;
+    std::istringstream in(list);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        if (name == "all") {
+            stats = (1u << count_CoreStatKinds) - 1;
+            continue;
+        }
+        int kind = 0;
+        while (kind < count_CoreStatKinds && name != core_stat_types[kind].name) kind++;
+        if (kind == count_CoreStatKinds) {
+            error = "Unknown core statistic '" + name + "', choose from all";
+            for (kind = 0; kind < count_CoreStatKinds; kind++) error += std::string(", ") + core_stat_types[kind].name;
+            return false;
+        }
+        stats |= 1u << kind;
+    }
+    if (stats == 0) {
+        error = "No core statistics given";
+        return false;
+    }
+    return true;
+}
+
+int parse_proc_stat(const char* buf, size_t len, const int* slot_of, size_t n_slot_of, proc_stat_times* times) {
+    const char *p = buf, *end = buf + len;
+    int stored = 0;
+    // cpu lines always lead the file; stop at the first other line
+    while (end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+        p += 3;
+        size_t id = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) id = id * 10 + (*p - '0');
+        // The aggregate line has no digits after "cpu"
+        id = (p[-1] == 'u') ? 0 : id + 1;
+        uint64_t fields[ProcStatFields] = {0};
+        int field = 0;
+        while (p < end && *p != '\n') {
+            if (*p < '0' || *p > '9') { p++; continue; }
+            uint64_t value = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; p++) value = value * 10 + (*p - '0');
+            if (field < ProcStatFields) fields[field++] = value;
+        }
+        // A line cut short by the read cannot be trusted
+        if (p == end) break;
+        p++;
+        if (id >= n_slot_of || slot_of[id] < 0) continue;
+        proc_stat_times& t = times[slot_of[id]];
+        t.user = fields[0] + fields[1];
+        t.system = fields[2] + fields[5] + fields[6];
+        t.idle = fields[3];
+        t.iowait = fields[4];
+        t.total = t.user + t.system + t.idle + t.iowait + fields[7];
+        stored++;
+    }
+    return stored;
+}
+
@@ -0,0 +1,53 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_CoreStats
+#define LibSensorTools_CoreStats
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "../../enums.h" // CoreStatKinds
+#include <string> // String class and manipulation
+#include <cstdint> // uint64_t
+#include <cstddef> // size_t
+// End Headers
+
+#define ProcStatPath "/proc/stat"
+#define CpuSysfsRoot "/sys/devices/system/cpu"
+#define CoreDefaultStats (1u << CoreFrequency) // Statistics collected when -K | --core-stats is not given
+
+// Class and Type declarations
+// How each CoreStatKinds value is named on the command line and described in help
+typedef struct core_stat_type_t {
+    const char* name;
+    const char* description;
+} core_stat_type;
+static const core_stat_type core_stat_types[count_CoreStatKinds] = {
+    {"freq", "cpufreq scaling_cur_freq"},
+    {"util", "user/system/idle/iowait % from /proc/stat"},
+    {"cstate", "% of each poll in each cpuidle state"},
+    {"throttle", "core/package thermal throttle events per poll"},
+    {"perf", "effective kHz and busy ratio from APERF/MPERF or cycles/ref-cycles"},
+};
+
+// CPU time of one /proc/stat cpu line in USER_HZ ticks, folded into the reported categories
+//     user includes nice (and guest time, which the kernel already counts as user)
+//     system includes irq and softirq; total adds steal
+typedef struct proc_stat_times_t {
+    uint64_t user = 0, system = 0, idle = 0, iowait = 0, total = 0;
+} proc_stat_times;
+// End Class and Type declarations
+
+// Function declarations
+// Parse a comma-separated list of core_stat_types names (or "all") into bits of CoreStatKinds
+bool parse_core_stats(const std::string& list, unsigned& stats, std::string& error);
+// Parse the cpu lines at the head of /proc/stat in buf[0..len) without allocating
+// slot_of maps line ids to entries of times: slot_of[0] is the aggregate "cpu" line, slot_of[N+1] is "cpuN";
+// lines with ids beyond n_slot_of, negative slots or no terminating newline are skipped
+// Returns the number of lines stored
+int parse_proc_stat(const char* buf, size_t len, const int* slot_of, size_t n_slot_of, proc_stat_times* times);
+// End Function declarations
+#endif
+
@@ -1,19 +1,31 @@
 #include "cpu_tools.h"
 
-void cache_cpus(void) {
-    // No caching if we aren't going to query the CPUs
-    if (!args.cpu) return;
+// Register a chip's channels once its readings are known
+// Temperatures keep their original names so logs stay comparable; other kinds carry their unit in the human-readable name
+static void add_reading_channels(cpu_cache& candidate) {
+    int per_kind[count_CpuFeatureKinds] = {0};
+    for (std::vector<cpu_reading>::iterator r = candidate.readings.begin(); r != candidate.readings.end(); r++) {
+        const cpu_feature_type& type = cpu_feature_types[r->kind];
+        std::string index = std::to_string(per_kind[r->kind]++);
+        r->channel = samples.add_channel(
+            "cpu_" + std::string(candidate.chip_name) + "_" + type.field + "_" + index,
+            "cpu-" + std::string(candidate.chip_name) + "-" + type.field + "-" + index,
+            "Chip " + std::string(candidate.chip_name) + " " + type.field + " " + index +
+            ((r->kind == CpuTemperature) ? "" : std::string(" (") + type.unit + ")"));
+        if (r->kind == CpuTemperature) cpus_to_satisfy++;
+    }
+}
 
-    // Cache temperature values through lm-sensors
+#ifdef CPU_LIBSENSORS_ENABLED
+// Cache feature values through lm-sensors
+static void cache_libsensors_features(void) {
     int nr_name = 0, nr_feature;
-    sensors_subfeature_type nr_subfeature = SENSORS_SUBFEATURE_TEMP_INPUT;
     double value;
 
     // Exits when no additional chips can be read from sensors library
     while (1) {
         // Reset sub-iterators
         nr_feature = 0;
-        nr_subfeature = SENSORS_SUBFEATURE_TEMP_INPUT;
 
         // Prepare candidate
         cpu_cache candidate;
@@ -34,59 +46,126 @@ void cache_cpus(void) {
         const sensors_feature* temp_feature = sensors_get_features(temp_name, &nr_feature);
         while(temp_feature) {
             if (args.debug >= DebugVerbose)
-                args.error_log << "\tInspect feature " << nr_feature << " with type " << temp_feature->type << " (hit on type == " << SENSORS_FEATURE_TEMP << ")" << std::endl;
-            // We only care about this type of feature
-            if (temp_feature->type == SENSORS_FEATURE_TEMP) {
-                candidate.features.push_back(temp_feature);
-                // Skip directly to input subfeature value
-                const sensors_subfeature* temp_subfeature = sensors_get_subfeature(temp_name, temp_feature, nr_subfeature);
-                if (args.debug >= DebugVerbose)
-                    args.error_log << "\t\tFeature hit. Acquiring temperature subfeature " << nr_subfeature << std::endl;
-                candidate.subfeatures.push_back(temp_subfeature);
-                sensors_get_value(temp_name, temp_subfeature->number, &value);
-                if (args.debug >= DebugVerbose)
-                    args.error_log << "\t\t\tTemperature value read: " << value << std::endl;
-                candidate.temperature.push_back(value);
-                candidate.initial_temperature.push_back(value);
-                cpus_to_satisfy++;
+                args.error_log << "\tInspect feature " << nr_feature << " with type " << temp_feature->type << " (enabled types: " << args.cpu_features << ")" << std::endl;
+            // CpuFeatureKinds share libsensors' numbering of the main feature types
+            int kind = static_cast<int>(temp_feature->type);
+            if (kind < count_CpuFeatureKinds && (args.cpu_features & (1u << kind))) {
+                // Every main type's *_INPUT subfeature is its first; power meters may only offer an average
+                const sensors_subfeature* temp_subfeature = (temp_feature->type == SENSORS_FEATURE_POWER) ?
+                    sensors_get_subfeature(temp_name, temp_feature, SENSORS_SUBFEATURE_POWER_INPUT) :
+                    sensors_get_subfeature(temp_name, temp_feature, static_cast<sensors_subfeature_type>(temp_feature->type << 8));
+                if (temp_subfeature == nullptr && temp_feature->type == SENSORS_FEATURE_POWER)
+                    temp_subfeature = sensors_get_subfeature(temp_name, temp_feature, SENSORS_SUBFEATURE_POWER_AVERAGE);
+                if (temp_subfeature != nullptr) {
+                    if (args.debug >= DebugVerbose)
+                        args.error_log << "\t\tFeature hit. Acquiring input subfeature " << temp_subfeature->type << std::endl;
+                    sensors_get_value(temp_name, temp_subfeature->number, &value);
+                    if (args.debug >= DebugVerbose)
+                        args.error_log << "\t\t\t" << cpu_feature_types[kind].field << " value read: " << value << std::endl;
+                    cpu_reading reading;
+                    reading.kind = kind;
+                    reading.subfeature = temp_subfeature;
+                    reading.value = reading.initial = value;
+                    candidate.readings.push_back(reading);
+                }
+                else if (args.debug >= DebugVerbose)
+                    args.error_log << "\t\tFeature has no input subfeature, skipped" << std::endl;
             }
             temp_feature = sensors_get_features(temp_name, &nr_feature);
         }
         if (args.debug >= DebugVerbose)
             args.error_log << "Finished inspecting chip " << candidate.chip_name;
-        if (!candidate.temperature.empty()) {
+        if (!candidate.readings.empty()) {
+            add_reading_channels(candidate);
             known_cpus.push_back(candidate);
             if (args.debug >= DebugVerbose)
                 args.error_log << " , added to known CPUs" << std::endl;
         }
         else if (args.debug >= DebugVerbose)
-            args.error_log << " , but discarded due to empty temperature reads" << std::endl;
+            args.error_log << " , but discarded due to empty reads" << std::endl;
     }
+}
+#endif
 
-    // Cache CPU frequencies via file pointers
-    const std::string prefix = "/sys/devices/system/cpu/cpu",
+
+// Cache feature values by reading hwmon directly, under the same chip names and indices libsensors reports
+// Each input stays open and is re-read with every other cached file by sysfs_reads
+static void cache_hwmon_features(void) {
+    std::vector<hwmon_chip> chips = scan_hwmon(host_path(HwmonRoot), args.cpu_features, args.error_log, args.debug);
+    char buf[SysfsReadSize] = {0};
+    int nr_name = 0;
+    for (std::vector<hwmon_chip>::iterator chip = chips.begin(); chip != chips.end(); chip++) {
+        cpu_cache candidate;
+        candidate.nr = nr_name++;
+        strncpy(candidate.chip_name, chip->name.c_str(), NAME_BUFFER_SIZE - 1);
+        if (args.debug >= DebugVerbose)
+            args.error_log << "Begin caching hwmon chip " << candidate.chip_name << " at " << chip->dir << std::endl;
+        for (std::vector<hwmon_input>::iterator input = chip->inputs.begin(); input != chip->inputs.end(); input++) {
+            int fd = open(input->path.c_str(), O_RDONLY | O_CLOEXEC);
+            cpu_reading reading;
+            reading.kind = input->kind;
+            reading.compute = input->compute;
+            ssize_t nbytes = (fd >= 0) ? pread(fd, buf, sizeof(buf), 0) : -1;
+            if (nbytes <= 0 || (reading.slot = sysfs_reads.add(fd)) < 0) {
+                if (fd >= 0) close(fd);
+                if (args.debug >= DebugMinimal)
+                    args.error_log << "Unable to read " << input->path << ", later " << cpu_feature_types[input->kind].field <<
+                                      " channels of chip " << candidate.chip_name << " are renumbered" << std::endl;
+                continue;
+            }
+            reading.value = reading.initial = apply_hwmon_compute(reading.compute, parse_sysfs_int(buf, nbytes) / cpu_feature_types[input->kind].scale);
+            if (args.debug >= DebugVerbose)
+                args.error_log << "\t" << input->feature << (input->compute.empty() ? "" : " (computed)") << " value read: " << reading.value << std::endl;
+            candidate.readings.push_back(reading);
+        }
+        if (args.debug >= DebugVerbose)
+            args.error_log << "Finished inspecting chip " << candidate.chip_name;
+        if (!candidate.readings.empty()) {
+            add_reading_channels(candidate);
+            known_cpus.push_back(candidate);
+            if (args.debug >= DebugVerbose)
+                args.error_log << " , added to known CPUs" << std::endl;
+        }
+        else if (args.debug >= DebugVerbose)
+            args.error_log << " , but discarded due to empty reads" << std::endl;
+    }
+}
+
+
+// Cache CPU frequencies via file descriptors
+static void cache_frequencies(void) {
+    const std::string prefix = host_path(CpuSysfsRoot) + "/cpu",
                       suffix = "/cpufreq/scaling_cur_freq";
     int n_cpu = 0;
-    char buf[NAME_BUFFER_SIZE] = {0};
+    char buf[SysfsReadSize] = {0};
     // Collect until we cannot find a CPU core id to match
     while (1) {
         std::filesystem::path fpath(prefix + std::to_string(n_cpu) + suffix);
         if (std::filesystem::exists(fpath)) {
             freq_cache candidate;
             candidate.coreid = n_cpu;
-            candidate.fhandle = fopen(fpath.c_str(), "r");
-            if (candidate.fhandle) {
+            // Close-on-exec keeps these out of the wrapped command
+            candidate.fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (candidate.fd >= 0) {
                 // Initial read
-                int nbytes = fread(buf, sizeof(char), NAME_BUFFER_SIZE, candidate.fhandle);
-                if (nbytes > 0) {
-                    candidate.hz = std::stoi(buf);
-                    rewind(candidate.fhandle);
+                ssize_t nbytes = pread(candidate.fd, buf, sizeof(buf), 0);
+                if (nbytes > 0 && (candidate.slot = sysfs_reads.add(candidate.fd)) >= 0) {
+                    candidate.hz = parse_sysfs_uint(buf, nbytes);
+                    // With -O | --aggregate-only the core is only reported through its groups' aggregates
+                    candidate.channel = -1;
+                    if (!args.aggregate_only)
+                        candidate.channel = samples.add_channel("core_" + std::to_string(n_cpu) + "_freq",
+                                                                "core-" + std::to_string(n_cpu) + "-frequency",
+                                                                "Core " + std::to_string(n_cpu) + " Frequency");
                     known_freqs.push_back(candidate);
                     if (args.debug >= DebugVerbose)
                         args.error_log << "Found CPU freq for core " << n_cpu << std::endl;
                 }
-                else if (args.debug >= DebugMinimal)
-                    args.error_log << "Unable to read CPU freq for core " << n_cpu << ", so it is not cached" << std::endl;
+                else {
+                    close(candidate.fd);
+                    if (args.debug >= DebugMinimal)
+                        args.error_log << "Unable to read CPU freq for core " << n_cpu << ", so it is not cached" << std::endl;
+                }
             }
             else if (args.debug >= DebugMinimal)
                 args.error_log << "Unable to open CPU freq for core " << n_cpu << ", but its file should exist!" << std::endl;
@@ -98,66 +177,494 @@ void cache_cpus(void) {
         }
         n_cpu++;
     }
+}
+
+
+// /proc/stat stays open; each poll reads just enough of it to cover the cpu lines
+static int proc_stat_fd = -1;
+static std::vector<char> proc_stat_buf;
+static std::vector<int> util_slot_of; // Index into known_utils by /proc/stat line id (0 == aggregate, N+1 == cpuN)
+static std::vector<proc_stat_times> util_times; // Parse target, one per known_utils entry
+static const char* const util_fields[4] = {"user", "system", "idle", "iowait"},
+                 * const util_names[4] = {"User", "System", "Idle", "IOWait"};
+
+static void cache_utilization(void) {
+    proc_stat_fd = open(host_path(ProcStatPath).c_str(), O_RDONLY | O_CLOEXEC);
+    std::vector<char> whole(16384);
+    ssize_t nbytes = -1;
+    // The interrupt lines after the cpu lines can be large; read it all once to find where the cpu lines end
+    while (proc_stat_fd >= 0 && (nbytes = pread(proc_stat_fd, whole.data(), whole.size(), 0)) == static_cast<ssize_t>(whole.size()))
+        whole.resize(whole.size() * 2);
+    if (nbytes <= 0) {
+        args.error_log << "Unable to read " << host_path(ProcStatPath) << ", CPU utilization is not tracked" << std::endl;
+        if (proc_stat_fd >= 0) close(proc_stat_fd);
+        proc_stat_fd = -1;
+        return;
+    }
+    std::vector<int> ids;
+    size_t cpu_end = 0;
+    while (cpu_end + 3 < static_cast<size_t>(nbytes) && strncmp(whole.data() + cpu_end, "cpu", 3) == 0) {
+        if (whole[cpu_end + 3] != ' ') ids.push_back(atoi(whole.data() + cpu_end + 3));
+        while (cpu_end < static_cast<size_t>(nbytes) && whole[cpu_end] != '\n') cpu_end++;
+        cpu_end++;
+    }
+    // Frequencies and utilization share core IDs whenever both are collected
+    if (!known_freqs.empty()) {
+        ids.clear();
+        for (std::vector<freq_cache>::iterator i = known_freqs.begin(); i != known_freqs.end(); i++) ids.push_back(i->coreid);
+    }
+    int max_id = -1;
+    for (std::vector<int>::iterator id = ids.begin(); id != ids.end(); id++) max_id = std::max(max_id, *id);
+    util_slot_of.assign(max_id + 2, -1);
+    util_cache all;
+    all.coreid = -1;
+    known_utils.push_back(all);
+    util_slot_of[0] = 0;
+    for (std::vector<int>::iterator id = ids.begin(); id != ids.end(); id++) {
+        util_cache candidate;
+        candidate.coreid = *id;
+        util_slot_of[*id + 1] = known_utils.size();
+        known_utils.push_back(candidate);
+    }
+    util_times.resize(known_utils.size());
+    // Headroom for counters gaining digits over a long run
+    proc_stat_buf.resize(cpu_end * 2 + 4096);
+    parse_proc_stat(whole.data(), nbytes, util_slot_of.data(), util_slot_of.size(), util_times.data());
+    for (size_t k = 0; k < known_utils.size(); k++) {
+        util_cache& u = known_utils[k];
+        u.last = util_times[k];
+        std::string core = (u.coreid < 0) ? "all" : std::to_string(u.coreid);
+        for (int f = 0; f < 4; f++)
+            // The all-cores line is kept with -O | --aggregate-only; single cores are reported through their groups
+            u.channels[f] = (u.coreid >= 0 && args.aggregate_only) ? -1 : samples.add_channel("core_" + core + "_" + util_fields[f],
+                                                "core-" + core + "-" + util_fields[f],
+                                                ((u.coreid < 0) ? std::string("All Cores") : "Core " + core) + " " + util_names[f] + " %");
+    }
+    if (args.debug >= DebugVerbose)
+        args.error_log << "Tracking utilization of " << ids.size() << " cores from the first " << cpu_end << " bytes of " << host_path(ProcStatPath) << std::endl;
+}
+
+
+// Cores whose counters are collected: those with tracked frequencies, otherwise every present cpuN
+static std::vector<int> counter_core_ids(void) {
+    std::vector<int> ids;
+    for (std::vector<freq_cache>::iterator i = known_freqs.begin(); i != known_freqs.end(); i++) ids.push_back(i->coreid);
+    if (!ids.empty()) return ids;
+    for (int n_cpu = 0; std::filesystem::exists(std::filesystem::path(host_path(CpuSysfsRoot)) / ("cpu" + std::to_string(n_cpu))); n_cpu++)
+        ids.push_back(n_cpu);
+    return ids;
+}
+
+static bool add_core_counter(int kind, int coreid, const std::filesystem::path& path, const std::string& field, const std::string& human) {
+    char buf[SysfsReadSize] = {0};
+    counter_cache candidate;
+    candidate.kind = kind;
+    candidate.coreid = coreid;
+    // Close-on-exec keeps these out of the wrapped command
+    candidate.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    ssize_t nbytes = (candidate.fd >= 0) ? pread(candidate.fd, buf, sizeof(buf), 0) : -1;
+    if (nbytes <= 0 || (candidate.slot = sysfs_reads.add(candidate.fd)) < 0) {
+        if (candidate.fd >= 0) close(candidate.fd);
+        if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to read " << path << ", so it is not cached" << std::endl;
+        return false;
+    }
+    candidate.last = parse_sysfs_uint(buf, nbytes);
+    std::string core = std::to_string(coreid);
+    candidate.channel = samples.add_channel("core_" + core + "_" + field,
+                                            "core-" + core + "-" + field,
+                                            "Core " + core + " " + human);
+    known_core_counters.push_back(candidate);
+    return true;
+}
+
+static PollClock::time_point counters_read; // When known_core_counters were last read
+
+// Cache cpuidle residency and thermal throttle counters via file descriptors, grouped by core
+static void cache_core_counters(void) {
+    std::vector<int> ids = counter_core_ids();
+    for (std::vector<int>::iterator id = ids.begin(); id != ids.end(); id++) {
+        std::filesystem::path cpu = std::filesystem::path(host_path(CpuSysfsRoot)) / ("cpu" + std::to_string(*id));
+        if (args.core_stats & (1u << CoreIdleResidency)) {
+            // cpuidle numbers states densely from state0 (usually POLL), shallowest first
+            for (int state = 0; ; state++) {
+                std::filesystem::path dir = cpu / "cpuidle" / ("state" + std::to_string(state));
+                if (!std::filesystem::exists(dir)) break;
+                std::ifstream in(dir / "name");
+                std::string name;
+                std::getline(in, name);
+                if (name.empty()) name = "state" + std::to_string(state);
+                std::replace(name.begin(), name.end(), ' ', '-');
+                add_core_counter(CoreIdleResidency, *id, dir / "time", name + "_residency", name + " Residency %");
+            }
+        }
+        if (args.core_stats & (1u << CoreThrottling)) {
+            // Package counts repeat on every core of the package
+            add_core_counter(CoreThrottling, *id, cpu / "thermal_throttle" / "core_throttle_count", "core_throttles", "Core Throttle Events");
+            add_core_counter(CoreThrottling, *id, cpu / "thermal_throttle" / "package_throttle_count", "package_throttles", "Package Throttle Events");
+        }
+    }
+    counters_read = poll_clock.now();
+    if (args.debug >= DebugVerbose)
+        args.error_log << "Tracking " << known_core_counters.size() << " per-core idle and throttle counters" << std::endl;
+}
+
+
+#ifdef CPU_PERF_ENABLED
+#define PerfPmuRoot "/sys/bus/event_source/devices"
+
+// Events opened for every CPU, the group leader first
+static struct perf_event_attr perf_attrs[PerfMaxEvents];
+static int perf_events = 0;
+// Without a TSC event, ref-cycles are converted to time with the nominal frequency
+static double perf_nominal_khz = 0;
+
+// Type and config of a PMU event published in sysfs, ie: msr/events/mperf holds "event=0x02"
+static bool perf_pmu_event(const std::string& pmu, const std::string& event, struct perf_event_attr& attr) {
+    std::ifstream type_in(host_path(PerfPmuRoot) + "/" + pmu + "/type"),
+                  event_in(host_path(PerfPmuRoot) + "/" + pmu + "/events/" + event);
+    std::string spec;
+    memset(&attr, 0, sizeof(attr));
+    if (!(type_in >> attr.type) || !std::getline(event_in, spec) || spec.compare(0, 6, "event=") != 0) return false;
+    attr.config = strtoull(spec.c_str() + 6, nullptr, 0);
+    return true;
+}
+
+static void perf_hardware_event(uint64_t config, struct perf_event_attr& attr) {
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+}
+
+// Choose APERF/MPERF/TSC when the msr PMU has them (Intel and AMD), else cycles/ref-cycles with the nominal frequency
+static bool choose_perf_events(void) {
+    if (perf_pmu_event("msr", "aperf", perf_attrs[0]) && perf_pmu_event("msr", "mperf", perf_attrs[1]) && perf_pmu_event("msr", "tsc", perf_attrs[2]))
+        perf_events = 3;
+    else {
+        perf_hardware_event(PERF_COUNT_HW_CPU_CYCLES, perf_attrs[0]);
+        perf_hardware_event(PERF_COUNT_HW_REF_CPU_CYCLES, perf_attrs[1]);
+        perf_events = 2;
+        // intel_pstate publishes the frequency ref-cycles count at
+        std::ifstream base(host_path(CpuSysfsRoot) + "/cpu0/cpufreq/base_frequency");
+        if (!(base >> perf_nominal_khz) || perf_nominal_khz <= 0) {
+            args.error_log << "No msr aperf/mperf/tsc events and no cpufreq base_frequency, so perf counters are not tracked" << std::endl;
+            return false;
+        }
+    }
+    for (int e = 0; e < perf_events; e++) {
+        perf_attrs[e].size = sizeof(struct perf_event_attr);
+        perf_attrs[e].read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Only the leader starts disabled; enabling it starts the whole group at once
+        perf_attrs[e].disabled = (e == 0);
+    }
+    return true;
+}
+
+static void close_perf(perf_cache& candidate) {
+    for (int e = 0; e < PerfMaxEvents; e++)
+        if (candidate.fds[e] >= 0) close(candidate.fds[e]);
+}
+
+// Read a CPU's group with one read(), scaling counts up when the group was multiplexed
+static bool read_perf(perf_cache& cpu, double counts[PerfMaxEvents], uint64_t& enabled) {
+    struct {
+        uint64_t nr, time_enabled, time_running, values[PerfMaxEvents];
+    } group;
+    if (read(cpu.fds[0], &group, sizeof(group)) <= 0 || group.time_running == 0) return false;
+    double scale = static_cast<double>(group.time_enabled) / group.time_running;
+    for (int e = 0; e < perf_events; e++) counts[e] = group.values[e] * scale;
+    enabled = group.time_enabled;
+    return true;
+}
+
+// Open one counter group per core; a single failure (usually perf_event_paranoid) stops the search
+static void cache_perf(void) {
+    if (!choose_perf_events()) return;
+    std::vector<int> ids = counter_core_ids();
+    for (std::vector<int>::iterator id = ids.begin(); id != ids.end(); id++) {
+        perf_cache candidate;
+        candidate.coreid = *id;
+        int e = 0;
+        for (; e < perf_events; e++) {
+            // pid -1 with a CPU counts everything that runs there; close-on-exec keeps these out of the wrapped command
+            candidate.fds[e] = syscall(__NR_perf_event_open, &perf_attrs[e], -1, *id, (e == 0) ? -1 : candidate.fds[0], PERF_FLAG_FD_CLOEXEC);
+            if (candidate.fds[e] < 0) break;
+        }
+        if (e < perf_events) {
+            args.error_log << "Unable to open perf counters on CPU " << *id << ": " << strerror(errno) <<
+                              ((errno == EACCES || errno == EPERM) ? " (system-wide counters need root, CAP_PERFMON or kernel.perf_event_paranoid <= 0)" : "") << std::endl;
+            close_perf(candidate);
+            break;
+        }
+        ioctl(candidate.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        read_perf(candidate, candidate.last, candidate.last_enabled);
+        std::string core = std::to_string(*id);
+        candidate.channels[0] = samples.add_channel("core_" + core + "_effective_freq",
+                                                    "core-" + core + "-effective-frequency",
+                                                    "Core " + core + " Effective Frequency");
+        candidate.channels[1] = samples.add_channel("core_" + core + "_busy",
+                                                    "core-" + core + "-busy",
+                                                    "Core " + core + " Busy Ratio");
+        known_perf.push_back(candidate);
+    }
+    if (args.debug >= DebugVerbose)
+        args.error_log << "Tracking perf counters (" << ((perf_events == 3) ? "aperf/mperf/tsc" : "cycles/ref-cycles") << ") on " << known_perf.size() << " cores" << std::endl;
+}
+#endif
+
+
+// Per-core values aggregated over topology groups, refreshed from the caches above every poll
+static std::vector<double> core_freqs, core_busy, socket_temps; // known_freqs order, known_utils order without the all-cores entry, temp_readings order
+static std::vector<const cpu_reading*> temp_readings; // Temperatures of chips that report on a single socket
+typedef struct aggregate_stat_t {
+    const char* field; // Channel name component
+    const char* json;
+    const char* human;
+} aggregate_stat;
+static const aggregate_stat aggregate_stats[3] = {
+    {"freq", "frequency", "Frequency"},
+    {"util", "utilization", "Utilization %"},
+    {"temperature", "temperature", "Temperature"},
+};
+static const char* const aggregate_fields[3] = {"mean", "min", "max"},
+                 * const aggregate_names[3] = {"Mean", "Min", "Max"};
+
+// Group prefix with a different separator or in words, ie: socket_0_die_1 -> socket-0-die-1 or Socket 0 Die 1
+static std::string group_name(std::string group, char separator, bool words) {
+    for (size_t c = 0; c < group.size(); c++) {
+        if (group[c] == '_') group[c] = separator;
+        else if (words && (c == 0 || group[c-1] == '_' || group[c-1] == separator)) group[c] = toupper(group[c]);
+    }
+    return group;
+}
+
+static void add_aggregate(int stat, const std::string& group, const std::vector<double>& source, const std::vector<size_t>& members) {
+    if (members.empty()) return;
+    aggregate_cache candidate;
+    candidate.source = &source;
+    candidate.members = members;
+    candidate.gathered.resize(members.size());
+    for (int a = 0; a < 3; a++)
+        candidate.channels[a] = samples.add_channel(group + "_" + aggregate_stats[stat].field + "_" + aggregate_fields[a],
+                                                    group_name(group, '-', false) + "-" + aggregate_stats[stat].json + "-" + aggregate_fields[a],
+                                                    group_name(group, ' ', true) + " " + aggregate_stats[stat].human + " " + aggregate_names[a]);
+    known_aggregates.push_back(candidate);
+}
+
+// Register mean/min/max channels of frequency and utilization per group at each requested level,
+// and of temperature per socket for chips that name their socket
+static void cache_aggregates(void) {
+    unsigned levels = args.aggregate_levels;
+    if (levels == 0) levels = TopologyDefaultLevels;
+    std::vector<core_topology> cores = read_topology(counter_core_ids());
+    std::map<int, const core_topology*> topology_of;
+    for (std::vector<core_topology>::iterator core = cores.begin(); core != cores.end(); core++) topology_of[core->coreid] = &*core;
+
+    for (std::vector<freq_cache>::iterator i = known_freqs.begin(); i != known_freqs.end(); i++) core_freqs.push_back(i->hz);
+    for (size_t k = 1; k < known_utils.size(); k++) core_busy.push_back(0);
+    for (std::vector<cpu_cache>::iterator i = known_cpus.begin(); i != known_cpus.end(); i++) {
+        int socket = chip_socket(i->chip_name);
+        if (socket < 0) {
+            if (args.debug >= DebugVerbose)
+                args.error_log << "Chip " << i->chip_name << " does not report on a single socket, its temperatures are not aggregated" << std::endl;
+            continue;
+        }
+        for (std::vector<cpu_reading>::iterator r = i->readings.begin(); r != i->readings.end(); r++) {
+            if (r->kind != CpuTemperature) continue;
+            temp_readings.push_back(&*r);
+            socket_temps.push_back(r->value);
+        }
+    }
+
+    for (int level = 0; level < count_TopologyLevels; level++) {
+        if (!(levels & (1u << level))) continue;
+        // Ordered by (socket or node, die) so socket_10 follows socket_9
+        std::map<std::pair<int, int>, std::string> groups;
+        for (std::vector<core_topology>::iterator core = cores.begin(); core != cores.end(); core++)
+            groups[{(level == TopologyNode) ? core->node : core->socket, (level == TopologyDie) ? core->die : 0}] = topology_group(*core, level);
+        for (std::map<std::pair<int, int>, std::string>::iterator group = groups.begin(); group != groups.end(); group++) {
+            std::vector<size_t> freq_members, util_members, temp_members;
+            for (size_t k = 0; k < known_freqs.size(); k++)
+                if (topology_of.count(known_freqs[k].coreid) && topology_group(*topology_of[known_freqs[k].coreid], level) == group->second) freq_members.push_back(k);
+            for (size_t k = 1; k < known_utils.size(); k++)
+                if (topology_of.count(known_utils[k].coreid) && topology_group(*topology_of[known_utils[k].coreid], level) == group->second) util_members.push_back(k - 1);
+            // Temperature chips resolve to a socket, not to dies or nodes
+            if (level == TopologySocket) {
+                size_t k = 0;
+                for (std::vector<cpu_cache>::iterator i = known_cpus.begin(); i != known_cpus.end(); i++) {
+                    if (chip_socket(i->chip_name) < 0) continue;
+                    for (std::vector<cpu_reading>::iterator r = i->readings.begin(); r != i->readings.end(); r++) {
+                        if (r->kind != CpuTemperature) continue;
+                        if (chip_socket(i->chip_name) == group->first.first) temp_members.push_back(k);
+                        k++;
+                    }
+                }
+            }
+            add_aggregate(0, group->second, core_freqs, freq_members);
+            add_aggregate(1, group->second, core_busy, util_members);
+            add_aggregate(2, group->second, socket_temps, temp_members);
+        }
+        if (args.debug >= DebugVerbose)
+            args.error_log << "Aggregating per-core statistics over " << groups.size() << " " << topology_level_types[level].name << " groups" << std::endl;
+    }
+}
+
+
+void cache_cpus(void) {
+    // No caching if we aren't going to query the CPUs
+    if (!args.cpu) return;
+
+    #ifdef CPU_LIBSENSORS_ENABLED
+    if (!args.hwmon) cache_libsensors_features();
+    else
+    #endif
+    cache_hwmon_features();
+
+    if (args.core_stats & (1u << CoreFrequency)) cache_frequencies();
+    if (args.core_stats & (1u << CoreUtilization)) cache_utilization();
+    if (args.core_stats & ((1u << CoreIdleResidency) | (1u << CoreThrottling))) cache_core_counters();
+    #ifdef CPU_PERF_ENABLED
+    if (args.core_stats & (1u << CorePerfCounters)) cache_perf();
+    #else
+    if (args.core_stats & (1u << CorePerfCounters))
+        args.error_log << "Built without perf_event support, perf counters are not tracked" << std::endl;
+    #endif
+    if (args.aggregate_levels || args.aggregate_only) cache_aggregates();
     if (args.debug >= DebugMinimal)
         args.error_log << "Tracking " << cpus_to_satisfy << " CPU temperature sensors" << std::endl;
 }
 
 
+// Ticks spent in a category; per-core iowait may step backwards, which counts as none
+static inline uint64_t tick_delta(uint64_t prev, uint64_t now) {
+    return (now > prev) ? now - prev : 0;
+}
+
+static void update_utilization(void) {
+    ssize_t nbytes = pread(proc_stat_fd, proc_stat_buf.data(), proc_stat_buf.size(), 0);
+    if (nbytes <= 0) {
+        if (args.debug >= DebugMinimal) args.error_log << "Unable to update CPU utilization" << std::endl;
+        return;
+    }
+    parse_proc_stat(proc_stat_buf.data(), nbytes, util_slot_of.data(), util_slot_of.size(), util_times.data());
+    for (size_t k = 0; k < known_utils.size(); k++) {
+        util_cache& u = known_utils[k];
+        const proc_stat_times& now = util_times[k];
+        // Polls faster than the tick rate (or offline cores) keep the previous interval's shares
+        if (now.total > u.last.total) {
+            double scale = 100. / (now.total - u.last.total);
+            u.percent[0] = tick_delta(u.last.user, now.user) * scale;
+            u.percent[1] = tick_delta(u.last.system, now.system) * scale;
+            u.percent[2] = tick_delta(u.last.idle, now.idle) * scale;
+            u.percent[3] = tick_delta(u.last.iowait, now.iowait) * scale;
+            u.last = now;
+        }
+        if (u.channels[0] >= 0)
+            for (int f = 0; f < 4; f++) samples.set(u.channels[f], u.percent[f]);
+    }
+}
+
+
+// Counters were read by sysfs_reads at the start of this poll
+static void update_core_counters(void) {
+    PollClock::time_point now = sysfs_reads.last_read();
+    double interval_us = std::chrono::duration_cast<std::chrono::nanoseconds>(now - counters_read).count() / 1e3;
+    counters_read = now;
+    for (std::vector<counter_cache>::iterator i = known_core_counters.begin(); i != known_core_counters.end(); i++) {
+        if (sysfs_reads.length(i->slot) <= 0) {
+            if (args.debug >= DebugMinimal)
+                args.error_log << "Unable to update " << core_stat_types[i->kind].name << " counter for CPU " << i->coreid << std::endl;
+            continue;
+        }
+        uint64_t value = sysfs_reads.value(i->slot),
+                 change = (value >= i->last) ? value - i->last : 0;
+        if (i->kind == CoreIdleResidency) i->delta = (interval_us > 0) ? 100. * change / interval_us : 0;
+        else i->delta = change;
+        i->last = value;
+        samples.set(i->channel, i->delta);
+    }
+}
+
+
+#ifdef CPU_PERF_ENABLED
+// One read() per CPU; APERF:MPERF (or cycles:ref-cycles) is the unhalted frequency relative to the TSC rate,
+// and MPERF:TSC (or ref-cycles over the nominal rate) the share of the interval the core was not halted
+static void update_perf(void) {
+    double counts[PerfMaxEvents];
+    uint64_t enabled;
+    for (std::vector<perf_cache>::iterator i = known_perf.begin(); i != known_perf.end(); i++) {
+        if (!read_perf(*i, counts, enabled)) {
+            if (args.debug >= DebugMinimal) args.error_log << "Unable to read perf counters for CPU " << i->coreid << std::endl;
+            continue;
+        }
+        double elapsed_ns = enabled - i->last_enabled,
+               actual = counts[0] - i->last[0],
+               reference = counts[1] - i->last[1],
+               // Reference ticks a never-halted core would have counted
+               possible = (perf_events == 3) ? counts[2] - i->last[2] : perf_nominal_khz * elapsed_ns / 1e6;
+        if (elapsed_ns > 0 && possible > 0) {
+            i->busy = reference / possible;
+            // A core that never left idle keeps its previous frequency
+            if (reference > 0) i->effective_khz = possible * 1e6 / elapsed_ns * actual / reference;
+        }
+        for (int e = 0; e < perf_events; e++) i->last[e] = counts[e];
+        i->last_enabled = enabled;
+        samples.set(i->channels[0], i->effective_khz);
+        samples.set(i->channels[1], i->busy);
+    }
+}
+#endif
+
+
+// Refresh the per-core values, then reduce each group's contiguous copy of its members
+static void update_aggregates(void) {
+    for (size_t k = 0; k < known_freqs.size(); k++) core_freqs[k] = known_freqs[k].hz;
+    // Busy share of each core: everything but idle and iowait
+    for (size_t k = 1; k < known_utils.size(); k++) core_busy[k - 1] = known_utils[k].percent[0] + known_utils[k].percent[1];
+    for (size_t k = 0; k < temp_readings.size(); k++) socket_temps[k] = temp_readings[k]->value;
+    double values[3];
+    for (std::vector<aggregate_cache>::iterator i = known_aggregates.begin(); i != known_aggregates.end(); i++) {
+        for (size_t m = 0; m < i->members.size(); m++) i->gathered[m] = (*i->source)[i->members[m]];
+        aggregate_values(i->gathered.data(), i->gathered.size(), values[0], values[1], values[2]);
+        for (int a = 0; a < 3; a++) samples.set(i->channels[a], values[a]);
+    }
+}
+
+
 int update_cpus(void) {
     if (args.debug >= DebugVerbose) args.error_log << "Update CPUs" << std::endl;
-    // Temperature updates
+    // Feature updates; only temperatures count towards returning to initial conditions
     int at_below_initial_temperature = 0;
     for (std::vector<cpu_cache>::iterator i = known_cpus.begin(); i != known_cpus.end(); i++) {
-        for (int j = 0; j < i->temperature.size(); j++) {
-            double prev = i->temperature[j];
-            if (args.debug >= DebugVerbose) {
-                switch (args.format) {
-                    case OutputHuman:
-                        args.log << "Chip " << i->chip_name << " temp BEFORE " << prev << std::endl;
-                    case OutputCSV:
-                    case OutputJSON:
-                        break;
-                }
-            }
-            sensors_get_value(i->name, i->subfeatures[j]->number, &i->temperature[j]);
-            if (i->temperature[j] <= i->initial_temperature[j]) at_below_initial_temperature++;
-            if (args.debug >= DebugVerbose || update) {
-                switch (args.format) {
-                    case OutputCSV:
-                        args.log << "," << i->temperature[j];
-                        break;
-                    case OutputHuman:
-                        args.log << " temp NOW " << i->temperature[j] << std::endl;
-                        break;
-                    case OutputJSON:
-                        args.log << "\t\"cpu-" << i->chip_name << "-temperature-" << j << "\": " << i->temperature[j] << "," << std::endl;
-                        break;
-                }
-            }
+        for (std::vector<cpu_reading>::iterator r = i->readings.begin(); r != i->readings.end(); r++) {
+            double prev = r->value;
+            #ifdef CPU_LIBSENSORS_ENABLED
+            if (r->slot < 0) sensors_get_value(i->name, r->subfeature->number, &r->value);
+            else
+            #endif
+            // hwmon files were read by sysfs_reads at the start of this poll
+            if (sysfs_reads.length(r->slot) > 0)
+                r->value = apply_hwmon_compute(r->compute, sysfs_reads.signed_value(r->slot) / cpu_feature_types[r->kind].scale);
+            if (r->kind == CpuTemperature && r->value <= r->initial) at_below_initial_temperature++;
+            if (args.debug >= DebugVerbose)
+                args.error_log << "Chip " << i->chip_name << " " << cpu_feature_types[r->kind].field << " BEFORE " << prev << " NOW " << r->value << std::endl;
+            samples.set(r->channel, r->value);
         }
     }
-    // Frequency updates
-    char buf[NAME_BUFFER_SIZE] = {0};
+    // Frequency updates, read by sysfs_reads at the start of this poll
     for (std::vector<freq_cache>::iterator i = known_freqs.begin(); i != known_freqs.end(); i++) {
-        rewind(i->fhandle);
-        int nbytes = fread(buf, sizeof(char), NAME_BUFFER_SIZE, i->fhandle);
-        if (nbytes <= 0 && args.debug >= DebugMinimal)
+        if (sysfs_reads.length(i->slot) > 0) i->hz = sysfs_reads.value(i->slot);
+        else if (args.debug >= DebugMinimal)
             args.error_log << "Unable to update frequency for CPU " << i->coreid << std::endl;
-        else i->hz = std::stoi(buf);
-        if (args.debug >= DebugVerbose || update) {
-            switch (args.format) {
-                case OutputCSV:
-                    args.log << "," << i->hz;
-                    break;
-                case OutputHuman:
-                    args.log << "Core " << i->coreid << " Frequency: " << i->hz << std::endl;
-                    break;
-                case OutputJSON:
-                    args.log << "\t\"core-" << i->coreid << "-frequency\": " << i->hz << "," << std::endl;
-                    break;
-            }
-        }
+        if (i->channel >= 0) samples.set(i->channel, i->hz);
     }
+    if (proc_stat_fd >= 0) update_utilization();
+    update_core_counters();
+    #ifdef CPU_PERF_ENABLED
+    update_perf();
+    #endif
+    // The per-core copies behind the aggregates are only sized by cache_aggregates() (-A | -O)
+    if (!known_aggregates.empty()) update_aggregates();
     return at_below_initial_temperature;
 }
 
@@ -165,4 +672,8 @@ int update_cpus(void) {
 std::vector<cpu_cache> known_cpus;
 int cpus_to_satisfy = 0;
 std::vector<freq_cache> known_freqs;
+std::vector<util_cache> known_utils;
+std::vector<counter_cache> known_core_counters;
+std::vector<perf_cache> known_perf;
+std::vector<aggregate_cache> known_aggregates;
 
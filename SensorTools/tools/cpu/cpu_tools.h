@@ -1,37 +1,111 @@
 // Headers and why they're included
 // Document necessary compiler flags beside each header as needed in full-line comment below the header
+#ifdef CPU_LIBSENSORS_ENABLED
 #include <sensors/sensors.h> // sensor types and API
 // Must compile with: -lsensors
 // May require installing libsensors-devel or equivalent
+#endif
+#ifdef CPU_PERF_ENABLED
+#include <linux/perf_event.h> // perf_event_attr, event types and read formats
+#include <sys/syscall.h> // __NR_perf_event_open
+#include <sys/ioctl.h> // PERF_EVENT_IOC_ENABLE
+#include <cerrno> // errno for open failures
+#endif
 #include <vector> // vector type and operations
-#include <cstdio> // FILE type, fopen(), fread(), rewind(), fclose()
-#include <cstring> // memset()
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include <cstring> // memset(), strncmp(), strerror()
+#include <algorithm> // std::max
 #include <string> // string data type
+#include <fstream> // cpuidle state names
+#include <chrono> // Poll intervals for residency shares
+#include <map> // Topology groups in order
 #include <filesystem> // filesystem types
 // May require on some systems: -lstdc++fs
 #include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/sysfs_parse.h" // Branch-free sysfs integer parsing
+#include "io/sysfs_reader.h" // Batched per-poll reads of cached files
+#include "hwmon.h" // Direct hwmon discovery that names chips as libsensors does
+#include "core_stats.h" // Per-core statistic selection, /proc/stat parsing
+#include "topology.h" // Socket, die and NUMA node of each core for aggregates
 // End Headers
 
 
 // Class and Type declarations
+// One polled input of a chip
+typedef struct cpu_reading_t {
+    int kind = CpuTemperature; // CpuFeatureKinds
+    double value = 0, initial = 0; // In the kind's unit (cpu_feature_types); initial only matters for temperatures
+    int channel = -1; // Sample channel
+    #ifdef CPU_LIBSENSORS_ENABLED
+    const sensors_subfeature* subfeature = nullptr;
+    #endif
+    // hwmon backend: sysfs_reads slot, and any sensors.conf compute statement to apply
+    int slot = -1;
+    std::vector<hwmon_op> compute;
+} cpu_reading;
+
+// Chips come from libsensors or, with -H | --hwmon (or when built without libsensors), straight from hwmon
 typedef struct cpu_cache_t {
     // IDs
     char chip_name[NAME_BUFFER_SIZE] = {0};
     int nr = 0;
+    #ifdef CPU_LIBSENSORS_ENABLED
     const sensors_chip_name* name = nullptr;
-    // Cached data
-    std::vector<const sensors_feature*> features;
-    std::vector<const sensors_subfeature*> subfeatures;
-    std::vector<double> temperature;
-    std::vector<double> initial_temperature;
+    #endif
+    // Cached data, ordered as libsensors reports features: by kind, then feature number
+    std::vector<cpu_reading> readings;
 } cpu_cache;
 
 
-// Combination of cached file pointer and last-read frequency value
+// Combination of cached file descriptor and last-read frequency value
+// The fd is registered with sysfs_reads, which re-reads every core in one batch before update_cpus() parses it
 typedef struct cpu_freq_cache_t {
-    FILE * fhandle;
+    int fd, slot; // slot: index in sysfs_reads
     int coreid, hz;
+    int channel; // Sample channel
 } freq_cache;
+
+// Share of CPU time in each category over the last poll interval, from one read of /proc/stat per poll
+// Cores are those of known_freqs when frequencies are tracked, so both use the same core IDs
+typedef struct cpu_util_cache_t {
+    int coreid; // -1 for the aggregate over all cores
+    proc_stat_times last; // Ticks at the previous poll
+    double percent[4] = {0}; // user, system, idle, iowait
+    int channels[4]; // Sample channels, in the same order
+} util_cache;
+
+// A cumulative per-core counter (cpuidle state residency or thermal throttle count), reported as its change over each poll
+// The fd is registered with sysfs_reads like the frequency cache
+typedef struct cpu_counter_cache_t {
+    int kind; // CoreIdleResidency (microseconds) or CoreThrottling (events)
+    int coreid;
+    int fd, slot; // slot: index in sysfs_reads
+    uint64_t last; // Counter value at the previous poll
+    double delta = 0; // Residency as % of the poll interval, throttle events as a count
+    int channel; // Sample channel
+} counter_cache;
+
+// Hardware counters of one CPU, opened as a group so a single read() returns every count with its enabled/running times
+// Events are APERF, MPERF and TSC from the msr PMU when available, otherwise cycles and ref-cycles
+#define PerfMaxEvents 3
+typedef struct cpu_perf_cache_t {
+    int coreid;
+    int fds[PerfMaxEvents] = {-1, -1, -1}; // fds[0] leads the group
+    double last[PerfMaxEvents] = {0}; // Counts at the previous poll, scaled up for any multiplexing
+    uint64_t last_enabled = 0; // Nanoseconds the group had been enabled at the previous poll
+    double effective_khz = 0, busy = 0; // Average frequency while not halted, and the share of the interval not halted
+    int channels[2]; // Sample channels, in the same order
+} perf_cache;
+
+// Mean, minimum and maximum of one statistic over the cores (or, for temperatures, the sensors) of a socket, die or NUMA node
+// Members are gathered from the per-core values into a contiguous buffer each poll so the reduction vectorizes
+typedef struct cpu_aggregate_cache_t {
+    const std::vector<double>* source; // Per-core values, refreshed from the other caches every poll
+    std::vector<size_t> members; // Indices into *source
+    std::vector<double> gathered; // Members' values for this poll, in member order
+    int channels[3]; // Sample channels: mean, min, max
+} aggregate_cache;
 // End Class and Type declarations
 
 
@@ -46,5 +120,9 @@ int update_cpus(void);
 extern std::vector<cpu_cache> known_cpus;
 extern int cpus_to_satisfy;
 extern std::vector<freq_cache> known_freqs;
+extern std::vector<util_cache> known_utils;
+extern std::vector<counter_cache> known_core_counters;
+extern std::vector<perf_cache> known_perf;
+extern std::vector<aggregate_cache> known_aggregates;
 // End External variable declarations
 
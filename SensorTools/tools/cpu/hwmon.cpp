@@ -0,0 +1,330 @@
+#include "hwmon.h"
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <fstream> // Reading name attributes and sensors.conf
+#include <algorithm> // std::sort
+#include <cstdio> // sscanf(), snprintf()
+#include <cstdlib> // strtod()
+#include <cmath> // exp(), log()
+#include <cctype> // isdigit(), isspace()
+#include <cstring> // strcmp()
+#include <sstream> // Splitting feature lists
+#include <fnmatch.h> // Chip patterns in sensors.conf
+// End Headers
+
+#define HwmonComputeDepth 16 // Deepest evaluation stack a compute expression may need
+#define HwmonChipNameSize 256
+
+// Class and Type declarations
+// Statements from one `chip` block of sensors.conf that affect which inputs are read and how
+typedef struct conf_chip_t {
+    std::vector<std::string> patterns;
+    std::vector<std::pair<std::string, std::vector<hwmon_op>>> computes;
+    std::vector<std::string> ignores;
+} conf_chip;
+// End Class and Type declarations
+
+static std::string read_first_line(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Split one logical sensors.conf line into tokens: quoted strings (quotes removed), words/numbers, single-character operators
+static std::vector<std::string> tokenize_conf(const std::string& line) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < line.size()) {
+        char c = line[i];
+        if (isspace(static_cast<unsigned char>(c))) i++;
+        else if (c == '#') break;
+        else if (c == '"') {
+            size_t end = line.find('"', i + 1);
+            if (end == std::string::npos) end = line.size();
+            tokens.push_back(line.substr(i + 1, end - i - 1));
+            i = end + 1;
+        }
+        else if (isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.') {
+            size_t end = i;
+            while (end < line.size() && (isalnum(static_cast<unsigned char>(line[end])) || line[end] == '_' || line[end] == '.')) end++;
+            tokens.push_back(line.substr(i, end - i));
+            i = end;
+        }
+        else tokens.push_back(std::string(1, line[i++]));
+    }
+    return tokens;
+}
+
+// Recursive descent over libsensors' expression grammar, emitting postfix
+// Precedence (loosest first): + -, * /, unary - ^ `
+class ComputeCompiler {
+    public:
+        ComputeCompiler(const std::vector<std::string>& tokens, size_t start) : tokens(tokens), pos(start) {}
+        bool compile(std::vector<hwmon_op>& out) {
+            ops.clear();
+            if (!expression()) return false;
+            // The read expression ends at the comma that starts the write expression
+            if (pos < tokens.size() && tokens[pos] != ",") return false;
+            int depth = 0, deepest = 0;
+            for (std::vector<hwmon_op>::iterator i = ops.begin(); i != ops.end(); i++) {
+                if (i->op == 'n' || i->op == '@') depth++;
+                else if (i->op == '+' || i->op == '-' || i->op == '*' || i->op == '/') depth--;
+                deepest = std::max(deepest, depth);
+            }
+            if (deepest > HwmonComputeDepth) return false;
+            out = ops;
+            return true;
+        }
+    private:
+        const std::vector<std::string>& tokens;
+        size_t pos;
+        std::vector<hwmon_op> ops;
+        bool peek(const char* token) { return pos < tokens.size() && tokens[pos] == token; }
+        bool expression(void) {
+            if (!term()) return false;
+            while (peek("+") || peek("-")) {
+                char op = tokens[pos++][0];
+                if (!term()) return false;
+                ops.push_back({op});
+            }
+            return true;
+        }
+        bool term(void) {
+            if (!unary()) return false;
+            while (peek("*") || peek("/")) {
+                char op = tokens[pos++][0];
+                if (!unary()) return false;
+                ops.push_back({op});
+            }
+            return true;
+        }
+        bool unary(void) {
+            if (peek("-") || peek("^") || peek("`")) {
+                char op = tokens[pos++][0];
+                if (!unary()) return false;
+                ops.push_back({op == '-' ? '~' : op});
+                return true;
+            }
+            return primary();
+        }
+        bool primary(void) {
+            if (pos >= tokens.size()) return false;
+            const std::string& token = tokens[pos++];
+            if (token == "@") ops.push_back({'@'});
+            else if (token == "(") {
+                if (!expression() || !peek(")")) return false;
+                pos++;
+            }
+            else if (isdigit(static_cast<unsigned char>(token[0])) || token[0] == '.') {
+                char* end;
+                double value = strtod(token.c_str(), &end);
+                if (*end != '\0') return false;
+                ops.push_back({'n', value});
+            }
+            // References to other features' values are not supported
+            else return false;
+            return true;
+        }
+};
+
+// Every config libsensors reads by default: sensors3.conf (or the older sensors.conf), then /etc/sensors.d in name order
+static std::vector<conf_chip> load_sensors_conf(std::ostream& error_log, short debug) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    if (std::filesystem::exists("/etc/sensors3.conf", ec)) files.push_back("/etc/sensors3.conf");
+    else if (std::filesystem::exists("/etc/sensors.conf", ec)) files.push_back("/etc/sensors.conf");
+    std::vector<std::filesystem::path> extra;
+    for (std::filesystem::directory_iterator i("/etc/sensors.d", ec), end; !ec && i != end; i.increment(ec))
+        if (i->is_regular_file(ec) && i->path().filename().string()[0] != '.') extra.push_back(i->path());
+    std::sort(extra.begin(), extra.end());
+    files.insert(files.end(), extra.begin(), extra.end());
+
+    std::vector<conf_chip> chips;
+    for (std::vector<std::filesystem::path>::iterator f = files.begin(); f != files.end(); f++) {
+        std::ifstream in(*f);
+        std::string line, logical;
+        while (std::getline(in, line)) {
+            // Backslash-newline continues a statement
+            if (!line.empty() && line.back() == '\\') {
+                logical += line.substr(0, line.size() - 1) + " ";
+                continue;
+            }
+            logical += line;
+            std::vector<std::string> tokens = tokenize_conf(logical);
+            logical.clear();
+            if (tokens.empty()) continue;
+            if (tokens[0] == "chip") {
+                chips.push_back(conf_chip());
+                chips.back().patterns.assign(tokens.begin() + 1, tokens.end());
+            }
+            else if (chips.empty() || tokens.size() < 2) continue;
+            else if (tokens[0] == "ignore") chips.back().ignores.push_back(tokens[1]);
+            else if (tokens[0] == "compute") {
+                std::vector<hwmon_op> compute;
+                if (ComputeCompiler(tokens, 2).compile(compute))
+                    chips.back().computes.push_back(std::make_pair(tokens[1], compute));
+                else if (debug >= DebugMinimal)
+                    error_log << "Unsupported compute statement for " << tokens[1] << " in " << *f << ", values will be read unconverted" << std::endl;
+            }
+        }
+    }
+    return chips;
+}
+
+// sensors_snprintf_chip_name() for a hwmon device, following libsensors' bus detection in sysfs.c
+static bool hwmon_chip_name(const std::filesystem::path& sysfs_mount, const std::filesystem::path& hwmon_dir,
+                            const std::string& prefix, std::string& name) {
+    char buf[HwmonChipNameSize];
+    std::error_code ec;
+    std::filesystem::path device = hwmon_dir / "device";
+    if (!std::filesystem::exists(device, ec)) {
+        // Virtual devices are assumed unique
+        snprintf(buf, sizeof(buf), "%s-virtual-0", prefix.c_str());
+        name = buf;
+        return true;
+    }
+    std::string dev_name = std::filesystem::canonical(device, ec).filename().string(),
+                subsys = std::filesystem::exists(device / "subsystem", ec) ?
+                         std::filesystem::canonical(device / "subsystem", ec).filename().string() : "";
+    const char* dev = dev_name.c_str();
+    short bus_nr;
+    int addr, domain, bus, slot, fn, vendor, product;
+    if ((subsys.empty() || subsys == "i2c") && sscanf(dev, "%hd-%x", &bus_nr, &addr) == 2) {
+        // Legacy ISA drivers registered on pseudo i2c bus 9191, or on an adapter whose name marks it as ISA
+        std::string adapter = read_first_line(sysfs_mount / "class" / "i2c-adapter" / ("i2c-" + std::to_string(bus_nr)) / "device" / "name");
+        if (bus_nr == 9191 || adapter.compare(0, 4, "ISA ") == 0) snprintf(buf, sizeof(buf), "%s-isa-%04x", prefix.c_str(), addr);
+        else snprintf(buf, sizeof(buf), "%s-i2c-%hd-%02x", prefix.c_str(), bus_nr, addr);
+    }
+    else if ((subsys.empty() || subsys == "spi") && sscanf(dev, "spi%hd.%d", &bus_nr, &addr) == 2)
+        snprintf(buf, sizeof(buf), "%s-spi-%hd-%x", prefix.c_str(), bus_nr, addr);
+    else if ((subsys.empty() || subsys == "pci") && sscanf(dev, "%x:%x:%x.%x", &domain, &bus, &slot, &fn) == 4)
+        snprintf(buf, sizeof(buf), "%s-pci-%04x", prefix.c_str(), (domain << 16) + (bus << 8) + (slot << 3) + fn);
+    else if (subsys.empty() || subsys == "platform" || subsys == "of_platform") {
+        // Platform drivers are the new ISA
+        if (sscanf(dev, "%*[a-z0-9_].%d", &addr) != 1) addr = 0;
+        snprintf(buf, sizeof(buf), "%s-isa-%04x", prefix.c_str(), addr);
+    }
+    else if (subsys == "acpi") snprintf(buf, sizeof(buf), "%s-acpi-0", prefix.c_str());
+    else if (subsys == "hid" && sscanf(dev, "%x:%x:%x.%x", &bus, &vendor, &product, &addr) == 4)
+        snprintf(buf, sizeof(buf), "%s-hid-%hd-%x", prefix.c_str(), static_cast<short>(bus), addr);
+    else if (subsys == "mdio_bus") {
+        if (sscanf(dev, "%*[^:]:%d", &addr) != 1) addr = 0;
+        snprintf(buf, sizeof(buf), "%s-mdio-%x", prefix.c_str(), addr);
+    }
+    else if (subsys == "scsi" && sscanf(dev, "%hd:%*d:%d:%*d", &bus_nr, &addr) == 2)
+        snprintf(buf, sizeof(buf), "%s-scsi-%hd-%x", prefix.c_str(), bus_nr, addr);
+    // libsensors ignores devices on any other bus
+    else return false;
+    name = buf;
+    return true;
+}
+
+std::vector<hwmon_chip> scan_hwmon(const std::filesystem::path& root, unsigned features, std::ostream& error_log, short debug) {
+    std::vector<hwmon_chip> chips;
+    std::vector<conf_chip> config = load_sensors_conf(error_log, debug);
+    std::filesystem::path sysfs_mount = root.parent_path().parent_path();
+    std::error_code ec;
+    // Directory order, as libsensors walks the class directory without sorting
+    for (std::filesystem::directory_iterator i(root, ec), end; !ec && i != end; i.increment(ec)) {
+        hwmon_chip chip;
+        // Older drivers keep their attributes on the parent device rather than the hwmon class device
+        if (std::filesystem::exists(i->path() / "name", ec)) chip.dir = i->path();
+        else if (std::filesystem::exists(i->path() / "device" / "name", ec)) chip.dir = i->path() / "device";
+        else continue;
+        std::string prefix = read_first_line(chip.dir / "name");
+        if (prefix.empty() || !hwmon_chip_name(sysfs_mount, i->path(), prefix, chip.name)) {
+            if (debug >= DebugVerbose) error_log << "Skipping hwmon device " << i->path() << " on an unsupported bus" << std::endl;
+            continue;
+        }
+        // Statements from every matching chip block, later ones taking precedence as in libsensors
+        std::vector<std::string> ignores;
+        std::vector<std::pair<std::string, std::vector<hwmon_op>>> computes;
+        for (std::vector<conf_chip>::iterator c = config.begin(); c != config.end(); c++)
+            for (std::vector<std::string>::iterator p = c->patterns.begin(); p != c->patterns.end(); p++)
+                if (fnmatch(p->c_str(), chip.name.c_str(), 0) == 0) {
+                    ignores.insert(ignores.end(), c->ignores.begin(), c->ignores.end());
+                    computes.insert(computes.end(), c->computes.begin(), c->computes.end());
+                    break;
+                }
+        // [prefix][N]_input attributes of every enabled kind
+        std::error_code dir_ec;
+        for (std::filesystem::directory_iterator a(chip.dir, dir_ec), a_end; !dir_ec && a != a_end; a.increment(dir_ec)) {
+            std::string attr = a->path().filename().string();
+            for (int kind = 0; kind < count_CpuFeatureKinds; kind++) {
+                if (!(features & (1u << kind))) continue;
+                const std::string prefix = cpu_feature_types[kind].prefix;
+                if (attr.compare(0, prefix.size(), prefix) != 0) continue;
+                int number, consumed = 0;
+                char suffix[16] = {0};
+                if (sscanf(attr.c_str() + prefix.size(), "%d_%15[a-z]%n", &number, suffix, &consumed) != 2 ||
+                    consumed != static_cast<int>(attr.size() - prefix.size())) continue;
+                // Power meters often only report an average; libsensors reads it in place of a missing input
+                bool input = strcmp(suffix, "input") == 0,
+                     average = kind == CpuPower && strcmp(suffix, "average") == 0;
+                if (!input && !average) continue;
+                if (average && std::filesystem::exists(chip.dir / (prefix + std::to_string(number) + "_input"), dir_ec)) continue;
+                hwmon_input candidate;
+                candidate.kind = kind;
+                candidate.feature = prefix + std::to_string(number);
+                candidate.number = number;
+                candidate.path = a->path();
+                if (std::find(ignores.begin(), ignores.end(), candidate.feature) != ignores.end()) continue;
+                for (std::vector<std::pair<std::string, std::vector<hwmon_op>>>::iterator c = computes.begin(); c != computes.end(); c++)
+                    if (c->first == candidate.feature) candidate.compute = c->second;
+                chip.inputs.push_back(candidate);
+            }
+        }
+        std::sort(chip.inputs.begin(), chip.inputs.end(),
+                  [](const hwmon_input& a, const hwmon_input& b) { return (a.kind != b.kind) ? a.kind < b.kind : a.number < b.number; });
+        chips.push_back(chip);
+    }
+    if (ec && debug >= DebugMinimal) error_log << "Unable to scan " << root << ": " << ec.message() << std::endl;
+    return chips;
+}
+
+bool parse_cpu_features(const std::string& list, unsigned& features, std::string& error) {
+    features = 0;
+    std::istringstream in(list);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        if (name == "all") {
+            features = (1u << count_CpuFeatureKinds) - 1;
+            continue;
+        }
+        int kind = 0;
+        while (kind < count_CpuFeatureKinds && name != cpu_feature_types[kind].name) kind++;
+        if (kind == count_CpuFeatureKinds) {
+            error = "Unknown feature type '" + name + "', choose from all";
+            for (kind = 0; kind < count_CpuFeatureKinds; kind++) error += std::string(", ") + cpu_feature_types[kind].name;
+            return false;
+        }
+        features |= 1u << kind;
+    }
+    if (features == 0) {
+        error = "No feature types given";
+        return false;
+    }
+    return true;
+}
+
+double apply_hwmon_compute(const std::vector<hwmon_op>& compute, double raw) {
+    if (compute.empty()) return raw;
+    double stack[HwmonComputeDepth];
+    int top = -1;
+    for (std::vector<hwmon_op>::const_iterator i = compute.begin(); i != compute.end(); i++) {
+        switch (i->op) {
+            case 'n': stack[++top] = i->value; break;
+            case '@': stack[++top] = raw; break;
+            case '+': top--; stack[top] += stack[top+1]; break;
+            case '-': top--; stack[top] -= stack[top+1]; break;
+            case '*': top--; stack[top] *= stack[top+1]; break;
+            case '/': top--; stack[top] /= stack[top+1]; break;
+            case '~': stack[top] = -stack[top]; break;
+            case '^': stack[top] = exp(stack[top]); break;
+            case '`': stack[top] = log(stack[top]); break;
+        }
+    }
+    return stack[0];
+}
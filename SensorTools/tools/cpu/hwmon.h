@@ -0,0 +1,76 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Hwmon
+#define LibSensorTools_Hwmon
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "../../enums.h" // Debug levels, CpuFeatureKinds
+#include <string> // String class and manipulation
+#include <vector> // Chip and input lists
+#include <ostream> // Diagnostics go to the caller's error log
+#include <filesystem> // hwmon directory traversal
+// May require on some systems: -lstdc++fs
+// End Headers
+
+#define HwmonRoot "/sys/class/hwmon"
+#define CpuDefaultFeatures (1u << CpuTemperature) // Feature types read when -T | --cpu-features is not given
+
+// Class and Type declarations
+// One step of a libsensors compute expression in postfix order
+//     'n' push value, '@' push the raw reading, '+' '-' '*' '/' binary operators,
+//     '~' negate, '^' exp(), '`' ln()
+typedef struct hwmon_op_t {
+    char op;
+    double value = 0;
+} hwmon_op;
+
+// One *_input attribute of a chip, as libsensors would present it
+typedef struct hwmon_input_t {
+    int kind = CpuTemperature; // CpuFeatureKinds
+    std::string feature; // libsensors feature name, ie: temp3
+    int number = 0; // The 3 in temp3
+    std::filesystem::path path; // .../temp3_input (power meters without power*_input use power*_average)
+    std::vector<hwmon_op> compute; // Empty unless a sensors.conf compute statement applies
+} hwmon_input;
+
+// One hwmon device, named exactly as sensors_snprintf_chip_name() would name it
+typedef struct hwmon_chip_t {
+    std::string name; // ie: coretemp-isa-0000, k10temp-pci-00c3
+    std::filesystem::path dir; // Directory holding the attributes
+    std::vector<hwmon_input> inputs; // Ordered by kind, then feature number, as libsensors reports them
+} hwmon_chip;
+// How each CpuFeatureKinds value is found, named and scaled
+typedef struct cpu_feature_type_t {
+    const char* name; // As given to -T | --cpu-features
+    const char* prefix; // hwmon attribute / libsensors feature prefix
+    const char* field; // Channel name component
+    const char* unit; // Unit of reported values, after scaling
+    double scale; // hwmon raw units per reported unit
+} cpu_feature_type;
+static const cpu_feature_type cpu_feature_types[count_CpuFeatureKinds] = {
+    {"voltage", "in", "voltage", "V", 1000.}, // millivolts
+    {"fan", "fan", "fan", "RPM", 1.},
+    {"temp", "temp", "temperature", "C", 1000.}, // millidegrees Celsius
+    {"power", "power", "power", "W", 1000000.}, // microwatts
+    {"energy", "energy", "energy", "J", 1000000.}, // microjoules
+    {"current", "curr", "current", "A", 1000.}, // milliamperes
+    {"humidity", "humidity", "humidity", "%RH", 1000.}, // milli-percent
+};
+// End Class and Type declarations
+
+// Function declarations
+// Discover chips under root in the same order and with the same names and feature indices as libsensors,
+// keeping inputs whose kind is set in features (bits of CpuFeatureKinds),
+// dropping features a sensors.conf ignore statement hides and attaching any compute statement that applies
+std::vector<hwmon_chip> scan_hwmon(const std::filesystem::path& root, unsigned features, std::ostream& error_log, short debug);
+// Parse a comma-separated list of cpu_feature_types names (or "all") into bits of CpuFeatureKinds
+bool parse_cpu_features(const std::string& list, unsigned& features, std::string& error);
+// Evaluate a compiled compute expression; an empty expression returns raw unchanged
+double apply_hwmon_compute(const std::vector<hwmon_op>& compute, double raw);
+// End Function declarations
+#endif
+
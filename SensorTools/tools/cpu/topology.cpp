@@ -0,0 +1,112 @@
+#include "topology.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <sstream> // Splitting the level list and cpulists
+#include <fstream> // Topology files
+#include <filesystem> // node* directory traversal
+// May require on some systems: -lstdc++fs
+#include <map> // Core index by core ID
+#include <cstdlib> // atoi(), strtoul()
+#include <cctype> // isdigit()
+#include "core_stats.h" // CpuSysfsRoot
+#include "io/host_paths.h" // host_path()
+// End Headers
+
+bool parse_topology_levels(const std::string& list, unsigned& levels, std::string& error) {
+    levels = 0;
+    std::istringstream in(list);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        if (name == "all") {
+            levels = (1u << count_TopologyLevels) - 1;
+            continue;
+        }
+        int level = 0;
+        while (level < count_TopologyLevels && name != topology_level_types[level].name) level++;
+        if (level == count_TopologyLevels) {
+            error = "Unknown topology level '" + name + "', choose from all";
+            for (level = 0; level < count_TopologyLevels; level++) error += std::string(", ") + topology_level_types[level].name;
+            return false;
+        }
+        levels |= 1u << level;
+    }
+    if (levels == 0) {
+        error = "No topology levels given";
+        return false;
+    }
+    return true;
+}
+
+static int read_topology_int(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    int value = 0;
+    in >> value;
+    return value;
+}
+
+std::vector<core_topology> read_topology(const std::vector<int>& ids) {
+    std::vector<core_topology> cores;
+    std::map<int, size_t> index_of;
+    for (std::vector<int>::const_iterator id = ids.begin(); id != ids.end(); id++) {
+        std::filesystem::path topology = std::filesystem::path(host_path(CpuSysfsRoot)) / ("cpu" + std::to_string(*id)) / "topology";
+        core_topology core;
+        core.coreid = *id;
+        core.socket = read_topology_int(topology / "physical_package_id");
+        core.die = read_topology_int(topology / "die_id");
+        index_of[*id] = cores.size();
+        cores.push_back(core);
+    }
+    // Each nodeN lists its CPUs as ranges, ie: 0-15,32-47
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(host_path(NodeSysfsRoot), ec)) {
+        std::string dir = entry.path().filename().string();
+        if (dir.compare(0, 4, "node") != 0 || dir.size() == 4 || !isdigit(dir[4])) continue;
+        int node = atoi(dir.c_str() + 4);
+        std::ifstream in(entry.path() / "cpulist");
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            int first = atoi(range.c_str()), last = first;
+            size_t dash = range.find('-');
+            if (dash != std::string::npos) last = atoi(range.c_str() + dash + 1);
+            for (int cpu = first; cpu <= last; cpu++)
+                if (index_of.count(cpu)) cores[index_of[cpu]].node = node;
+        }
+    }
+    return cores;
+}
+
+std::string topology_group(const core_topology& core, int level) {
+    switch (level) {
+        case TopologySocket: return "socket_" + std::to_string(core.socket);
+        // die_id is only unique within its package
+        case TopologyDie: return "socket_" + std::to_string(core.socket) + "_die_" + std::to_string(core.die);
+        default: return "node_" + std::to_string(core.node);
+    }
+}
+
+int chip_socket(const std::string& chip_name) {
+    size_t dash = chip_name.rfind('-');
+    if (dash == std::string::npos) return -1;
+    unsigned long address = strtoul(chip_name.c_str() + dash + 1, nullptr, 16);
+    if (chip_name.compare(0, 13, "coretemp-isa-") == 0) return address;
+    if (chip_name.compare(0, 12, "k10temp-pci-") == 0 || chip_name.compare(0, 13, "zenpower-pci-") == 0) {
+        // libsensors' PCI address is (bus << 8) | (device << 3) | function; the data fabric of socket N is device 0x18 + N
+        int device = (address & 0xff) >> 3;
+        return (device >= 0x18 && device < 0x20) ? device - 0x18 : -1;
+    }
+    return -1;
+}
+
+void aggregate_values(const double* values, size_t n, double& mean, double& min, double& max) {
+    double sum = 0, lo = values[0], hi = values[0];
+    #pragma omp simd reduction(+:sum) reduction(min:lo) reduction(max:hi)
+    for (size_t i = 0; i < n; i++) {
+        sum += values[i];
+        lo = (values[i] < lo) ? values[i] : lo;
+        hi = (values[i] > hi) ? values[i] : hi;
+    }
+    mean = sum / n;
+    min = lo;
+    max = hi;
+}
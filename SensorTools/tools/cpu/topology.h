@@ -0,0 +1,52 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_Topology
+#define LibSensorTools_Topology
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "../../enums.h" // TopologyLevels
+#include <string> // String class and manipulation
+#include <vector> // Per-core topology lists
+#include <cstddef> // size_t
+// End Headers
+
+#define NodeSysfsRoot "/sys/devices/system/node"
+#define TopologyDefaultLevels (1u << TopologySocket) // Levels aggregated when only -O | --aggregate-only is given
+
+// Class and Type declarations
+// How each TopologyLevels value is named on the command line, in channel names and in help
+typedef struct topology_level_type_t {
+    const char* name;
+    const char* description;
+} topology_level_type;
+static const topology_level_type topology_level_types[count_TopologyLevels] = {
+    {"socket", "physical_package_id"},
+    {"die", "die_id within each socket"},
+    {"node", "NUMA node from " NodeSysfsRoot},
+};
+
+// Where one core sits; kernels without die_id (before 5.3) or NUMA report 0
+typedef struct core_topology_t {
+    int coreid;
+    int socket = 0, die = 0, node = 0;
+} core_topology;
+// End Class and Type declarations
+
+// Function declarations
+// Parse a comma-separated list of topology_level_types names (or "all") into bits of TopologyLevels
+bool parse_topology_levels(const std::string& list, unsigned& levels, std::string& error);
+// Topology of each core in ids, in the same order, from cpuN/topology and the node*/cpulist files
+std::vector<core_topology> read_topology(const std::vector<int>& ids);
+// Channel name prefix of the group holding a core at a level, ie: socket_0, socket_0_die_1, node_1
+std::string topology_group(const core_topology& core, int level);
+// Socket a CPU temperature chip reports on, from its libsensors name, or -1 when it is not a per-socket chip
+//     coretemp-isa-XXXX is the package; k10temp/zenpower-pci-XXXX sit on PCI device 0x18 + socket
+int chip_socket(const std::string& chip_name);
+// Mean, minimum and maximum of values[0..n), n > 0; vectorized when compiled with -fopenmp-simd
+void aggregate_values(const double* values, size_t n, double& mean, double& min, double& max);
+// End Function declarations
+#endif
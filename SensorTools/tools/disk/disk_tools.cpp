@@ -0,0 +1,126 @@
+#include "disk_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::sort, std::copy
+#ifdef BUILD_NVME
+#include "../nvme/nvme_tools.h" // known_nvme, so NVMe statistics share the temperature channels' indices
+#endif
+// End Headers
+
+// Columns after the device name: reads, merged, sectors read, ms reading, writes, merged, sectors written, ms writing, in flight, ms doing IO
+static const int disk_columns[DiskCounters] = {2, 6, 0, 4, 9};
+static const char* const disk_fields[DiskCounters] = {"read_bytes", "write_bytes", "read_ops", "write_ops", "busy"},
+                 * const disk_json_fields[DiskCounters] = {"read-bytes", "write-bytes", "read-ops", "write-ops", "busy"},
+                 * const disk_names[DiskCounters] = {"Read (bytes/s)", "Write (bytes/s)", "Read (IOs/s)", "Write (IOs/s)", "Busy (%)"};
+// Per-second scale of each counter's change: diskstats sectors are always 512 bytes, busy milliseconds become % of the interval
+static const double disk_scales[DiskCounters] = {512e6, 512e6, 1e6, 1e6, 1e5};
+
+static int diskstats_fd = -1;
+static std::vector<char> diskstats_buf;
+static PollClock::time_point disk_read; // When known_disk was last read
+
+// Counters of one device from a read of /proc/diskstats; false when its line is gone
+static bool disk_counters(const disk_cache& disk, ssize_t nbytes, uint64_t counters[DiskCounters]) {
+    const char* at = procfs_find(diskstats_buf.data(), nbytes, disk.key.c_str());
+    if (at == nullptr) return false;
+    uint64_t columns[10];
+    if (procfs_numbers(at + disk.key.size(), diskstats_buf.data() + nbytes, columns, 10) < 10) return false;
+    for (int c = 0; c < DiskCounters; c++) counters[c] = columns[disk_columns[c]];
+    return true;
+}
+
+#ifdef BUILD_NVME
+// known_nvme index of the controller behind an NVMe namespace, or -1
+static int nvme_index_of(const std::string& device) {
+    std::error_code ec;
+    std::filesystem::path link = std::filesystem::path(host_path("/sys/block")) / device / "device";
+    std::string controller = std::filesystem::read_symlink(link, ec).filename().string();
+    // Multipath namespaces hang off their subsystem; use its lowest-numbered controller
+    if (controller.compare(0, 11, "nvme-subsys") == 0) {
+        controller.clear();
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(link, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() > 4 && name.compare(0, 4, "nvme") == 0 && isdigit(name[4]) && (controller.empty() || name < controller))
+                controller = name;
+        }
+    }
+    for (std::vector<nvme_cache>::iterator i = known_nvme.begin(); i != known_nvme.end(); i++)
+        if (!controller.empty() && i->name == controller) return i->index;
+    return -1;
+}
+#endif
+
+void cache_disk(void) {
+    // No caching if we aren't going to query block devices
+    if (!args.disk) return;
+
+    // Close-on-exec keeps this out of the wrapped command
+    diskstats_fd = open(host_path(DiskstatsPath).c_str(), O_RDONLY | O_CLOEXEC);
+    // Headroom for devices and counter digits added during a long run
+    diskstats_buf.resize((diskstats_fd >= 0) ? procfs_length(diskstats_fd) * 2 + 4096 : 0);
+    ssize_t nbytes = (diskstats_fd >= 0) ? pread(diskstats_fd, diskstats_buf.data(), diskstats_buf.size(), 0) : -1;
+    if (nbytes <= 0) {
+        args.error_log << "Unable to read " << host_path(DiskstatsPath) << ", no longer tracking" << std::endl;
+        if (diskstats_fd >= 0) close(diskstats_fd);
+        diskstats_fd = -1;
+        args.disk = false;
+        return;
+    }
+    // Whole devices are listed in /sys/block; partitions are not, so they are never double counted
+    std::vector<std::string> devices;
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(host_path("/sys/block"), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, 4, "loop") != 0 && name.compare(0, 3, "ram") != 0) devices.push_back(name);
+    }
+    std::sort(devices.begin(), devices.end());
+    for (std::vector<std::string>::iterator device = devices.begin(); device != devices.end(); device++) {
+        disk_cache candidate;
+        candidate.name = *device;
+        candidate.key = *device + " ";
+        if (!disk_counters(candidate, nbytes, candidate.last)) continue;
+        std::string csv = "disk_" + candidate.name, json = "disk-" + candidate.name, human = "Disk " + candidate.name;
+        #ifdef BUILD_NVME
+        // Namespaces of a tracked controller are named after its temperature channels, ie: nvme_0_n1_read_bytes
+        int index = nvme_index_of(*device);
+        size_t ns = device->rfind('n');
+        if (index >= 0 && ns != std::string::npos && ns > 3) {
+            csv = "nvme_" + std::to_string(index) + "_" + device->substr(ns);
+            json = "nvme-" + std::to_string(index) + "-" + device->substr(ns);
+            human = "NVMe " + std::to_string(index) + "_" + device->substr(ns);
+        }
+        #endif
+        for (int c = 0; c < DiskCounters; c++)
+            candidate.channels[c] = samples.add_channel(csv + "_" + disk_fields[c], json + "-" + disk_json_fields[c], human + " " + disk_names[c]);
+        known_disk.push_back(candidate);
+        if (args.debug >= DebugVerbose) args.error_log << "Tracking block device " << candidate.name << " as " << csv << std::endl;
+    }
+    disk_read = poll_clock.now();
+    if (known_disk.empty()) {
+        args.error_log << "No block devices found, no longer tracking" << std::endl;
+        args.disk = false;
+    }
+}
+
+void update_disk(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update block devices" << std::endl;
+    PollClock::time_point now = poll_clock.now();
+    double elapsed_us = std::chrono::duration_cast<std::chrono::nanoseconds>(now - disk_read).count() / 1e3;
+    ssize_t nbytes = pread(diskstats_fd, diskstats_buf.data(), diskstats_buf.size(), 0);
+    if (elapsed_us <= 0 || nbytes <= 0) return;
+    disk_read = now;
+    uint64_t counters[DiskCounters];
+    for (std::vector<disk_cache>::iterator i = known_disk.begin(); i != known_disk.end(); i++) {
+        // Devices removed since caching log no activity
+        if (!disk_counters(*i, nbytes, counters)) std::copy(i->last, i->last + DiskCounters, counters);
+        for (int c = 0; c < DiskCounters; c++) {
+            samples.set(i->channels[c], ((counters[c] > i->last[c]) ? counters[c] - i->last[c] : 0) * disk_scales[c] / elapsed_us);
+            i->last[c] = counters[c];
+        }
+    }
+}
+
+// Definition of external variables for block device tools
+std::vector<disk_cache> known_disk;
+
@@ -0,0 +1,40 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include <filesystem> // /sys/block traversal
+// May require on some systems: -lstdc++fs
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/procfs_parse.h" // Column parsing of /proc/diskstats
+#include "io/poll_clock.h" // Poll intervals for rates
+// End Headers
+
+#define DiskstatsPath "/proc/diskstats"
+#define DiskCounters 5 // sectors read, sectors written, reads, writes, milliseconds doing IO
+
+
+// Class and Type declarations
+// One whole block device's line of /proc/diskstats
+typedef struct disk_cache_t {
+    std::string name; // ie: sda, nvme0n1
+    std::string key; // Line key, ie: "sda "
+    uint64_t last[DiskCounters] = {0}; // Counters at the previous poll
+    int channels[DiskCounters]; // Sample channels: bytes/s, IOs/s and busy % in the same order
+} disk_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_disk(void);
+void update_disk(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<disk_cache> known_disk;
+// End External variable declarations
+
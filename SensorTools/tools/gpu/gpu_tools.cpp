@@ -10,6 +10,23 @@
 */
 #include "gpu_tools.h"
 
+#ifdef GPU_ENABLED
+// Fields logged from each device: CSV name suffix, JSON name suffix, human-readable label
+static const char* gpu_fields[][3] = {
+    {"name", "name", "Name"},
+    {"gpu_temperature", "gpu-temperature", "GPU Temperature"},
+    {"mem_temperature", "memory-temperature", "Memory Temperature"},
+    {"power_usage", "power-usage", "Power Usage"},
+    {"power_limit", "power-limit", "Power Limit"},
+    {"utilization_gpu", "utilization-gpu", "Utilization GPU (%)"},
+    {"utilization_memory", "utilization-memory", "Utilization Memory (%)"},
+    {"memory_used", "memory-used", "Memory Used"},
+    {"memory_total", "memory-total", "Memory Total"},
+    {"pstate", "pstate", "Performance State"},
+};
+#define N_GPU_FIELDS (sizeof(gpu_fields) / sizeof(gpu_fields[0]))
+#endif
+
 #ifdef GPU_ENABLED
 void cache_gpus(void) {
     // No caching if we aren't going to query the GPUs
@@ -39,6 +56,11 @@ void cache_gpus(void) {
         nvmlDeviceGetPerformanceState(candidate.device_Handle, &candidate.pState);
 
         if (args.debug >= DebugVerbose) args.error_log << "Finished caching GPU " << i << std::endl;
+        for (int k = 0; k < N_GPU_FIELDS; k++)
+            candidate.channels.push_back(samples.add_channel("gpu_" + std::to_string(i) + "_" + gpu_fields[k][0],
+                                                             "gpu-" + std::to_string(i) + "-" + gpu_fields[k][1],
+                                                             "GPU " + std::to_string(i) + " " + gpu_fields[k][2],
+                                                             (k == 0) ? ChannelText : ChannelNumeric));
         known_gpus.push_back(candidate);
         gpus_to_satisfy += 2;
     }
@@ -56,18 +78,12 @@ int update_gpus(void) {
     int at_below_initial_temperature = 0;
     for (std::vector<gpu_cache>::iterator i = known_gpus.begin(); i != known_gpus.end(); i++) {
         if (args.debug >= DebugVerbose) {
-            switch (args.format) {
-                case OutputHuman:
-                    args.log << "GPU " << i->device_ID << " " << i->deviceName << " BEFORE" << std::endl;
-                    args.log << "\tGPU Temperature: " << i->gpu_temperature << std::endl;
-                    args.log << "\tMemory Temperature: " << i->mem_temperature << std::endl;
-                    args.log << "\tPower Usage/Limit: " << i->powerUsage << " / " << i->powerLimit << std::endl;
-                    args.log << "\tUtilization: " << i->utilization.gpu << "\% GPU " << i->utilization.memory << "\% Memory " << std::endl;
-                    args.log << "\tPerformance State: " << i->pState << std::endl;
-                case OutputCSV:
-                case OutputJSON:
-                    break;
-            }
+            args.error_log << "GPU " << i->device_ID << " " << i->deviceName << " BEFORE" << std::endl;
+            args.error_log << "\tGPU Temperature: " << i->gpu_temperature << std::endl;
+            args.error_log << "\tMemory Temperature: " << i->mem_temperature << std::endl;
+            args.error_log << "\tPower Usage/Limit: " << i->powerUsage << " / " << i->powerLimit << std::endl;
+            args.error_log << "\tUtilization: " << i->utilization.gpu << "\% GPU " << i->utilization.memory << "\% Memory " << std::endl;
+            args.error_log << "\tPerformance State: " << i->pState << std::endl;
         }
         nvmlDeviceGetTemperature(i->device_Handle, NVML_TEMPERATURE_GPU, &i->gpu_temperature);
         if (i->gpu_temperature <= i->gpu_initialTemperature) at_below_initial_temperature++;
@@ -79,35 +95,16 @@ int update_gpus(void) {
         nvmlDeviceGetUtilizationRates(i->device_Handle, &i->utilization);
         nvmlDeviceGetMemoryInfo(i->device_Handle, &i->memory);
         nvmlDeviceGetPerformanceState(i->device_Handle, &i->pState);
-        if (args.debug >= DebugVerbose || update) {
-            switch (args.format) {
-                case OutputCSV:
-                    args.log << "," << i->deviceName << "," << i->gpu_temperature << "," << i->mem_temperature << "," <<
-                             i->powerUsage << "," << i->powerLimit << "," << i->utilization.gpu << "," <<
-                             i->utilization.memory << "," << i->memory.used << "," << i->memory.total << "," << i->pState;
-                    break;
-                case OutputHuman:
-                    args.log << "GPU " << i->device_ID << " " << i->deviceName << " AFTER" << std::endl;
-                    args.log << "\tGPU Temperature: " << i->gpu_temperature << std::endl;
-                    args.log << "\tMemory Temperature: " << i->mem_temperature << std::endl;
-                    args.log << "\tPower Usage/Limit: " << i->powerUsage << " / " << i->powerLimit << std::endl;
-                    args.log << "\tUtilization: " << i->utilization.gpu << "\% GPU " << i->utilization.memory << "\% Memory " << std::endl;
-                    args.log << "\tPerformance State: " << i->pState << std::endl;
-                    break;
-                case OutputJSON:
-                    args.log << "\t\"gpu-" << i->device_ID << "-name\": \"" << i->deviceName << "\"," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-gpu-temperature\": " << i->gpu_temperature << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-memory-temperature\": " << i->mem_temperature << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-power-usage\": " << i->powerUsage << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-power-limit\": " << i->powerLimit << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-utilization-gpu\": " << i->utilization.gpu << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-utilization-memory\": " << i->utilization.memory << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-memory-used\": " << i->memory.used << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-memory-total\": " << i->memory.total << "," << std::endl <<
-                                "\t\"gpu-" << i->device_ID << "-pstate\": " << i->pState << "," << std::endl;
-                    break;
-            }
-        }
+        samples.set_text(i->channels[0], i->deviceName);
+        samples.set(i->channels[1], i->gpu_temperature);
+        samples.set(i->channels[2], i->mem_temperature);
+        samples.set(i->channels[3], i->powerUsage);
+        samples.set(i->channels[4], i->powerLimit);
+        samples.set(i->channels[5], i->utilization.gpu);
+        samples.set(i->channels[6], i->utilization.memory);
+        samples.set(i->channels[7], i->memory.used);
+        samples.set(i->channels[8], i->memory.total);
+        samples.set(i->channels[9], i->pState);
     }
     return at_below_initial_temperature;
 }
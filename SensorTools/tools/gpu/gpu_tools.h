@@ -7,12 +7,16 @@
   Current compiler definitions:
   * GPU_ENABLED - permit GPU tools to be implemented (currently
                   targets NVIDIA architecture/tools only)
+  * SIMULATED_HW - answer the same calls from simulated devices
+                   (tools/sim/nvml_sim.h) instead of the NVIDIA libraries
 */
 
 
 // Headers and why they're included
 // Document necessary compiler flags beside each header as needed in full-line comment below the header
-#ifdef GPU_ENABLED
+#if defined(GPU_ENABLED) && defined(SIMULATED_HW)
+#include "tools/sim/nvml_sim.h" // Simulated CUDA device count and NVML API
+#elif defined(GPU_ENABLED)
 #include <cuda.h> // IDK yet, but it's probably something
 // Must compile with: -lcuda
 #include <cuda_runtime.h> // Device management API
@@ -32,6 +36,7 @@ typedef struct gpu_cache_t {
     // IDs
     int device_ID;
     char deviceName[NAME_BUFFER_SIZE] = {-1};
+    std::vector<int> channels; // Sample channel per entry in gpu_fields
     #ifdef GPU_ENABLED
     nvmlDevice_t device_Handle;
     nvmlFieldValue_t temperature_field;
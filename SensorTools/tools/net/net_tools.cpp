@@ -0,0 +1,97 @@
+#include "net_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <cstring> // memchr()
+#include <algorithm> // std::copy
+// End Headers
+
+// Receive columns start with bytes and packets; transmit bytes and packets are the 9th and 10th columns
+static const int net_columns[NetCounters] = {0, 1, 8, 9};
+static const char* const net_fields[NetCounters] = {"rx_bytes", "rx_packets", "tx_bytes", "tx_packets"},
+                 * const net_json_fields[NetCounters] = {"rx-bytes", "rx-packets", "tx-bytes", "tx-packets"},
+                 * const net_names[NetCounters] = {"Received (bytes/s)", "Received (packets/s)", "Sent (bytes/s)", "Sent (packets/s)"};
+
+static int net_fd = -1;
+static std::vector<char> net_buf;
+static PollClock::time_point net_read; // When known_net was last read
+
+// Counters of one interface from a read of /proc/net/dev; false when its line is gone
+static bool net_counters(const net_cache& iface, ssize_t nbytes, uint64_t counters[NetCounters]) {
+    const char* at = procfs_find(net_buf.data(), nbytes, iface.key.c_str());
+    if (at == nullptr) return false;
+    uint64_t columns[10];
+    if (procfs_numbers(at + iface.key.size(), net_buf.data() + nbytes, columns, 10) < 10) return false;
+    for (int c = 0; c < NetCounters; c++) counters[c] = columns[net_columns[c]];
+    return true;
+}
+
+void cache_net(void) {
+    // No caching if we aren't going to query network interfaces
+    if (!args.net) return;
+
+    // Close-on-exec keeps this out of the wrapped command
+    net_fd = open(host_path(NetDevPath).c_str(), O_RDONLY | O_CLOEXEC);
+    // Headroom for interfaces and counter digits added during a long run
+    net_buf.resize((net_fd >= 0) ? procfs_length(net_fd) * 2 + 4096 : 0);
+    ssize_t nbytes = (net_fd >= 0) ? pread(net_fd, net_buf.data(), net_buf.size(), 0) : -1;
+    if (nbytes <= 0) {
+        args.error_log << "Unable to read " << host_path(NetDevPath) << ", no longer tracking" << std::endl;
+        if (net_fd >= 0) close(net_fd);
+        net_fd = -1;
+        args.net = false;
+        return;
+    }
+    // Interface lines follow the two header lines, as "  name: counters..."
+    const char *line = net_buf.data(), *end = net_buf.data() + nbytes;
+    for (int header = 0; header < 2 && line != nullptr; header++) {
+        line = static_cast<const char*>(memchr(line, '\n', end - line));
+        if (line != nullptr) line++;
+    }
+    while (line != nullptr && line < end) {
+        const char* colon = static_cast<const char*>(memchr(line, ':', end - line));
+        if (colon == nullptr) break;
+        while (*line == ' ') line++;
+        net_cache candidate;
+        candidate.name.assign(line, colon);
+        candidate.key = candidate.name + ":";
+        // Loopback traffic never leaves the node
+        if (candidate.name != "lo" && net_counters(candidate, nbytes, candidate.last)) {
+            for (int c = 0; c < NetCounters; c++)
+                candidate.channels[c] = samples.add_channel("net_" + candidate.name + "_" + net_fields[c],
+                                                            "net-" + candidate.name + "-" + net_json_fields[c],
+                                                            "Interface " + candidate.name + " " + net_names[c]);
+            known_net.push_back(candidate);
+            if (args.debug >= DebugVerbose) args.error_log << "Tracking network interface " << candidate.name << std::endl;
+        }
+        line = static_cast<const char*>(memchr(colon, '\n', end - colon));
+        if (line != nullptr) line++;
+    }
+    net_read = poll_clock.now();
+    if (known_net.empty()) {
+        args.error_log << "No network interfaces besides loopback, no longer tracking" << std::endl;
+        args.net = false;
+    }
+}
+
+void update_net(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update network interfaces" << std::endl;
+    PollClock::time_point now = poll_clock.now();
+    double elapsed_us = std::chrono::duration_cast<std::chrono::nanoseconds>(now - net_read).count() / 1e3;
+    ssize_t nbytes = pread(net_fd, net_buf.data(), net_buf.size(), 0);
+    if (elapsed_us <= 0 || nbytes <= 0) return;
+    net_read = now;
+    uint64_t counters[NetCounters];
+    for (std::vector<net_cache>::iterator i = known_net.begin(); i != known_net.end(); i++) {
+        // Interfaces removed since caching log no traffic
+        if (!net_counters(*i, nbytes, counters)) std::copy(i->last, i->last + NetCounters, counters);
+        for (int c = 0; c < NetCounters; c++) {
+            samples.set(i->channels[c], ((counters[c] > i->last[c]) ? counters[c] - i->last[c] : 0) * 1e6 / elapsed_us);
+            i->last[c] = counters[c];
+        }
+    }
+}
+
+// Definition of external variables for network tools
+std::vector<net_cache> known_net;
+
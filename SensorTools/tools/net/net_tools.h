@@ -0,0 +1,38 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/procfs_parse.h" // Column parsing of /proc/net/dev
+#include "io/poll_clock.h" // Poll intervals for rates
+// End Headers
+
+#define NetDevPath "/proc/net/dev"
+#define NetCounters 4 // rx bytes, rx packets, tx bytes, tx packets
+
+
+// Class and Type declarations
+// One network interface's line of /proc/net/dev
+typedef struct net_cache_t {
+    std::string name; // ie: eth0
+    std::string key; // Line key, ie: "eth0:"
+    uint64_t last[NetCounters] = {0}; // Counters at the previous poll
+    int channels[NetCounters]; // Sample channels, per-second rates in the same order
+} net_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_net(void);
+void update_net(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<net_cache> known_net;
+// End External variable declarations
+
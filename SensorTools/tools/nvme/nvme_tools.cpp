@@ -21,6 +21,7 @@ void cache_nvme(void) {
             nvme_subsystem_for_each_ctrl(s, c) {
                 nvme_cache candidate;
                 candidate.index = nvme_index;
+                candidate.name = nvme_ctrl_get_name(c);
                 nvme_index++;
                 if (args.debug >= DebugVerbose) args.error_log << "Identified an NVMe controller to potentially log" << std::endl;
                 int fd = nvme_ctrl_get_fd(c);
@@ -39,6 +40,11 @@ void cache_nvme(void) {
                 candidate.temperature.push_back(temp);
                 candidate.initial_temperature.push_back(temp);
                 if (args.debug >= DebugVerbose) args.error_log << "Tracking NVMe controller with " << candidate.temperature.size() << " temperatures" << std::endl;
+                for (int k = 0; k < candidate.temperature.size(); k++)
+                    candidate.channels.push_back(samples.add_channel(
+                        "nvme_" + std::to_string(candidate.index) + "_" + std::to_string(k) + "_temperature",
+                        "nvme-" + std::to_string(candidate.index) + "-" + std::to_string(k) + "-temperature",
+                        "NVMe " + std::to_string(candidate.index) + "_" + std::to_string(k) + " Temperature"));
                 known_nvme.push_back(candidate);
                 nvme_to_satisfy += candidate.temperature.size();
             }
@@ -61,19 +67,7 @@ int update_nvme(void) {
             int temp = ((i->smarts[k].temperature[1] << 8) | i->smarts[k].temperature[0]) - 273;
             i->temperature[k] = temp;
             if (temp <= i->initial_temperature[k]) at_below_initial_temperature++;
-            if (args.debug >= DebugVerbose || update) {
-                switch (args.format) {
-                    case OutputCSV:
-                        args.log << "," << i->temperature[k];
-                        break;
-                    case OutputHuman:
-                        args.log << "NVMe " << i->index << "_" << k << " Temperature: " << i->temperature[k] << std::endl;
-                        break;
-                    case OutputJSON:
-                        args.log << "\t\"nvme-" << i->index << "-" << k << "-temperature\": " << i->temperature[k] << "," << std::endl;
-                        break;
-                }
-            }
+            samples.set(i->channels[k], i->temperature[k]);
         }
     }
     return at_below_initial_temperature;
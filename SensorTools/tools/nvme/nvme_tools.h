@@ -1,8 +1,21 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_NvmeTools
+#define LibSensorTools_NvmeTools
+
 // Headers and why they're included
 // Document necessary compiler flags beside each header as needed in full-line comment below the header
 #include <vector> // vector type and operations
+#include <string> // Controller names
+#ifdef SIMULATED_HW
+#include "tools/sim/libnvme_sim.h" // Simulated controllers and SMART logs
+#else
 #include <libnvme.h> // Read NVME device temperatures
 // Must compile with: -lnvme
+#endif
 #include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
 // End Headers
 
@@ -12,12 +25,14 @@
 typedef struct nvme_cache_t {
     // IDs
     int index;
+    std::string name; // Controller, ie: nvme0; block device statistics use it to share this index
     struct nvme_smart_log temp_log;
     std::vector<struct nvme_smart_log> smarts;
     std::vector<int> fds;
     // Cached data
     std::vector<int> temperature;
     std::vector<int> initial_temperature;
+    std::vector<int> channels; // Sample channel per temperature
 } nvme_cache;
 
 
@@ -34,4 +49,4 @@ int update_nvme(void);
 extern std::vector<nvme_cache> known_nvme;
 extern int nvme_to_satisfy;
 // End External variable declarations
-
+#endif
@@ -1,6 +1,10 @@
 #include "pdu_tools.h"
 #include "snmp_hosts_and_oids.h" // Prevent multiple definition
 #include "snmp.c" // This should be separately built/linked, but I have had it with CMake not ordering this correctly
+#include "snmp_response.h" // GetResponse parsing, shared with sensortools_bench
+#ifdef SIMULATED_HW
+#include "tools/sim/snmp_sim.h" // Fake agent answering every endpoint
+#endif
 
 void cache_pdus(void) {
     // No caching if we aren't going to query PDUs
@@ -54,6 +58,10 @@ void cache_pdus(void) {
                 }
             }
         }
+        for (int j = 0; j < N_PDU_OIDS; j++)
+            candidate->channels.push_back(samples.add_channel("pdu_" + std::to_string(candidate->index) + "_" + candidate->oid_cache.field_names[j],
+                                                              "pdu-" + std::to_string(candidate->index) + "-" + candidate->oid_cache.field_names[j],
+                                                              "PDU " + std::to_string(candidate->index) + " " + candidate->oid_cache.field_names[j]));
         // No temperature to cache, no initial data retrieval
         known_pdus.emplace_back(std::move(candidate));
         pdus_to_satisfy++;
@@ -68,18 +76,6 @@ void cache_pdus(void) {
         args.error_log << "Tracking " << pdus_to_satisfy << " PDUs" << std::endl;
 }
 
-int parseInteger(byte *string) {
-    size_t len = decodeLen(&string[1]),
-           len_enc = getEncodedLenLen(len),
-           len_limit = 1+len+len_enc;
-    int r = 0;
-    for (size_t cursor = 1 + len_enc; cursor < len_limit; cursor++) {
-        r << 8;
-        r += (int)string[cursor];
-    }
-    return r;
-}
-
 int update_pdus(void) {
     if (args.debug >= DebugVerbose) args.error_log << "Update PDUs" << std::endl;
     for (std::vector<std::unique_ptr<pdu_cache>>::iterator i = known_pdus.begin(); i != known_pdus.end(); i++) {
@@ -110,122 +106,18 @@ int update_pdus(void) {
             }
 
             // Parse the response sequence of j->lastResponse
-            byte *response = &j->lastResponse[0],
-                  type = response[0];
-            if (type != SNMP_Sequence) {
-                args.error_log << "Received non-SNMP_Sequence (" << SNMP_Sequence << ") type: " << type << ", skipping updates for PDU " << j->index << std::endl;
-                continue;
-            }
-            size_t seqLen = decodeLen(&response[1]),
-                   len_enc = getEncodedLenLen(seqLen),
-                   cursor = 1 + len_enc,
-                   seqOffset = 0,
-                   len;
-            // Jump over components until reaching response portion
-            while (seqOffset < seqLen) {
-                type = response[cursor];
-                len = decodeLen(&response[cursor+1]);
-                len_enc = getEncodedLenLen(len);
-                if (type == SNMP_GetRsp) break;
-                seqOffset += 1 + len_enc + len;
-                cursor += 1 + len_enc + len;
-            }
-            // Begin processing the Get Response portion
-            cursor += 1 + len_enc;
-            seqOffset += 1 + len_enc;
-            // Response ID comment (skip)
-            len = decodeLen(&response[cursor+1]);
-            len_enc = getEncodedLenLen(len);
-            cursor += 1 + len_enc + len;
-            seqOffset += 1 + len_enc + len;
-            // Error Component (halt processing this entry if erroneous)
-            if (response[cursor+2] != 0x00) {
-                args.error_log << "SNMP Response indicated error " << response[cursor+2] << ", skipping updates for PDU " << j->index << std::endl;
-                continue;
-            }
-            cursor += 3;
-            seqOffset += 3;
-            // Error Index Component (skip)
-            len = decodeLen(&response[cursor+1]);
-            len_enc = getEncodedLenLen(len);
-            cursor += 1 + len_enc + len;
-            seqOffset += 1 + len_enc + len;
-            // Now at the varbind list where all requests are answered
-            while (seqOffset < seqLen) {
-                size_t listLen = decodeLen(&response[cursor+1]),
-                       listOffset = 0;
-                len_enc = getEncodedLenLen(listLen);
-                cursor += 1 + len_enc;
-                seqOffset += 1 + len_enc;
-                while (listOffset < listLen) {
-                    // Varbind metadata
-                    len = decodeLen(&response[cursor+1]);
-                    len_enc = getEncodedLenLen(len);
-                    cursor += 1 + len_enc;
-                    seqOffset += 1 + len_enc;
-                    listOffset += 1 + len_enc;
-                    // OID component
-                    std::string oid = "";
-                    len = decodeLen(&response[cursor+1]);
-                    len_enc = getEncodedLenLen(len);
-                    cursor += 1 + len_enc;
-                    seqOffset += 1 + len_enc;
-                    listOffset += 1 + len_enc;
-                    bool skip = false;
-                    size_t c = 0;
-                    for (size_t x = 0; x < len; x++) {
-                        if (skip) {
-                            if (! (response[cursor+x] & 0x80))
-                                skip = false;
-                            continue;
-                        }
-                        if (response[cursor+x] & 0x80)
-                            skip = true;
-                        if (response[cursor+x] == 0x2b)
-                            oid += "1.3";
-                        else {
-                            int oid_value = decodeOID(&response[cursor+x]);
-                            oid += "."+std::to_string(oid_value);
-                        }
-                    }
-                    cursor += len;
-                    seqOffset += len;
-                    listOffset += len;
-                    // Value Component
-                    len = decodeLen(&response[cursor+1]);
-                    len_enc = getEncodedLenLen(len);
-                    // OID may not be tracked, if so, skip it
-                    int y = 0;
-                    for (std::vector<std::string>::iterator x = j->oid_cache.oid_names.begin(); x != j->oid_cache.oid_names.end(); x++) {
-                        if (x->compare(oid) == 0) {
-                            j->oid_cache.values[y] = parseInteger(&response[cursor]);
-                            break;
-                        }
-                        y++;
-                    }
-                    cursor += 1 + len_enc + len;
-                    seqOffset += 1 + len_enc + len;
-                    listOffset += 1 + len_enc + len;
-                }
-            }
-        }
-        // Output
-        if (args.debug >= DebugVerbose || update) {
-            switch (args.format) {
-                case OutputCSV:
-                    for (int k = 0; k < N_PDU_OIDS; k++)
-                        args.log << "," << j->oid_cache.values[k];
-                    break;
-                case OutputHuman:
-                    for (int k = 0; k < N_PDU_OIDS; k++)
-                        args.log << j->oid_cache.field_names[k] << ": " << j->oid_cache.values[k] << std::endl;
+            int detail = 0;
+            switch (parse_snmp_response(&j->lastResponse[0], j->oid_cache.oid_names, j->oid_cache.values, detail)) {
+                case SNMP_ParseNotSequence:
+                    args.error_log << "Received non-SNMP_Sequence (" << SNMP_Sequence << ") type: " << detail << ", skipping updates for PDU " << j->index << std::endl;
                     break;
-                case OutputJSON:
-                    for (int k = 0; k < N_PDU_OIDS; k++)
-                        args.log << "\t\"pdu-" << j->index << "-" << j->oid_cache.field_names[k] << "\": " << j->oid_cache.values[k] << "," << std::endl;
+                case SNMP_ParseErrorStatus:
+                    args.error_log << "SNMP Response indicated error " << detail << ", skipping updates for PDU " << j->index << std::endl;
                     break;
             }
         }
+        // Output
+        for (int k = 0; k < N_PDU_OIDS; k++) samples.set(j->channels[k], j->oid_cache.values[k]);
     }
     // No temperatures == always fully satisfied
     return pdus_to_satisfy;
@@ -28,6 +28,7 @@ typedef struct pdu_cache_t {
   byte lastResponse[SNMP_ResponseMax];
   // Cached data
   OID_cache oid_cache;
+  std::vector<int> channels; // Sample channel per OID
 
   // Destructor should be safe and reliably free memory
   ~pdu_cache_t() {
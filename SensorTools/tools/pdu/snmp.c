@@ -9,6 +9,8 @@ extern "C"{
 // https://intronetworks.cs.luc.edu/current1/html/netmgmt.html
 
 // Connection Interface
+// Simulated builds answer requests from a fake agent instead (tools/sim/snmp_sim.h)
+#ifndef SIMULATED_HW
 int openSNMP(const char *host, struct addrinfo **serv_addr){
   int sockfd = -1;
   char *service = (char*)"snmp";
@@ -88,6 +90,7 @@ void closeSNMP(int sockfd, struct addrinfo *serv_addr){
   freeaddrinfo(serv_addr);
   serv_addr = NULL;
 }
+#endif
 
 // Message Creation Interface
 byte requestID = 0;
@@ -0,0 +1,137 @@
+/*
+    Parsing of SNMP GetResponse messages, shared by pdu_tools and sensortools_bench
+    Include after snmp.h
+
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_SnmpResponse
+#define LibSensorTools_SnmpResponse
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "snmp.h" // byte, SNMP types, decodeLen(), getEncodedLenLen(), decodeOID()
+#include <string> // OID names
+#include <vector> // Tracked OIDs and their values
+// End Headers
+
+// Results of parse_snmp_response()
+#define SNMP_ParseOK 0
+#define SNMP_ParseNotSequence 1 // detail holds the type found instead
+#define SNMP_ParseErrorStatus 2 // detail holds the error status the agent reported
+
+static inline int parseInteger(byte *string) {
+    size_t len = decodeLen(&string[1]),
+           len_enc = getEncodedLenLen(len),
+           len_limit = 1+len+len_enc;
+    int r = 0;
+    for (size_t cursor = 1 + len_enc; cursor < len_limit; cursor++) {
+        r << 8;
+        r += (int)string[cursor];
+    }
+    return r;
+}
+
+// Walk one response message, storing the INTEGER answered for each OID found in oid_names into the same index of values
+// Answers for OIDs that are not tracked are skipped
+static inline int parse_snmp_response(byte *response, const std::vector<std::string>& oid_names, std::vector<int>& values, int& detail) {
+    byte type = response[0];
+    if (type != SNMP_Sequence) {
+        detail = type;
+        return SNMP_ParseNotSequence;
+    }
+    size_t seqLen = decodeLen(&response[1]),
+           len_enc = getEncodedLenLen(seqLen),
+           cursor = 1 + len_enc,
+           seqOffset = 0,
+           len;
+    // Jump over components until reaching response portion
+    while (seqOffset < seqLen) {
+        type = response[cursor];
+        len = decodeLen(&response[cursor+1]);
+        len_enc = getEncodedLenLen(len);
+        if (type == SNMP_GetRsp) break;
+        seqOffset += 1 + len_enc + len;
+        cursor += 1 + len_enc + len;
+    }
+    // Begin processing the Get Response portion
+    cursor += 1 + len_enc;
+    seqOffset += 1 + len_enc;
+    // Response ID comment (skip)
+    len = decodeLen(&response[cursor+1]);
+    len_enc = getEncodedLenLen(len);
+    cursor += 1 + len_enc + len;
+    seqOffset += 1 + len_enc + len;
+    // Error Component (halt processing this entry if erroneous)
+    if (response[cursor+2] != 0x00) {
+        detail = response[cursor+2];
+        return SNMP_ParseErrorStatus;
+    }
+    cursor += 3;
+    seqOffset += 3;
+    // Error Index Component (skip)
+    len = decodeLen(&response[cursor+1]);
+    len_enc = getEncodedLenLen(len);
+    cursor += 1 + len_enc + len;
+    seqOffset += 1 + len_enc + len;
+    // Now at the varbind list where all requests are answered
+    while (seqOffset < seqLen) {
+        size_t listLen = decodeLen(&response[cursor+1]),
+               listOffset = 0;
+        len_enc = getEncodedLenLen(listLen);
+        cursor += 1 + len_enc;
+        seqOffset += 1 + len_enc;
+        while (listOffset < listLen) {
+            // Varbind metadata
+            len = decodeLen(&response[cursor+1]);
+            len_enc = getEncodedLenLen(len);
+            cursor += 1 + len_enc;
+            seqOffset += 1 + len_enc;
+            listOffset += 1 + len_enc;
+            // OID component
+            std::string oid = "";
+            len = decodeLen(&response[cursor+1]);
+            len_enc = getEncodedLenLen(len);
+            cursor += 1 + len_enc;
+            seqOffset += 1 + len_enc;
+            listOffset += 1 + len_enc;
+            bool skip = false;
+            for (size_t x = 0; x < len; x++) {
+                if (skip) {
+                    if (! (response[cursor+x] & 0x80))
+                        skip = false;
+                    continue;
+                }
+                if (response[cursor+x] & 0x80)
+                    skip = true;
+                if (response[cursor+x] == 0x2b)
+                    oid += "1.3";
+                else {
+                    int oid_value = decodeOID(&response[cursor+x]);
+                    oid += "."+std::to_string(oid_value);
+                }
+            }
+            cursor += len;
+            seqOffset += len;
+            listOffset += len;
+            // Value Component
+            len = decodeLen(&response[cursor+1]);
+            len_enc = getEncodedLenLen(len);
+            // OID may not be tracked, if so, skip it
+            int y = 0;
+            for (std::vector<std::string>::const_iterator x = oid_names.begin(); x != oid_names.end(); x++) {
+                if (x->compare(oid) == 0) {
+                    values[y] = parseInteger(&response[cursor]);
+                    break;
+                }
+                y++;
+            }
+            cursor += 1 + len_enc + len;
+            seqOffset += 1 + len_enc + len;
+            listOffset += 1 + len_enc + len;
+        }
+    }
+    return SNMP_ParseOK;
+}
+#endif
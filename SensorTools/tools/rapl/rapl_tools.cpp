@@ -0,0 +1,151 @@
+#include "rapl_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::sort
+#include <fstream> // Reading zone names and ranges once at cache time
+#include <map> // Zone names by zone, for subzone labels
+#include <cstring> // strerror()
+#include <cerrno> // errno
+// End Headers
+
+// Microjoules added since prev, allowing for at most one wrap of the counter
+static inline uint64_t rapl_delta(uint64_t prev, uint64_t now, uint64_t max_range) {
+    return (now >= prev) ? now - prev : max_range - prev + now + 1;
+}
+
+// Zone indices, ie: intel-rapl:0:1 -> {0, 1}, so package 10 sorts after package 9
+static std::vector<int> zone_indices(const std::string& zone) {
+    std::vector<int> indices;
+    for (size_t colon = zone.find(':'); colon != std::string::npos; colon = zone.find(':', colon + 1))
+        indices.push_back(atoi(zone.c_str() + colon + 1));
+    return indices;
+}
+
+static std::string read_zone_line(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Zones sharing one prefix (intel-rapl: or intel-rapl-mmio:), parents before their subzones
+static std::vector<std::string> find_zones(const std::string& prefix) {
+    std::vector<std::string> zones;
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(host_path(RaplRoot), ec)) {
+        std::string zone = entry.path().filename().string();
+        if (zone.compare(0, prefix.size(), prefix) == 0) zones.push_back(zone);
+    }
+    std::sort(zones.begin(), zones.end(), [](const std::string& a, const std::string& b) {
+        return zone_indices(a) < zone_indices(b);
+    });
+    return zones;
+}
+
+void cache_rapl(void) {
+    // No caching if we aren't going to query RAPL
+    if (!args.rapl) return;
+
+    // MMIO zones duplicate the MSR package domains on some Intel parts, so they are only a fallback
+    std::vector<std::string> zones = find_zones("intel-rapl:");
+    if (zones.empty()) zones = find_zones("intel-rapl-mmio:");
+    if (zones.empty()) {
+        args.error_log << "No RAPL zones found under " << host_path(RaplRoot) << ", no longer tracking" << std::endl;
+        args.rapl = false;
+        return;
+    }
+
+    std::map<std::string, std::string> names;
+    char buf[SysfsReadSize] = {0};
+    PollClock::time_point now = poll_clock.now();
+    for (std::vector<std::string>::iterator zone = zones.begin(); zone != zones.end(); zone++) {
+        std::filesystem::path dir = std::filesystem::path(host_path(RaplRoot)) / *zone;
+        rapl_cache candidate;
+        candidate.zone = *zone;
+        names[*zone] = read_zone_line(dir / "name");
+        candidate.label = names[*zone];
+        // Subzones (core, uncore, dram) repeat per package, so they carry their parent's name
+        size_t parent = zone->rfind(':');
+        if (zone_indices(*zone).size() > 1 && names.count(zone->substr(0, parent)))
+            candidate.label = names[zone->substr(0, parent)] + "_" + candidate.label;
+        candidate.max_range_uj = strtoull(read_zone_line(dir / "max_energy_range_uj").c_str(), nullptr, 10);
+        // Close-on-exec keeps these out of the wrapped command
+        candidate.fd = open((dir / "energy_uj").c_str(), O_RDONLY | O_CLOEXEC);
+        ssize_t nbytes = (candidate.fd >= 0) ? pread(candidate.fd, buf, sizeof(buf), 0) : -1;
+        if (nbytes <= 0 || candidate.max_range_uj == 0 || (candidate.slot = sysfs_reads.add(candidate.fd)) < 0) {
+            // Kernels since 5.10 restrict energy_uj to root
+            if (args.debug >= DebugMinimal)
+                args.error_log << "Unable to read " << (dir / "energy_uj") << " (" << ((nbytes < 0) ? strerror(errno) : "no energy range") <<
+                                  "), RAPL domain " << candidate.label << " is not tracked" << std::endl;
+            if (candidate.fd >= 0) close(candidate.fd);
+            continue;
+        }
+        candidate.last_uj = parse_sysfs_uint(buf, nbytes);
+        candidate.last_read = now;
+        candidate.power_channel = samples.add_channel("rapl_" + candidate.label + "_power",
+                                                      "rapl-" + candidate.label + "-power",
+                                                      "RAPL " + candidate.label + " Power (W)");
+        candidate.energy_channel = samples.add_channel("rapl_" + candidate.label + "_energy",
+                                                       "rapl-" + candidate.label + "-energy",
+                                                       "RAPL " + candidate.label + " Energy (J)");
+        if (args.debug >= DebugVerbose)
+            args.error_log << "Tracking RAPL domain " << candidate.label << " (" << candidate.zone << ") wrapping at " << candidate.max_range_uj << " uJ" << std::endl;
+        known_rapl.push_back(candidate);
+    }
+    if (known_rapl.empty()) args.rapl = false;
+    if (args.debug >= DebugMinimal)
+        args.error_log << "Tracking " << known_rapl.size() << " RAPL domains" << std::endl;
+}
+
+void update_rapl(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update RAPL" << std::endl;
+    // Counters were read by sysfs_reads at the start of this poll
+    PollClock::time_point now = sysfs_reads.last_read();
+    for (std::vector<rapl_cache>::iterator i = known_rapl.begin(); i != known_rapl.end(); i++) {
+        if (sysfs_reads.length(i->slot) <= 0) {
+            if (args.debug >= DebugMinimal)
+                args.error_log << "Unable to update RAPL domain " << i->label << std::endl;
+            continue;
+        }
+        uint64_t uj = sysfs_reads.value(i->slot),
+                 delta = rapl_delta(i->last_uj, uj, i->max_range_uj);
+        double elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - i->last_read).count() / 1e9;
+        // Polls faster than the counter's update rate keep the previous interval's power
+        if (elapsed > 0 && delta > 0) {
+            i->power = delta / 1e6 / elapsed;
+            i->last_read = now;
+        }
+        i->last_uj = uj;
+        i->total_uj += delta;
+        samples.set(i->power_channel, i->power);
+        samples.set(i->energy_channel, i->total_uj / 1e6);
+    }
+}
+
+// Accumulated microjoules as of right now, without disturbing the per-poll power interval
+static uint64_t rapl_total_now(const rapl_cache& domain) {
+    char buf[SysfsReadSize] = {0};
+    ssize_t nbytes = pread(domain.fd, buf, sizeof(buf), 0);
+    if (nbytes <= 0) return domain.total_uj;
+    return domain.total_uj + rapl_delta(domain.last_uj, parse_sysfs_uint(buf, nbytes), domain.max_range_uj);
+}
+
+void mark_rapl_energy(void) {
+    for (std::vector<rapl_cache>::iterator i = known_rapl.begin(); i != known_rapl.end(); i++)
+        i->mark_uj = rapl_total_now(*i);
+}
+
+nlohmann::json rapl_energy_since_mark(void) {
+    nlohmann::json energy = nlohmann::json::object();
+    for (std::vector<rapl_cache>::iterator i = known_rapl.begin(); i != known_rapl.end(); i++) {
+        energy[i->label] = (rapl_total_now(*i) - i->mark_uj) / 1e6;
+        if (args.debug >= DebugMinimal)
+            args.error_log << "RAPL domain " << i->label << " used " << energy[i->label] << " J during the wrapped command" << std::endl;
+    }
+    return energy;
+}
+
+// Definition of external variables for RAPL tools
+std::vector<rapl_cache> known_rapl;
+
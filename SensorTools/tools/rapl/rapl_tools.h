@@ -0,0 +1,53 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <chrono> // Timestamps of counter reads
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include <filesystem> // powercap directory traversal
+// May require on some systems: -lstdc++fs
+#include <nlohmann/json.hpp> // Per-domain energy of the wrapped command
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/sysfs_parse.h" // Branch-free sysfs integer parsing
+#include "io/sysfs_reader.h" // Batched per-poll reads of cached files
+// End Headers
+
+#define RaplRoot "/sys/class/powercap"
+
+
+// Class and Type declarations
+// One RAPL domain (package, core, uncore, dram, psys) exposed through powercap
+// Intel and AMD (Zen and later) processors both register intel-rapl:* zones
+typedef struct rapl_cache_t {
+    // IDs
+    std::string zone; // ie: intel-rapl:0:1
+    std::string label; // Domain name, prefixed by its parent's for subzones, ie: package-0_dram
+    int fd = -1, slot = -1; // energy_uj, registered with sysfs_reads
+    // energy_uj counts 0..max_range_uj in microjoules, then wraps to 0
+    uint64_t max_range_uj = 0, last_uj = 0;
+    // Accumulated microjoules since caching, and the accumulator's value at mark_rapl_energy()
+    uint64_t total_uj = 0, mark_uj = 0;
+    PollClock::time_point last_read;
+    double power = 0; // Watts averaged over the interval between the two most recent polls
+    int power_channel, energy_channel; // Sample channels
+} rapl_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_rapl(void);
+void update_rapl(void);
+// Remember every domain's energy now, ie: when the wrapped command starts
+void mark_rapl_energy(void);
+// Joules used by each domain since mark_rapl_energy(), keyed by label
+nlohmann::json rapl_energy_since_mark(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<rapl_cache> known_rapl;
+// End External variable declarations
+
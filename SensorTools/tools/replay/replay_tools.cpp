@@ -0,0 +1,125 @@
+#include "replay_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::replace
+#include <cctype> // tolower()
+#include <cmath> // std::isnan
+// End Headers
+
+// Columns every log carries besides its channels
+static bool replay_skips(const std::string& name) {
+    return name == "timestamp" || name == "poll-update-duration" || name == "dummy-end";
+}
+
+// Live collectors satisfy post-wait early exit with their temperature channels, which all end this way
+static bool replay_is_temperature(const std::string& name) {
+    static const std::string suffix = "temperature";
+    if (name.size() < suffix.size()) return false;
+    for (size_t i = 0; i < suffix.size(); i++)
+        if (tolower(name[name.size() - suffix.size() + i]) != suffix[i]) return false;
+    return true;
+}
+
+void cache_replay(void) {
+    // No caching if we aren't going to replay a log
+    if (!args.replay) return;
+
+    reader_options options;
+    std::string error;
+    if (read_sensor_log(args.replay_log, options, replay.log, error) != ReaderOK) {
+        args.error_log << "Unable to load " << args.replay_log << " for replay: " << error << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (replay.log.truncated && args.debug >= DebugMinimal)
+        args.error_log << "Replayed log " << args.replay_log << " ends in a torn record, which is not replayed" << std::endl;
+    // Channels keep their recorded names; the other formats' names swap the '_' and '-' separators
+    bool recorded_csv = (replay.log.format == ReaderCSV);
+    for (size_t i = 0; i < replay.log.columns.size(); i++) {
+        const log_column& column = replay.log.columns[i];
+        if (column.name == "timestamp") replay.timestamp_column = static_cast<int>(i);
+        if (replay_skips(column.name)) continue;
+        std::string csv_name = column.name, json_name = column.name;
+        if (recorded_csv) std::replace(json_name.begin(), json_name.end(), '_', '-');
+        else std::replace(csv_name.begin(), csv_name.end(), '-', '_');
+        replay_channel candidate;
+        candidate.column = static_cast<int>(i);
+        candidate.text = (column.kind == ChannelText);
+        candidate.temperature = !candidate.text && replay_is_temperature(column.name);
+        candidate.channel = samples.add_channel(csv_name, json_name, column.name, column.kind);
+        if (candidate.temperature) replay_to_satisfy++;
+        replay.channels.push_back(candidate);
+    }
+    if (replay.log.rows == 0 || replay.channels.empty()) {
+        args.error_log << "No samples to replay in " << args.replay_log << ", no longer replaying" << std::endl;
+        args.replay = false;
+        return;
+    }
+    if (replay.timestamp_column < 0 && args.replay_speed != 0 && args.debug >= DebugMinimal)
+        args.error_log << "Replayed log " << args.replay_log << " has no timestamps; replaying one row per poll" << std::endl;
+    if (args.debug >= DebugMinimal)
+        args.error_log << "Replaying " << replay.log.rows << " " << reader_format_name(replay.log.format) << " rows of " <<
+                          replay.channels.size() << " channels (" << replay_to_satisfy << " temperatures) from " << args.replay_log << std::endl;
+}
+
+// Seconds after the first row that row is due, at the requested speed
+static double replay_due(size_t row) {
+    const std::vector<double>& timestamps = replay.log.columns[replay.timestamp_column].values;
+    double t = timestamps[row], t0 = timestamps[0];
+    return (std::isnan(t) || std::isnan(t0)) ? 0 : (t - t0) / args.replay_speed;
+}
+
+// Seconds on the poll clock since the first row was emitted
+static double replay_elapsed(void) {
+    if (!replay.started) {
+        replay.start = poll_clock.now();
+        replay.started = true;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(poll_clock.now() - replay.start).count() / 1e9;
+}
+
+// Rows follow their recorded timestamps unless replaying as fast as possible or the log has none
+static bool replay_timed(void) {
+    return args.replay_speed != 0 && replay.timestamp_column >= 0;
+}
+
+void pace_replay(void) {
+    // With a poll interval, polls set the pace instead
+    if (args.poll != 0 || !replay_timed() || replay.next >= replay.log.rows) return;
+    double elapsed = replay_elapsed(), due = replay_due(replay.next);
+    if (due > elapsed) poll_clock.sleep_for(std::chrono::duration<double>(due - elapsed));
+}
+
+int update_replay(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update replay" << std::endl;
+    if (replay.next < replay.log.rows) {
+        if (!replay_timed() || args.poll == 0) replay.row = replay.next++; // Already due, see pace_replay()
+        else {
+            // Show the latest row that is due, skipping any recorded between polls
+            double elapsed = replay_elapsed();
+            while (replay.next < replay.log.rows && replay_due(replay.next) <= elapsed) replay.row = replay.next++;
+        }
+    }
+    if (replay.row < 0) return 0;
+    int at_below_initial_temperature = 0;
+    for (std::vector<replay_channel>::iterator i = replay.channels.begin(); i != replay.channels.end(); i++) {
+        const log_column& column = replay.log.columns[i->column];
+        if (i->text) {
+            samples.set_text(i->channel, column.text[replay.row]);
+            continue;
+        }
+        double value = column.values[replay.row];
+        samples.set(i->channel, value);
+        if (i->temperature && value <= i->initial) at_below_initial_temperature++;
+    }
+    return at_below_initial_temperature;
+}
+
+size_t replay_rows_left(void) {
+    return replay.log.rows - replay.next;
+}
+
+// Definition of external variables for replay tools
+replay_cache replay;
+int replay_to_satisfy = 0;
+
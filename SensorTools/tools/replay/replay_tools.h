@@ -0,0 +1,49 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/poll_clock.h" // Recorded speed is kept on the poll clock, so a virtual clock fast-forwards it
+#include "reader/log_reader.h" // Parallel CSV/JSON log loading
+// Must link against sensorlog_reader
+// End Headers
+
+
+// Class and Type declarations
+// One recorded channel fed back into the sample it was logged from
+typedef struct replay_channel_t {
+    int column; // Index into the log's columns
+    int channel; // Sample channel
+    bool text, temperature; // Temperatures take part in post-wait early exit like live sensors
+    double initial = 0; // Temperature when the initial wait ended
+} replay_channel;
+
+typedef struct replay_cache_t {
+    sensor_log log;
+    std::vector<replay_channel> channels;
+    int timestamp_column = -1; // -1 when the log has none, which replays one row per poll
+    size_t next = 0; // Row to emit next
+    long row = -1; // Row currently in the sample, -1 before the first
+    bool started = false;
+    PollClock::time_point start; // When the first row was emitted
+} replay_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_replay(void);
+// Without a poll interval, wait until the next row is due at the requested speed; call before a poll's timestamp
+void pace_replay(void);
+int update_replay(void);
+// Rows left to emit
+size_t replay_rows_left(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern replay_cache replay;
+extern int replay_to_satisfy;
+// End External variable declarations
+
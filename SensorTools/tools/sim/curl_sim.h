@@ -0,0 +1,78 @@
+/*
+    Stand-in for the libcurl calls submer_tools makes, used when built with SIMULATED_HW
+    Every perform answers with a Submer realTime document (see example_submer.json) whose readings follow one
+    pod load level: coolant temperatures and flows rise with consumption as they would under a heating workload
+
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_CurlSim
+#define LibSensorTools_CurlSim
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "sim_backend.h" // Trajectories and the global simulation config
+#include <nlohmann/json.hpp> // Building the response document
+#include <string> // Response body
+#include <cstdarg> // curl_easy_setopt() takes its value as a vararg
+#include <cstddef> // size_t
+// End Headers
+
+#define CURL_GLOBAL_ALL 3
+
+// Class and Type declarations
+typedef enum { CURLE_OK = 0, CURLE_OPERATION_TIMEDOUT = 28 } CURLcode;
+typedef enum { CURLOPT_WRITEDATA = 10001, CURLOPT_URL = 10002, CURLOPT_WRITEFUNCTION = 20011, CURLOPT_TIMEOUT_MS = 155 } CURLoption;
+typedef size_t (*curl_sim_write_callback)(void* contents, size_t size, size_t nmemb, void* userp);
+typedef struct curl_sim_handle_t {
+    curl_sim_write_callback write = nullptr;
+    void* write_data = nullptr;
+} CURL;
+
+// Reading, lowest and highest value; the pod's load moves every reading between them
+typedef struct curl_sim_field_t {
+    const char* name;
+    double lo, hi;
+} curl_sim_field;
+// End Class and Type declarations
+
+static const curl_sim_field curl_sim_fields[] = {
+    {"temperature", 25, 45}, {"consumption", 500, 20000}, {"dissipation", 450, 19500},
+    {"dissipationC", 400, 19000}, {"dissipationW", 450, 19500}, {"mpue", 1.02, 1.08},
+    {"pump1rpm", 1200, 3000}, {"pump2rpm", 1200, 3000},
+    {"cti", 16, 30}, {"cto", 14, 24}, {"cf", 20, 120},
+    {"wti", 9, 12}, {"wto", 9, 20}, {"wf", 2, 8},
+};
+
+static inline CURLcode curl_global_init(long) { return CURLE_OK; }
+static inline void curl_global_cleanup(void) {}
+static inline const char* curl_version(void) { return "simulated"; }
+static inline const char* curl_easy_strerror(CURLcode code) { return (code == CURLE_OK) ? "No error" : "Timeout was reached"; }
+static inline CURL* curl_easy_init(void) { return new CURL; }
+static inline void curl_easy_cleanup(CURL* handle) { delete handle; }
+
+static inline CURLcode curl_easy_setopt(CURL* handle, CURLoption option, ...) {
+    va_list value;
+    va_start(value, option);
+    if (option == CURLOPT_WRITEFUNCTION) handle->write = va_arg(value, curl_sim_write_callback);
+    else if (option == CURLOPT_WRITEDATA) handle->write_data = va_arg(value, void*);
+    va_end(value);
+    return CURLE_OK;
+}
+
+static inline CURLcode curl_easy_perform(CURL* handle) {
+    double load = sim_value(sim_key("submer", 0, 0), 0, 1);
+    nlohmann::json data = {{"setpoint", 45}, {"pump1status", 1}, {"pump2status", 1}, {"errors", nlohmann::json::array()},
+                           {"warnings", nlohmann::json::array()}, {"mode", "normal"}};
+    for (size_t k = 0; k < sizeof(curl_sim_fields) / sizeof(curl_sim_fields[0]); k++) {
+        double level = load + sim_value(sim_key("submer", 0, k + 1), -0.03, 0.03);
+        level = (level < 0) ? 0 : (level > 1) ? 1 : level;
+        data[curl_sim_fields[k].name] = curl_sim_fields[k].lo + (curl_sim_fields[k].hi - curl_sim_fields[k].lo) * level;
+    }
+    std::string body = nlohmann::json({{"meta", nlohmann::json::array()}, {"data", data}}).dump();
+    if (handle->write != nullptr) handle->write(&body[0], 1, body.size(), handle->write_data);
+    return CURLE_OK;
+}
+#endif
+
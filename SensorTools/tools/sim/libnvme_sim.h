@@ -0,0 +1,88 @@
+/*
+    Stand-in for the libnvme calls nvme_tools makes, used when built with SIMULATED_HW
+    One host and subsystem holding simulation.nvme controllers named nvme0, nvme1, ...
+    Each controller's fd is a memfd holding its index, so fds the tool dup()s still identify it,
+    and every SMART log read returns a composite temperature following the simulation
+
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_LibnvmeSim
+#define LibSensorTools_LibnvmeSim
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "sim_backend.h" // Trajectories and the global simulation config
+#include <vector> // Controllers
+#include <string> // Controller names
+#include <cstdint> // uint8_t
+#include <cstdlib> // atoi()
+#include <cstring> // memset()
+#include <sys/mman.h> // memfd_create()
+#include <unistd.h> // pread(), write(), close()
+// End Headers
+
+#define NVME_NSID_ALL 0xffffffff
+#define NVME_VERSION_PROJECT 0
+
+// Class and Type declarations
+// Only the fields the tool reads; a real log is 512 bytes
+struct nvme_smart_log {
+    uint8_t critical_warning;
+    uint8_t temperature[2]; // Composite temperature in Kelvin, little-endian
+    uint8_t avail_spare;
+};
+
+typedef struct nvme_sim_ctrl_t {
+    int index, fd;
+    std::string name;
+} nvme_sim_ctrl;
+
+typedef struct nvme_sim_tree_t {
+    std::vector<nvme_sim_ctrl> ctrls;
+} nvme_sim_tree;
+
+// The host and subsystem levels collapse into the tree itself
+typedef nvme_sim_tree* nvme_root_t;
+typedef nvme_sim_tree* nvme_host_t;
+typedef nvme_sim_tree* nvme_subsystem_t;
+typedef nvme_sim_ctrl* nvme_ctrl_t;
+// End Class and Type declarations
+
+#define nvme_for_each_host(r, h) for (h = (r); h != nullptr; h = nullptr)
+#define nvme_for_each_subsystem(h, s) for (s = (h); s != nullptr; s = nullptr)
+#define nvme_subsystem_for_each_ctrl(s, c) for (c = (s)->ctrls.data(); c != (s)->ctrls.data() + (s)->ctrls.size(); c++)
+
+static inline nvme_root_t nvme_scan(const char*) {
+    nvme_root_t root = new nvme_sim_tree;
+    for (int i = 0; i < simulation.nvme; i++) {
+        nvme_sim_ctrl ctrl = {i, memfd_create("nvme_sim", MFD_CLOEXEC), "nvme" + std::to_string(i)};
+        std::string index = std::to_string(i);
+        if (ctrl.fd < 0 || write(ctrl.fd, index.c_str(), index.size()) < 0) continue;
+        root->ctrls.push_back(ctrl);
+    }
+    return root;
+}
+
+static inline void nvme_free_tree(nvme_root_t root) {
+    for (std::vector<nvme_sim_ctrl>::iterator c = root->ctrls.begin(); c != root->ctrls.end(); c++) close(c->fd);
+    delete root;
+}
+
+static inline const char* nvme_ctrl_get_name(nvme_ctrl_t c) { return c->name.c_str(); }
+static inline int nvme_ctrl_get_fd(nvme_ctrl_t c) { return c->fd; }
+static inline const char* nvme_get_version(int) { return "simulated"; }
+
+static inline int nvme_get_log_smart(int fd, unsigned int, bool, struct nvme_smart_log* log) {
+    char index[16] = {0};
+    if (pread(fd, index, sizeof(index) - 1, 0) <= 0) return -1;
+    memset(log, 0, sizeof(*log));
+    int kelvin = 273 + static_cast<int>(sim_value(sim_key("nvme", atoi(index), 0), 30, 70));
+    log->temperature[0] = kelvin & 0xff;
+    log->temperature[1] = kelvin >> 8;
+    log->avail_spare = 100;
+    return 0;
+}
+#endif
+
@@ -0,0 +1,100 @@
+/*
+    Stand-in for the CUDA runtime and NVML calls gpu_tools makes, used when built with SIMULATED_HW
+    Devices are indices below simulation.gpus; every reading follows one load level per device, so
+    utilization, power, temperatures and performance state rise and fall together as on a real board
+
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_NvmlSim
+#define LibSensorTools_NvmlSim
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "sim_backend.h" // Trajectories and the global simulation config
+#include <cstdio> // snprintf()
+#include <cstring> // strncpy()
+#include <sys/types.h> // uint
+// End Headers
+
+#define SimGpuIdleMilliwatts 60000
+#define SimGpuLimitMilliwatts 300000
+#define SimGpuMemoryBytes (80ull << 30)
+
+// Class and Type declarations
+typedef enum nvmlReturn_enum { NVML_SUCCESS = 0, NVML_ERROR_INVALID_ARGUMENT = 2 } nvmlReturn_t;
+typedef enum cudaError_enum { cudaSuccess = 0 } cudaError_t;
+typedef enum nvmlTemperatureSensors_enum { NVML_TEMPERATURE_GPU = 0 } nvmlTemperatureSensors_t;
+typedef enum nvmlPStates_enum { NVML_PSTATE_0 = 0, NVML_PSTATE_2 = 2, NVML_PSTATE_8 = 8 } nvmlPstates_t;
+#define NVML_FI_DEV_MEMORY_TEMP 82
+typedef unsigned int nvmlDevice_t; // Device index
+typedef struct nvmlUtilization_st { unsigned int gpu, memory; } nvmlUtilization_t;
+typedef struct nvmlMemory_st { unsigned long long total, free, used; } nvmlMemory_t;
+typedef struct nvmlFieldValue_st {
+    unsigned int fieldId;
+    nvmlReturn_t nvmlReturn;
+    union { unsigned int uiVal; unsigned long long ullVal; } value;
+} nvmlFieldValue_t;
+// End Class and Type declarations
+
+// Load of a device in [0, 1]; offsets give each reading its own small wander around it
+static inline double nvml_sim_load(nvmlDevice_t device, int offset = 0, double spread = 0) {
+    double load = sim_value(sim_key("gpu", device, 0), 0, 1) + ((offset == 0) ? 0 : sim_value(sim_key("gpu", device, offset), -spread, spread));
+    return (load < 0) ? 0 : (load > 1) ? 1 : load;
+}
+
+static inline cudaError_t cudaGetDeviceCount(int* count) { *count = simulation.gpus; return cudaSuccess; }
+static inline nvmlReturn_t nvmlInit(void) { return NVML_SUCCESS; }
+static inline nvmlReturn_t nvmlShutdown(void) { return NVML_SUCCESS; }
+static inline nvmlReturn_t nvmlSystemGetCudaDriverVersion(int* version) { *version = 0; return NVML_SUCCESS; }
+static inline nvmlReturn_t nvmlSystemGetDriverVersion(char* version, unsigned int length) {
+    strncpy(version, "simulated", length);
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetHandleByIndex_v2(unsigned int index, nvmlDevice_t* device) {
+    if (static_cast<int>(index) >= simulation.gpus) return NVML_ERROR_INVALID_ARGUMENT;
+    *device = index;
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetName(nvmlDevice_t device, char* name, unsigned int length) {
+    snprintf(name, length, "Simulated GPU %u", device);
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetTemperature(nvmlDevice_t device, nvmlTemperatureSensors_t, unsigned int* temperature) {
+    *temperature = static_cast<unsigned int>(30 + 55 * nvml_sim_load(device, 1, 0.05));
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetFieldValues(nvmlDevice_t device, int count, nvmlFieldValue_t* values) {
+    for (int i = 0; i < count; i++) {
+        values[i].nvmlReturn = (values[i].fieldId == NVML_FI_DEV_MEMORY_TEMP) ? NVML_SUCCESS : NVML_ERROR_INVALID_ARGUMENT;
+        values[i].value.uiVal = static_cast<unsigned int>(32 + 63 * nvml_sim_load(device, 2, 0.05));
+    }
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t device, unsigned int* milliwatts) {
+    *milliwatts = static_cast<unsigned int>(SimGpuIdleMilliwatts + (SimGpuLimitMilliwatts - SimGpuIdleMilliwatts) * nvml_sim_load(device, 3, 0.03));
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetEnforcedPowerLimit(nvmlDevice_t, unsigned int* milliwatts) {
+    *milliwatts = SimGpuLimitMilliwatts;
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t device, nvmlUtilization_t* utilization) {
+    utilization->gpu = static_cast<unsigned int>(100 * nvml_sim_load(device));
+    utilization->memory = static_cast<unsigned int>(100 * nvml_sim_load(device, 4, 0.2));
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetMemoryInfo(nvmlDevice_t device, nvmlMemory_t* memory) {
+    memory->total = SimGpuMemoryBytes;
+    memory->used = static_cast<unsigned long long>(SimGpuMemoryBytes * nvml_sim_load(device, 5, 0.3));
+    memory->free = memory->total - memory->used;
+    return NVML_SUCCESS;
+}
+static inline nvmlReturn_t nvmlDeviceGetPerformanceState(nvmlDevice_t device, nvmlPstates_t* pstate) {
+    double load = nvml_sim_load(device);
+    *pstate = (load > 0.5) ? NVML_PSTATE_0 : (load > 0.1) ? NVML_PSTATE_2 : NVML_PSTATE_8;
+    return NVML_SUCCESS;
+}
+#endif
+
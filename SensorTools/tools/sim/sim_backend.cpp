@@ -0,0 +1,151 @@
+#include "sim_backend.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <sstream> // Splitting specs
+#include <fstream> // Script files
+#include <algorithm> // std::sort, std::upper_bound
+#include "../../io/poll_clock.h" // Simulation time follows the poll clock, virtual or real
+#include <cmath> // sin(), fmod(), floor()
+#include <cstdlib> // strtod(), strtoull()
+// End Headers
+
+#define SimRandomKnots 8 // Random trajectories pick a new level this many times per period
+
+// splitmix64 finalizer: spreads every input bit over the output, so neighbouring keys and knots look unrelated
+static inline uint64_t sim_mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Uniform [0, 1) from a hash
+static inline double sim_fraction(uint64_t x) {
+    return (sim_mix(x) >> 11) * (1. / 9007199254740992.);
+}
+
+static bool parse_number(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+static bool load_script(const std::string& path, sim_config& config, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "Unable to read script '" + path + "'";
+        return false;
+    }
+    config.script.clear();
+    std::string line;
+    for (int number = 1; std::getline(in, line); number++) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t comma = line.find(',');
+        double seconds, level;
+        if (comma == std::string::npos || !parse_number(line.substr(0, comma), seconds) ||
+            !parse_number(line.substr(comma + 1), level) || level < 0 || level > 1) {
+            error = "Script '" + path + "' line " + std::to_string(number) + " is not 'seconds,level' with level 0-1";
+            return false;
+        }
+        config.script.emplace_back(seconds, level);
+    }
+    if (config.script.empty()) {
+        error = "Script '" + path + "' has no points";
+        return false;
+    }
+    std::sort(config.script.begin(), config.script.end());
+    return true;
+}
+
+bool parse_simulation(const std::string& spec, sim_config& config, std::string& error) {
+    config.spec = spec;
+    std::istringstream in(spec);
+    std::string setting;
+    while (std::getline(in, setting, ',')) {
+        size_t equals = setting.find('=');
+        std::string key = (equals == std::string::npos) ? "trajectory" : setting.substr(0, equals),
+                    value = (equals == std::string::npos) ? setting : setting.substr(equals + 1);
+        double number;
+        if (key == "trajectory") {
+            int trajectory = 0;
+            while (trajectory < count_SimTrajectories && value != sim_trajectory_types[trajectory].name) trajectory++;
+            if (trajectory == count_SimTrajectories) {
+                error = "Unknown trajectory '" + value + "', choose from " + sim_trajectory_types[0].name;
+                for (trajectory = 1; trajectory < count_SimTrajectories; trajectory++) error += std::string(", ") + sim_trajectory_types[trajectory].name;
+                return false;
+            }
+            config.trajectory = trajectory;
+        }
+        else if (key == "script") {
+            if (!load_script(value, config, error)) return false;
+            config.trajectory = SimScript;
+        }
+        else if (key == "period" && parse_number(value, number) && number > 0) config.period = number;
+        else if (key == "seed" && parse_number(value, number)) config.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (key == "gpus" && parse_number(value, number) && number >= 0) config.gpus = static_cast<int>(number);
+        else if (key == "nvme" && parse_number(value, number) && number >= 0) config.nvme = static_cast<int>(number);
+        else {
+            error = "Unknown or invalid setting '" + setting + "' (trajectory=NAME, period=SECONDS > 0, seed=N, script=FILE, gpus=N, nvme=N)";
+            return false;
+        }
+    }
+    if (config.trajectory == SimScript && config.script.empty()) {
+        error = "The script trajectory needs script=FILE";
+        return false;
+    }
+    return true;
+}
+
+uint64_t sim_key(const std::string& domain, int device, uint64_t field) {
+    // FNV-1a over the domain name, then mixed with the device and field
+    uint64_t key = 0xcbf29ce484222325ull;
+    for (char c : domain) key = (key ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    return sim_mix(sim_mix(key ^ static_cast<uint64_t>(device)) ^ field);
+}
+
+double sim_level(const sim_config& config, uint64_t key, double t) {
+    uint64_t seeded = sim_mix(key ^ sim_mix(config.seed));
+    // Each key starts at its own point of the period, so identical devices do not move in lockstep
+    double phase = t / config.period + sim_fraction(seeded);
+    switch (config.trajectory) {
+        case SimConstant:
+            return sim_fraction(seeded);
+        case SimRamp: {
+            double cycle = phase - floor(phase);
+            return (cycle < 0.5) ? 2 * cycle : 2 - 2 * cycle;
+        }
+        case SimSine:
+            return 0.5 + 0.5 * sin(2 * M_PI * phase);
+        case SimScript: {
+            // Held flat before the first point and after the last
+            const std::vector<std::pair<double, double>>& points = config.script;
+            std::vector<std::pair<double, double>>::const_iterator next = std::upper_bound(points.begin(), points.end(), std::make_pair(t, 2.));
+            if (next == points.begin()) return points.front().second;
+            if (next == points.end()) return points.back().second;
+            std::vector<std::pair<double, double>>::const_iterator prev = next - 1;
+            return prev->second + (next->second - prev->second) * (t - prev->first) / (next->first - prev->first);
+        }
+        case SimRandom:
+        default: {
+            // Value noise: a random level at each knot, eased between them so rates of change stay bounded
+            double knots = phase * SimRandomKnots, knot = floor(knots), f = knots - knot;
+            double a = sim_fraction(seeded ^ static_cast<uint64_t>(static_cast<int64_t>(knot))),
+                   b = sim_fraction(seeded ^ static_cast<uint64_t>(static_cast<int64_t>(knot) + 1));
+            return a + (b - a) * f * f * (3 - 2 * f);
+        }
+    }
+}
+
+double sim_time(void) {
+    static const PollClock::time_point sim_start = poll_clock.now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(poll_clock.now() - sim_start).count() / 1e9;
+}
+
+double sim_value(uint64_t key, double lo, double hi) {
+    return lo + (hi - lo) * sim_level(simulation, key, sim_time());
+}
+
+// Definition of external variables for simulated devices
+sim_config simulation;
+
@@ -0,0 +1,63 @@
+/*
+    May be pulled in multiple times in multi-file linking
+    only define once
+*/
+
+#ifndef LibSensorTools_SimBackend
+#define LibSensorTools_SimBackend
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "../../enums.h" // SimTrajectories
+#include <string> // Specs, keys and errors
+#include <vector> // Script points
+#include <utility> // std::pair
+#include <cstdint> // uint64_t
+// End Headers
+
+#define SimDefaultGpus 4 // NVML devices reported when -X does not say
+#define SimDefaultNvme 2 // NVMe controllers reported when -X does not say
+
+// Class and Type declarations
+// How each SimTrajectories value is named on the command line and in help
+typedef struct sim_trajectory_type_t {
+    const char* name;
+    const char* description;
+} sim_trajectory_type;
+static const sim_trajectory_type sim_trajectory_types[count_SimTrajectories] = {
+    {"constant", "a fixed level per value"},
+    {"ramp", "up and back down once per period"},
+    {"sine", "one sinusoid per period"},
+    {"random", "smooth random walk turning about 8 times per period"},
+    {"script", "piecewise-linear levels from script=FILE, one 'seconds,level' line per point, level 0-1"},
+};
+
+// Simulated devices and how their values move, from -X | --simulate
+typedef struct sim_config_t {
+    std::string spec; // As given, for the argument dump
+    int trajectory = SimRandom; // SimTrajectories
+    double period = 60; // Seconds
+    uint64_t seed = 1;
+    std::vector<std::pair<double, double>> script; // (seconds, level), ascending seconds
+    int gpus = SimDefaultGpus, nvme = SimDefaultNvme;
+} sim_config;
+// End Class and Type declarations
+
+// Function declarations
+// Parse comma-separated key=value settings: trajectory (or a bare trajectory name), period, seed, script, gpus, nvme
+bool parse_simulation(const std::string& spec, sim_config& config, std::string& error);
+// Stable key of one simulated value, ie: ("gpu", 3, field) or ("pdu", 0, oid hash)
+uint64_t sim_key(const std::string& domain, int device, uint64_t field);
+// Level in [0, 1] of a key t seconds into a run; every key moves independently but reproducibly for a seed
+double sim_level(const sim_config& config, uint64_t key, double t);
+// Seconds on the poll clock since the simulation was first read, so a virtual clock fast-forwards devices too
+double sim_time(void);
+// Current value of a key between lo and hi under the global simulation
+double sim_value(uint64_t key, double lo, double hi);
+// End Function declarations
+
+// External variable declarations
+extern sim_config simulation;
+// End External variable declarations
+#endif
+
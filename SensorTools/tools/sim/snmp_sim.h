@@ -0,0 +1,125 @@
+/*
+    Stand-in for the SNMP connection interface of snmp.c, used when built with SIMULATED_HW
+    Every endpoint opens without DNS or sockets; each GetRequest sent is answered on the next receive with a
+    GetResponse carrying an INTEGER per requested OID, following the simulation for that endpoint and OID
+    Messages are still built and parsed by the real snmp.c and pdu_tools code
+
+    Include after snmp.c, once per program
+*/
+
+#ifndef LibSensorTools_SnmpSim
+#define LibSensorTools_SnmpSim
+
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include "sim_backend.h" // Trajectories and the global simulation config
+#include "../pdu/snmp.h" // byte, SNMP types, encodeLen(), decodeLen()
+#include <map> // Agent state by descriptor
+#include <vector> // Messages
+#include <fcntl.h> // open()
+// End Headers
+
+// Values stay within one INTEGER content byte, ie: a load in tenths of amps up to 12.0 A
+#define SnmpSimMaxValue 120
+
+// Class and Type declarations
+typedef struct snmp_sim_agent_t {
+    int host; // Order the endpoint was opened in
+    std::vector<byte> request; // Last message sent, answered by the next receive
+} snmp_sim_agent;
+// End Class and Type declarations
+
+static std::map<int, snmp_sim_agent> snmp_sim_agents;
+static int snmp_sim_hosts = 0;
+
+// Bytes in the TLV starting at at, and where its content begins
+static inline size_t snmp_sim_tlv(const byte* at, const byte** content) {
+    size_t len = decodeLen(const_cast<byte*>(at + 1)), header = 1 + getEncodedLenLen(len);
+    if (content != nullptr) *content = at + header;
+    return header + len;
+}
+
+static inline void snmp_sim_append(std::vector<byte>& out, byte type, const std::vector<byte>& content) {
+    byte* len = (byte*)malloc(0);
+    size_t r = encodeLen(content.size(), &len);
+    out.push_back(type);
+    out.insert(out.end(), len, len + r);
+    out.insert(out.end(), content.begin(), content.end());
+    free(len);
+}
+
+// GetResponse to a GetRequest: same version, community and request ID, one INTEGER per varbind OID
+static bool snmp_sim_respond(const snmp_sim_agent& agent, std::vector<byte>& response) {
+    const std::vector<byte>& request = agent.request;
+    if (request.size() < 2 || request[0] != SNMP_Sequence) return false;
+    const byte *version, *pdu, *varbinds;
+    snmp_sim_tlv(request.data(), &version);
+    const byte* community = version + snmp_sim_tlv(version, nullptr);
+    const byte* get = community + snmp_sim_tlv(community, nullptr);
+    if (*get != SNMP_GetReq) return false;
+    snmp_sim_tlv(get, &pdu);
+    // Request ID, error status, error index, then the varbind list
+    const byte* request_id = pdu;
+    const byte* list = request_id + snmp_sim_tlv(request_id, nullptr);
+    list += snmp_sim_tlv(list, nullptr);
+    list += snmp_sim_tlv(list, nullptr);
+    const byte* list_end = list + snmp_sim_tlv(list, &varbinds);
+
+    std::vector<byte> answers;
+    for (const byte* varbind = varbinds; varbind < list_end; varbind += snmp_sim_tlv(varbind, nullptr)) {
+        const byte *oid, *oid_content;
+        snmp_sim_tlv(varbind, &oid);
+        size_t oid_size = snmp_sim_tlv(oid, &oid_content);
+        // FNV-1a of the encoded OID names the field
+        uint64_t field = 0xcbf29ce484222325ull;
+        for (const byte* b = oid_content; b < oid + oid_size; b++) field = (field ^ *b) * 0x100000001b3ull;
+        std::vector<byte> answer(oid, oid + oid_size);
+        answer.insert(answer.end(), {SNMP_Integer, 0x01, static_cast<byte>(sim_value(sim_key("pdu", agent.host, field), 0, SnmpSimMaxValue))});
+        snmp_sim_append(answers, SNMP_Sequence, answer);
+    }
+    std::vector<byte> body(request_id, request_id + snmp_sim_tlv(request_id, nullptr));
+    body.insert(body.end(), {SNMP_Integer, 0x01, 0x00, SNMP_Integer, 0x01, 0x00}); // No error, error index 0
+    snmp_sim_append(body, SNMP_Sequence, answers);
+    std::vector<byte> message(version, get); // Version and community as sent
+    snmp_sim_append(message, SNMP_GetRsp, body);
+    response.clear();
+    snmp_sim_append(response, SNMP_Sequence, message);
+    return true;
+}
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+int openSNMP(const char *host, struct addrinfo **serv_addr) {
+    *serv_addr = NULL;
+    int sockfd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (sockfd >= 0) snmp_sim_agents[sockfd] = {snmp_sim_hosts++, {}};
+    return sockfd;
+}
+
+int sendSNMP(int sockfd, struct addrinfo *serv_addr, byte *msg) {
+    std::map<int, snmp_sim_agent>::iterator agent = snmp_sim_agents.find(sockfd);
+    if (agent == snmp_sim_agents.end()) return -1;
+    agent->second.request.assign(msg, msg + snmp_sim_tlv(msg, nullptr));
+    return 0;
+}
+
+int recvSNMP(int sockfd, struct addrinfo *serv_addr, byte *response, size_t len) {
+    std::map<int, snmp_sim_agent>::iterator agent = snmp_sim_agents.find(sockfd);
+    std::vector<byte> message;
+    if (agent == snmp_sim_agents.end() || !snmp_sim_respond(agent->second, message) || message.size() > len) return -1;
+    memcpy(response, message.data(), message.size());
+    return 0;
+}
+
+void closeSNMP(int sockfd, struct addrinfo *serv_addr) {
+    snmp_sim_agents.erase(sockfd);
+    close(sockfd);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
+
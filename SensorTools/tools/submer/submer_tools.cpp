@@ -1,5 +1,24 @@
 #include "submer_tools.h"
 
+// Fields logged from each pod: key in the API response, log name suffix, human-readable label
+static const char* submer_fields[][3] = {
+    {"temperature", "temperature", "Temperature"},
+    {"consumption", "consumption", "Consumption"},
+    {"dissipation", "dissipation", "Dissipation"},
+    {"dissipationC", "dissipationC", "DissipationC"},
+    {"dissipationW", "dissipationW", "DissipationW"},
+    {"mpue", "mPUE", "mPUE"},
+    {"pump1rpm", "pump1rpm", "Pump 1 RPM"},
+    {"pump2rpm", "pump2rpm", "Pump 2 RPM"},
+    {"cti", "cti", "CTI"},
+    {"cto", "cto", "CTO"},
+    {"cf", "cf", "CF"},
+    {"wti", "wti", "WTI"},
+    {"wto", "wto", "WTO"},
+    {"wf", "wf", "WF"},
+};
+#define N_SUBMER_FIELDS (sizeof(submer_fields) / sizeof(submer_fields[0]))
+
 size_t curlJSONCallback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t real_size = size * nmemb;
 
@@ -49,6 +68,11 @@ void cache_submers(void) {
             candidate->initialSubmerTemperature = candidate->json_data["temperature"];
             if (args.debug >= DebugVerbose)
                 args.error_log << "Finished inspecting submer" << std::endl;
+            std::string id = std::to_string(candidate->index);
+            for (int k = 0; k < N_SUBMER_FIELDS; k++)
+                candidate->channels.push_back(samples.add_channel("submer_" + id + "_" + submer_fields[k][1],
+                                                                  "submer-" + id + "-" + submer_fields[k][1],
+                                                                  "Submer " + std::string(submer_fields[k][2])));
             known_submers.emplace_back(std::move(candidate));
             submers_to_satisfy++;
         }
@@ -95,57 +119,9 @@ int update_submers(void) {
         }
         if (j->json_data["temperature"] <= j->initialSubmerTemperature)
             at_below_initial_temperature++;
-        if (args.debug >= DebugVerbose || update) {
-            switch (args.format) {
-                case OutputCSV:
-                    args.log << "," << j->json_data["temperature"]
-                    << "," << j->json_data["consumption"]
-                    << "," << j->json_data["dissipation"]
-                    << "," << j->json_data["dissipationC"]
-                    << "," << j->json_data["dissipationW"]
-                    << "," << j->json_data["mpue"]
-                    << "," << j->json_data["pump1rpm"]
-                    << "," << j->json_data["pump2rpm"]
-                    << "," << j->json_data["cti"]
-                    << "," << j->json_data["cto"]
-                    << "," << j->json_data["cf"]
-                    << "," << j->json_data["wti"]
-                    << "," << j->json_data["wto"]
-                    << "," << j->json_data["wf"];
-                    break;
-                case OutputHuman:
-                    args.log << "Submer Temperature: " << j->json_data["temperature"] << std::endl
-                    << "Submer Consumption: " << j->json_data["consumption"] << std::endl
-                    << "Submer Dissipation: " << j->json_data["dissipation"] << std::endl
-                    << "Submer DissipationC: " << j->json_data["dissipationC"] << std::endl
-                    << "Submer DissipationW: " << j->json_data["dissipationW"] << std::endl
-                    << "Submer mPUE: " << j->json_data["mpue"] << std::endl
-                    << "Submer Pump 1 RPM: " << j->json_data["pump1rpm"] << std::endl
-                    << "Submer Pump 2 RPM: " << j->json_data["pump2rpm"] << std::endl
-                    << "Submer CTI: " << j->json_data["cti"] << std::endl
-                    << "Submer CTO: " << j->json_data["cto"] << std::endl
-                    << "Submer CF: " << j->json_data["cf"] << std::endl
-                    << "Submer WTI: " << j->json_data["wti"] << std::endl
-                    << "Submer WTO: " << j->json_data["wto"] << std::endl
-                    << "Submer WF: " << j->json_data["wf"] << std::endl;
-                    break;
-                case OutputJSON:
-                    args.log << "\t\"submer-" << j->index << "-temperature\": " << j->json_data["temperature"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-consumption\": " << j->json_data["consumption"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-dissipation\": " << j->json_data["dissipation"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-dissipationC\": " << j->json_data["dissipationC"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-dissipationW\": " << j->json_data["dissipationW"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-mPUE\": " << j->json_data["mpue"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-pump1rpm\": " << j->json_data["pump1rpm"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-pump2rpm\": " << j->json_data["pump2rpm"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-cti\": " << j->json_data["cti"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-cto\": " << j->json_data["cto"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-cf\": " << j->json_data["cf"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-wti\": " << j->json_data["wti"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-wto\": " << j->json_data["wto"] << "," << std::endl
-                    << "\t\"submer-" << j->index << "-wf\": " << j->json_data["wf"] << "," << std::endl;
-                    break;
-            }
+        for (int k = 0; k < N_SUBMER_FIELDS; k++) {
+            const nlohmann::json& value = j->json_data[submer_fields[k][0]];
+            samples.set(j->channels[k], value.is_number() ? value.get<double>() : NAN);
         }
     }
     return at_below_initial_temperature;
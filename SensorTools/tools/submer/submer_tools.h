@@ -1,11 +1,17 @@
 // Headers and why they're included
 // Document necessary compiler flags as needed in full-line comment below the header
+#ifdef SIMULATED_HW
+#include "tools/sim/curl_sim.h" // Simulated pod answering SUBMER_URL
+#else
 #include <curl/curl.h> // curl library
 // Must compile with: -lcurl
+#endif
 #include "submer_api.h"
 // Defines symbol SUBMER_URL as the http API URL for the monitor's JSON
 #include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
 #include <nlohmann/json.hpp> // JSON parsing
+#include <vector> // Channel list
+#include <cmath> // NAN for fields missing from a response
 //End Headers
 
 // Class and Type declarations
@@ -18,6 +24,7 @@ typedef struct submer_cache_t {
     char *response = NULL;
     nlohmann::json json_data;
     double initialSubmerTemperature;
+    std::vector<int> channels; // Sample channel per entry in submer_fields
     // Constructor
     submer_cache_t() {}
     // Destructor
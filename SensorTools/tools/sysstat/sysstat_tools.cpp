@@ -0,0 +1,116 @@
+#include "sysstat_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::replace
+// End Headers
+
+// Files and values read; pressure files need Linux 4.20+ built with CONFIG_PSI
+static std::vector<sysstat_file> sysstat_sources(void) {
+    return {
+        {"/proc/pressure/cpu", {
+            {"some ", "psi_cpu_some", "PSI CPU Some (%)", SysstatStallShare},
+            {"full ", "psi_cpu_full", "PSI CPU Full (%)", SysstatStallShare}}},
+        {"/proc/pressure/memory", {
+            {"some ", "psi_memory_some", "PSI Memory Some (%)", SysstatStallShare},
+            {"full ", "psi_memory_full", "PSI Memory Full (%)", SysstatStallShare}}},
+        {"/proc/pressure/io", {
+            {"some ", "psi_io_some", "PSI IO Some (%)", SysstatStallShare},
+            {"full ", "psi_io_full", "PSI IO Full (%)", SysstatStallShare}}},
+        {"/proc/vmstat", {
+            {"pgfault ", "vmstat_pgfault", "Page Faults (/s)", SysstatRate},
+            {"pgmajfault ", "vmstat_pgmajfault", "Major Page Faults (/s)", SysstatRate},
+            {"pswpin ", "vmstat_pswpin", "Pages Swapped In (/s)", SysstatRate},
+            {"pswpout ", "vmstat_pswpout", "Pages Swapped Out (/s)", SysstatRate},
+            {"numa_miss ", "vmstat_numa_miss", "NUMA Miss Pages (/s)", SysstatRate},
+            {"numa_foreign ", "vmstat_numa_foreign", "NUMA Foreign Pages (/s)", SysstatRate}}},
+        {"/proc/meminfo", {
+            {"MemAvailable:", "meminfo_available", "Memory Available (kB)", SysstatLevel},
+            {"Cached:", "meminfo_cached", "Memory Cached (kB)", SysstatLevel},
+            {"Dirty:", "meminfo_dirty", "Memory Dirty (kB)", SysstatLevel},
+            {"SwapFree:", "meminfo_swap_free", "Swap Free (kB)", SysstatLevel}}},
+    };
+}
+
+static char sysstat_buf[SysstatReadSize];
+static PollClock::time_point sysstat_read; // When known_sysstat was last read
+
+static inline uint64_t sysstat_value(const sysstat_counter& counter, ssize_t nbytes, bool* found = nullptr) {
+    if (counter.kind == SysstatStallShare) {
+        if (found != nullptr) *found = (procfs_find(sysstat_buf, nbytes, counter.key) != nullptr);
+        return procfs_pressure_total(sysstat_buf, nbytes, counter.key);
+    }
+    return procfs_field(sysstat_buf, nbytes, counter.key, found);
+}
+
+void cache_sysstat(void) {
+    // No caching if we aren't going to query system statistics
+    if (!args.sysstat) return;
+
+    std::vector<sysstat_file> sources = sysstat_sources();
+    for (std::vector<sysstat_file>::iterator file = sources.begin(); file != sources.end(); file++) {
+        // Close-on-exec keeps these out of the wrapped command
+        file->fd = open(host_path(file->path).c_str(), O_RDONLY | O_CLOEXEC);
+        ssize_t nbytes = (file->fd >= 0) ? pread(file->fd, sysstat_buf, sizeof(sysstat_buf), 0) : -1;
+        if (nbytes <= 0) {
+            if (args.debug >= DebugMinimal)
+                args.error_log << "Unable to read " << host_path(file->path) << ", its statistics are not tracked" << std::endl;
+            if (file->fd >= 0) close(file->fd);
+            continue;
+        }
+        std::vector<sysstat_counter> present;
+        for (std::vector<sysstat_counter>::iterator counter = file->counters.begin(); counter != file->counters.end(); counter++) {
+            bool found = false;
+            counter->last = sysstat_value(*counter, nbytes, &found);
+            if (!found) {
+                if (args.debug >= DebugVerbose) {
+                    std::string key = counter->key;
+                    key.erase(key.find_last_not_of(' ') + 1);
+                    args.error_log << file->path << " has no " << key << " value, so it is not tracked" << std::endl;
+                }
+                continue;
+            }
+            std::string json = counter->field;
+            std::replace(json.begin(), json.end(), '_', '-');
+            counter->channel = samples.add_channel(counter->field, json, counter->human);
+            present.push_back(*counter);
+        }
+        file->counters = present;
+        known_sysstat.push_back(*file);
+    }
+    sysstat_read = poll_clock.now();
+    if (known_sysstat.empty()) {
+        args.error_log << "No system statistics could be read, no longer tracking" << std::endl;
+        args.sysstat = false;
+    }
+}
+
+void update_sysstat(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update system statistics" << std::endl;
+    PollClock::time_point now = poll_clock.now();
+    double elapsed_us = std::chrono::duration_cast<std::chrono::nanoseconds>(now - sysstat_read).count() / 1e3;
+    if (elapsed_us <= 0) return;
+    sysstat_read = now;
+    for (std::vector<sysstat_file>::iterator file = known_sysstat.begin(); file != known_sysstat.end(); file++) {
+        ssize_t nbytes = pread(file->fd, sysstat_buf, sizeof(sysstat_buf), 0);
+        if (nbytes <= 0) {
+            if (args.debug >= DebugMinimal) args.error_log << "Unable to update " << file->path << std::endl;
+            continue;
+        }
+        for (std::vector<sysstat_counter>::iterator counter = file->counters.begin(); counter != file->counters.end(); counter++) {
+            uint64_t value = sysstat_value(*counter, nbytes);
+            if (counter->kind == SysstatLevel) {
+                samples.set(counter->channel, value);
+                continue;
+            }
+            // Counters only step back if the kernel resets them, which counts as no change
+            double change = (value > counter->last) ? value - counter->last : 0;
+            samples.set(counter->channel, change * ((counter->kind == SysstatRate) ? 1e6 : 100.) / elapsed_us);
+            counter->last = value;
+        }
+    }
+}
+
+// Definition of external variables for system statistics tools
+std::vector<sysstat_file> known_sysstat;
+
@@ -0,0 +1,46 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/procfs_parse.h" // Keyed counter parsing of procfs files
+#include "io/poll_clock.h" // Poll intervals for rates
+// End Headers
+
+#define SysstatReadSize 16384 // /proc/vmstat is the largest file read, a few kilobytes
+
+
+// Class and Type declarations
+// One value taken from a system statistics file
+typedef struct sysstat_counter_t {
+    const char* key; // Including its separator, ie: "pgfault " or "MemAvailable:"; "some "/"full " lines of pressure files
+    const char* field; // Channel name component
+    const char* human; // Human-readable channel name
+    int kind; // SysstatValueKinds
+    uint64_t last = 0; // Counter at the previous poll
+    int channel = -1; // Sample channel
+} sysstat_counter;
+
+// A procfs file kept open and read with a single pread() per poll
+typedef struct sysstat_file_t {
+    const char* path;
+    std::vector<sysstat_counter> counters;
+    int fd = -1;
+} sysstat_file;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_sysstat(void);
+void update_sysstat(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<sysstat_file> known_sysstat;
+// End External variable declarations
+
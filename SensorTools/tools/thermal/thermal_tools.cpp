@@ -0,0 +1,152 @@
+#include "thermal_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::sort, std::replace
+#include <fstream> // Zone types and trip points, read once at cache time
+#include <sstream> // Trip point summary for the error log
+// End Headers
+
+// Indices of every <prefix>N under ThermalRoot, ascending, so thermal_zone10 follows thermal_zone9
+static std::vector<int> thermal_indices(const std::string& prefix) {
+    std::vector<int> indices;
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(host_path(ThermalRoot), ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 && isdigit(name[prefix.size()]))
+            indices.push_back(atoi(name.c_str() + prefix.size()));
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+static std::string read_thermal_line(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Open a polled attribute and register it with sysfs_reads; returns its first value through value
+static bool open_thermal_file(const std::filesystem::path& path, int& fd, int& slot, int64_t& value) {
+    char buf[SysfsReadSize] = {0};
+    // Close-on-exec keeps these out of the wrapped command
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    // Disabled zones and some emulated sensors fail every read (EINVAL, ENODATA)
+    ssize_t nbytes = (fd >= 0) ? pread(fd, buf, sizeof(buf), 0) : -1;
+    if (nbytes <= 0 || (slot = sysfs_reads.add(fd)) < 0) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+        if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to read " << path << ", so it is not cached" << std::endl;
+        return false;
+    }
+    value = parse_sysfs_int(buf, nbytes);
+    return true;
+}
+
+static void cache_thermal_zones(void) {
+    std::vector<int> indices = thermal_indices("thermal_zone");
+    for (std::vector<int>::iterator index = indices.begin(); index != indices.end(); index++) {
+        std::filesystem::path dir = std::filesystem::path(host_path(ThermalRoot)) / ("thermal_zone" + std::to_string(*index));
+        thermal_zone_cache candidate;
+        candidate.index = *index;
+        candidate.type = read_thermal_line(dir / "type");
+        std::replace(candidate.type.begin(), candidate.type.end(), ' ', '-');
+        int64_t millidegrees;
+        if (!open_thermal_file(dir / "temp", candidate.fd, candidate.slot, millidegrees)) continue;
+        candidate.temperature = candidate.initial = millidegrees / 1000.;
+        // Trip points are numbered densely from 0
+        std::ostringstream summary;
+        for (int trip = 0; ; trip++) {
+            std::string type = read_thermal_line(dir / ("trip_point_" + std::to_string(trip) + "_type")),
+                        temp = read_thermal_line(dir / ("trip_point_" + std::to_string(trip) + "_temp"));
+            if (type.empty() || temp.empty()) break;
+            thermal_trip t = {type, atoll(temp.c_str()) / 1000.};
+            candidate.trips.push_back(t);
+            summary << " " << t.type << "@" << t.temperature;
+            // Active trips only start fans; the others are where the platform starts throttling or shuts down
+            // Unprogrammed trips read as 0 or below
+            if (t.type != "active" && t.temperature > 0 && (candidate.headroom_channel < 0 || t.temperature < candidate.limit)) {
+                candidate.limit = t.temperature;
+                candidate.headroom_channel = 0;
+            }
+        }
+        std::string zone = std::to_string(*index) + "_" + candidate.type;
+        candidate.channel = samples.add_channel("thermal_" + zone + "_temperature",
+                                                "thermal-" + zone + "-temperature",
+                                                "Thermal Zone " + std::to_string(*index) + " " + candidate.type);
+        if (candidate.headroom_channel >= 0)
+            candidate.headroom_channel = samples.add_channel("thermal_" + zone + "_headroom",
+                                                             "thermal-" + zone + "-headroom",
+                                                             "Thermal Zone " + std::to_string(*index) + " " + candidate.type + " Headroom (C below " + std::to_string(static_cast<int>(candidate.limit)) + " C trip)");
+        thermal_to_satisfy++;
+        known_thermal_zones.push_back(candidate);
+        if (args.debug >= DebugMinimal)
+            args.error_log << "Tracking thermal zone " << *index << " (" << candidate.type << ") with trip points:" <<
+                              (candidate.trips.empty() ? " none" : summary.str()) << std::endl;
+    }
+}
+
+static void cache_cooling_devices(void) {
+    std::vector<int> indices = thermal_indices("cooling_device");
+    for (std::vector<int>::iterator index = indices.begin(); index != indices.end(); index++) {
+        std::filesystem::path dir = std::filesystem::path(host_path(ThermalRoot)) / ("cooling_device" + std::to_string(*index));
+        cooling_device_cache candidate;
+        candidate.index = *index;
+        candidate.type = read_thermal_line(dir / "type");
+        std::replace(candidate.type.begin(), candidate.type.end(), ' ', '-');
+        candidate.max_state = strtoull(read_thermal_line(dir / "max_state").c_str(), nullptr, 10);
+        int64_t state;
+        if (!open_thermal_file(dir / "cur_state", candidate.fd, candidate.slot, state)) continue;
+        candidate.state = state;
+        std::string device = std::to_string(*index) + "_" + candidate.type;
+        candidate.channel = samples.add_channel("cooling_" + device + "_state",
+                                                "cooling-" + device + "-state",
+                                                "Cooling Device " + std::to_string(*index) + " " + candidate.type + " State (of " + std::to_string(candidate.max_state) + ")");
+        known_cooling_devices.push_back(candidate);
+        if (args.debug >= DebugVerbose)
+            args.error_log << "Tracking cooling device " << *index << " (" << candidate.type << ") with " << candidate.max_state << " states" << std::endl;
+    }
+}
+
+void cache_thermal(void) {
+    // No caching if we aren't going to query thermal zones
+    if (!args.thermal) return;
+
+    cache_thermal_zones();
+    cache_cooling_devices();
+    if (known_thermal_zones.empty() && known_cooling_devices.empty()) {
+        args.error_log << "No readable thermal zones or cooling devices under " << host_path(ThermalRoot) << ", no longer tracking" << std::endl;
+        args.thermal = false;
+    }
+    else if (args.debug >= DebugMinimal)
+        args.error_log << "Tracking " << known_thermal_zones.size() << " thermal zones and " << known_cooling_devices.size() << " cooling devices" << std::endl;
+}
+
+int update_thermal(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update thermal zones" << std::endl;
+    // Zones and cooling devices were read by sysfs_reads at the start of this poll
+    int at_below_initial_temperature = 0;
+    for (std::vector<thermal_zone_cache>::iterator i = known_thermal_zones.begin(); i != known_thermal_zones.end(); i++) {
+        if (sysfs_reads.length(i->slot) > 0) i->temperature = sysfs_reads.signed_value(i->slot) / 1000.;
+        else if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to update thermal zone " << i->index << std::endl;
+        if (i->temperature <= i->initial) at_below_initial_temperature++;
+        samples.set(i->channel, i->temperature);
+        if (i->headroom_channel >= 0) samples.set(i->headroom_channel, i->limit - i->temperature);
+    }
+    for (std::vector<cooling_device_cache>::iterator i = known_cooling_devices.begin(); i != known_cooling_devices.end(); i++) {
+        if (sysfs_reads.length(i->slot) > 0) i->state = sysfs_reads.value(i->slot);
+        else if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to update cooling device " << i->index << std::endl;
+        samples.set(i->channel, i->state);
+    }
+    return at_below_initial_temperature;
+}
+
+// Definition of external variables for thermal tools
+std::vector<thermal_zone_cache> known_thermal_zones;
+std::vector<cooling_device_cache> known_cooling_devices;
+int thermal_to_satisfy = 0;
+
@@ -0,0 +1,60 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include <filesystem> // thermal class directory traversal
+// May require on some systems: -lstdc++fs
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/sysfs_parse.h" // Branch-free sysfs integer parsing
+#include "io/sysfs_reader.h" // Batched per-poll reads of cached files
+// End Headers
+
+#define ThermalRoot "/sys/class/thermal"
+
+
+// Class and Type declarations
+// One trip point of a zone, ie: passive at 95 C; fixed for the life of the zone
+typedef struct thermal_trip_t {
+    std::string type; // active, passive, hot or critical
+    double temperature; // Degrees C
+} thermal_trip;
+
+// One thermal_zone*, the kernel's own view of a temperature (often the only one on ARM boards, laptops and VMs)
+typedef struct thermal_zone_cache_t {
+    // IDs
+    int index; // The 0 in thermal_zone0
+    std::string type; // ie: x86_pkg_temp, cpu-thermal, acpitz
+    int fd = -1, slot = -1; // temp, registered with sysfs_reads
+    double temperature = 0, initial = 0; // Degrees C
+    std::vector<thermal_trip> trips; // Read once at cache time
+    double limit = 0; // Lowest passive, hot or critical trip; only meaningful with headroom_channel >= 0
+    int channel, headroom_channel = -1; // Sample channels
+} thermal_zone_cache;
+
+// One cooling_device* (fan, processor P-state clamp, ...), reported by its current state
+typedef struct cooling_device_cache_t {
+    int index; // The 0 in cooling_device0
+    std::string type; // ie: Processor, Fan, intel_powerclamp
+    int fd = -1, slot = -1; // cur_state, registered with sysfs_reads
+    uint64_t max_state = 0, state = 0;
+    int channel; // Sample channel
+} cooling_device_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_thermal(void);
+int update_thermal(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<thermal_zone_cache> known_thermal_zones;
+extern std::vector<cooling_device_cache> known_cooling_devices;
+extern int thermal_to_satisfy;
+// End External variable declarations
+
@@ -0,0 +1,126 @@
+#include "uncore_tools.h"
+
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include <algorithm> // std::sort
+#include <fstream> // Limits and IDs, read once at cache time
+// End Headers
+
+static uint64_t read_uncore_value(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    uint64_t value = 0;
+    in >> value;
+    return value;
+}
+
+// Subdirectories of root starting with prefix, sorted by name (uncore IDs are zero-padded)
+static std::vector<std::string> uncore_dirs(const std::string& root, const std::string& prefix) {
+    std::vector<std::string> dirs;
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(root, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) == 0) dirs.push_back(name);
+    }
+    std::sort(dirs.begin(), dirs.end());
+    return dirs;
+}
+
+// Open the domain's current frequency and register its channel
+static void add_uncore(uncore_cache& candidate, const std::filesystem::path& current, const std::string& human) {
+    char buf[SysfsReadSize] = {0};
+    // Close-on-exec keeps these out of the wrapped command
+    candidate.fd = open(current.c_str(), O_RDONLY | O_CLOEXEC);
+    ssize_t nbytes = (candidate.fd >= 0) ? pread(candidate.fd, buf, sizeof(buf), 0) : -1;
+    if (nbytes <= 0 || (candidate.slot = sysfs_reads.add(candidate.fd)) < 0) {
+        // current_freq_khz only exists since Linux 6.3; older kernels expose the limits alone
+        if (candidate.fd >= 0) close(candidate.fd);
+        if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to read " << current << ", " << candidate.label << " is not tracked" << std::endl;
+        return;
+    }
+    candidate.khz = parse_sysfs_uint(buf, nbytes) / candidate.divisor;
+    std::string json = candidate.label;
+    std::replace(json.begin(), json.end(), '_', '-');
+    candidate.channel = samples.add_channel(candidate.label + "_freq", json + "-frequency",
+                                            human + " Frequency (kHz, " + std::to_string(candidate.min_khz) + "-" + std::to_string(candidate.max_khz) + ")");
+    known_uncore.push_back(candidate);
+    if (args.debug >= DebugVerbose)
+        args.error_log << "Tracking " << candidate.label << " from " << current << std::endl;
+}
+
+// Intel uncore domains: package_XX_die_YY on older kernels, uncoreNN (with package_id and domain_id) where TPMI provides them
+static void cache_intel_uncore(void) {
+    std::vector<std::string> dirs = uncore_dirs(host_path(UncoreRoot), "uncore");
+    bool tpmi = !dirs.empty();
+    if (!tpmi) dirs = uncore_dirs(host_path(UncoreRoot), "package_");
+    for (std::vector<std::string>::iterator d = dirs.begin(); d != dirs.end(); d++) {
+        std::filesystem::path dir = std::filesystem::path(host_path(UncoreRoot)) / *d;
+        uncore_cache candidate;
+        candidate.dir = dir.string();
+        std::string package, domain;
+        if (tpmi) {
+            package = std::to_string(read_uncore_value(dir / "package_id"));
+            domain = "domain_" + std::to_string(read_uncore_value(dir / "domain_id"));
+        }
+        else {
+            // package_XX_die_YY
+            package = std::to_string(atoi(d->c_str() + 8));
+            size_t die = d->find("_die_");
+            domain = "die_" + std::to_string((die == std::string::npos) ? 0 : atoi(d->c_str() + die + 5));
+        }
+        candidate.label = "uncore_package_" + package + "_" + domain;
+        candidate.min_khz = read_uncore_value(dir / "min_freq_khz");
+        candidate.max_khz = read_uncore_value(dir / "max_freq_khz");
+        std::string human = domain;
+        std::replace(human.begin(), human.end(), '_', ' ');
+        human[0] = toupper(human[0]);
+        add_uncore(candidate, dir / "current_freq_khz", "Uncore Package " + package + " " + human);
+    }
+}
+
+// devfreq devices report Hz
+static void cache_devfreq(void) {
+    std::vector<std::string> dirs = uncore_dirs(host_path(DevfreqRoot), "");
+    for (std::vector<std::string>::iterator d = dirs.begin(); d != dirs.end(); d++) {
+        std::filesystem::path dir = std::filesystem::path(host_path(DevfreqRoot)) / *d;
+        uncore_cache candidate;
+        candidate.dir = dir.string();
+        candidate.divisor = 1000;
+        // Device names look like dmc or ff9a0000.gpu
+        std::string name = *d;
+        std::replace(name.begin(), name.end(), '.', '_');
+        candidate.label = "devfreq_" + name;
+        candidate.min_khz = read_uncore_value(dir / "min_freq") / candidate.divisor;
+        candidate.max_khz = read_uncore_value(dir / "max_freq") / candidate.divisor;
+        add_uncore(candidate, dir / "cur_freq", "Devfreq " + *d);
+    }
+}
+
+void cache_uncore(void) {
+    // No caching if we aren't going to query uncore frequencies
+    if (!args.uncore) return;
+
+    cache_intel_uncore();
+    cache_devfreq();
+    if (known_uncore.empty()) {
+        args.error_log << "No readable uncore or devfreq frequencies under " << host_path(UncoreRoot) << " or " << host_path(DevfreqRoot) << ", no longer tracking" << std::endl;
+        args.uncore = false;
+    }
+    else if (args.debug >= DebugMinimal)
+        args.error_log << "Tracking " << known_uncore.size() << " uncore and devfreq frequencies" << std::endl;
+}
+
+void update_uncore(void) {
+    if (args.debug >= DebugVerbose) args.error_log << "Update uncore frequencies" << std::endl;
+    // Frequencies were read by sysfs_reads at the start of this poll
+    for (std::vector<uncore_cache>::iterator i = known_uncore.begin(); i != known_uncore.end(); i++) {
+        if (sysfs_reads.length(i->slot) > 0) i->khz = sysfs_reads.value(i->slot) / i->divisor;
+        else if (args.debug >= DebugMinimal)
+            args.error_log << "Unable to update " << i->label << std::endl;
+        samples.set(i->channel, i->khz);
+    }
+}
+
+// Definition of external variables for uncore tools
+std::vector<uncore_cache> known_uncore;
+
@@ -0,0 +1,43 @@
+// Headers and why they're included
+// Document necessary compiler flags beside each header as needed in full-line comment below the header
+#include <vector> // vector type and operations
+#include <string> // string data type
+#include <fcntl.h> // open()
+#include <unistd.h> // pread(), close()
+#include <filesystem> // uncore and devfreq directory traversal
+// May require on some systems: -lstdc++fs
+#include "io/argparse_libsensors.h" // Debug levels, arguments, Output class
+#include "io/sysfs_parse.h" // Branch-free sysfs integer parsing
+#include "io/sysfs_reader.h" // Batched per-poll reads of cached files
+// End Headers
+
+#define UncoreRoot "/sys/devices/system/cpu/intel_uncore_frequency"
+#define DevfreqRoot "/sys/class/devfreq"
+
+
+// Class and Type declarations
+// One frequency domain outside the cores: an Intel uncore (ring/mesh, LLC, memory controller) or a devfreq device (memory bus, GPU, NPU)
+typedef struct uncore_cache_t {
+    // IDs
+    std::string label; // Channel name, ie: uncore_package_0_die_0, devfreq_dmc
+    std::string dir; // Directory the domain was found in
+    int fd = -1, slot = -1; // current_freq_khz or cur_freq, registered with sysfs_reads
+    uint64_t divisor = 1; // Raw units per kHz: 1 for uncore, 1000 for devfreq (Hz)
+    uint64_t khz = 0, min_khz = 0, max_khz = 0; // Limits are read once at cache time
+    int channel; // Sample channel
+} uncore_cache;
+// End Class and Type declarations
+
+
+
+// Function declarations
+void cache_uncore(void);
+void update_uncore(void);
+// End Function declarations
+
+
+
+// External variable declarations
+extern std::vector<uncore_cache> known_uncore;
+// End External variable declarations
+
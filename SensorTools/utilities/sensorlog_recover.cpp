@@ -0,0 +1,197 @@
+/*
+    sensorlog-recover: repair framed logs (written with -F | --frame) after a crash
+
+    The log is read exactly once, front to back, validating each frame's length and CRC.
+    Everything after the last valid record is torn output from the crash and is truncated away.
+    Optionally, the surviving record payloads are extracted as a plain CSV/JSON/human-readable log.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../io/record_frame.h" // Frame layout, CRC and validation
+
+#include <iostream> // std file descriptors
+#include <fstream> // extraction output
+#include <vector> // read buffer
+#include <string> // String class and manipulation
+#include <cstring> // memmove(), strerror()
+#include <cerrno> // errno
+#include <getopt.h> // provides getopt-long() definition
+#include <fcntl.h> // open(), posix_fadvise()
+#include <unistd.h> // read(), ftruncate(), close()
+#include <sys/stat.h> // fstat() for the file size
+// End Headers
+
+// Class and Type declarations
+typedef struct recovery_t {
+    uint64_t records = 0, sync_points = 0;
+    size_t valid_end = 0, last_sync_end = 0, file_size = 0;
+    bool first_payload_seen = false, json = false;
+    std::string last_payload;
+} recovery;
+// End Class and Type declarations
+
+#define RecoverReadSize (4u << 20)
+
+void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] log [log ...]" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-n | --dry-run\n\t\t" <<
+                 "Report the last valid record without truncating the log" << std::endl;
+    std::cout << "\t-x [file] | --extract [file]\n\t\t" <<
+                 "Write the recovered (unframed) records to [file]; only valid with a single log" << std::endl;
+    std::cout << "\t-q | --quiet\n\t\t" <<
+                 "Only report errors" << std::endl;
+}
+
+// Scan one framed log; payloads are streamed to extract when it is open
+bool scan_log(int fd, recovery& result, std::ofstream* extract) {
+    std::vector<char> buffer(RecoverReadSize);
+    size_t held = 0, offset = 0; // Bytes carried over from the previous read, file offset of buffer[0]
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    while (1) {
+        if (held == buffer.size()) buffer.resize(buffer.size() * 2); // Only when a single frame exceeds the buffer
+        ssize_t nbytes = read(fd, buffer.data() + held, buffer.size() - held);
+        if (nbytes < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Read failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        size_t avail = held + nbytes, cursor = 0;
+        record_frame_header header;
+        int status = ScanIncomplete;
+        while (cursor < avail) {
+            status = scan_record_frame(buffer.data() + cursor, avail - cursor, &header);
+            if (status != ScanComplete) break;
+            const char* payload = buffer.data() + cursor + sizeof(record_frame_header);
+            cursor += sizeof(record_frame_header) + header.length;
+            result.valid_end = offset + cursor;
+            if (header.kind == FrameSync) {
+                result.sync_points++;
+                result.last_sync_end = result.valid_end;
+                continue;
+            }
+            result.records++;
+            if (!result.first_payload_seen) {
+                result.first_payload_seen = true;
+                result.json = (header.length > 0 && payload[0] == '[');
+            }
+            if (extract != nullptr) {
+                // Hold back the latest payload so a JSON log can be closed properly at the end
+                extract->write(result.last_payload.data(), result.last_payload.size());
+                result.last_payload.assign(payload, header.length);
+            }
+        }
+        if (status == ScanCorrupt) return true; // Torn or garbage tail; everything before valid_end is good
+        if (nbytes == 0) return true; // EOF, possibly with an incomplete frame held
+        // Carry the partial frame over to the next read
+        std::memmove(buffer.data(), buffer.data() + cursor, avail - cursor);
+        held = avail - cursor;
+        offset += cursor;
+    }
+}
+
+// A crashed JSON log ends mid-array; drop the dangling separator and close it
+// A cleanly closed log ends with the footer, written as a record of its own holding only "]"
+void finish_extract(recovery& result, std::ofstream& extract) {
+    size_t start = result.last_payload.find_first_not_of(" \t\r\n"),
+           end = result.last_payload.find_last_not_of(" \t\r\n");
+    bool closed = (start != std::string::npos && start == end && result.last_payload[end] == ']');
+    if (result.json && !closed) {
+        if (end != std::string::npos && result.last_payload[end] == ',') result.last_payload.erase(end);
+        else if (end != std::string::npos) result.last_payload.erase(end+1);
+        result.last_payload += "\n]\n";
+    }
+    extract.write(result.last_payload.data(), result.last_payload.size());
+}
+
+int main(int argc, char** argv) {
+    bool dry_run = false, quiet = false;
+    char* extract_path = nullptr;
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"dry-run", no_argument, 0, 'n'},
+        {"extract", required_argument, 0, 'x'},
+        {"quiet", no_argument, 0, 'q'},
+        {0,0,0,0}
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "hnx:q", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 'n':
+                dry_run = true;
+                break;
+            case 'x':
+                extract_path = optarg;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind >= argc || (extract_path != nullptr && argc - optind != 1)) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    int failures = 0;
+    for (int i = optind; i < argc; i++) {
+        int fd = open(argv[i], dry_run ? O_RDONLY : O_RDWR);
+        if (fd == -1) {
+            std::cerr << "Failed to open '" << argv[i] << "': " << strerror(errno) << std::endl;
+            failures++;
+            continue;
+        }
+        std::ofstream extract;
+        if (extract_path != nullptr) {
+            extract.open(extract_path, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!extract.is_open()) {
+                std::cerr << "Failed to open '" << extract_path << "' for extraction" << std::endl;
+                close(fd);
+                exit(EXIT_FAILURE);
+            }
+        }
+        recovery result;
+        struct stat info;
+        if (fstat(fd, &info) == 0) result.file_size = info.st_size;
+        if (!scan_log(fd, result, extract.is_open() ? &extract : nullptr)) {
+            failures++;
+            close(fd);
+            continue;
+        }
+        // Never truncate something that was not written with framing in the first place
+        if (result.valid_end == 0 && result.file_size > 0) {
+            std::cerr << "'" << argv[i] << "' does not begin with a valid record frame; leaving it untouched" << std::endl;
+            failures++;
+            close(fd);
+            continue;
+        }
+        if (extract.is_open()) finish_extract(result, extract);
+        size_t discarded = result.file_size - result.valid_end;
+        if (!quiet) {
+            std::cout << argv[i] << ": " << result.records << " records, " << result.sync_points <<
+                         " sync points, last valid byte " << result.valid_end << " of " << result.file_size;
+            if (result.sync_points > 0) std::cout << " (last sync point at " << result.last_sync_end << ")";
+            std::cout << std::endl;
+        }
+        if (discarded > 0) {
+            if (dry_run) {
+                if (!quiet) std::cout << "\tWould truncate " << discarded << " trailing bytes" << std::endl;
+            }
+            else if (ftruncate(fd, result.valid_end) == -1) {
+                std::cerr << "Failed to truncate '" << argv[i] << "': " << strerror(errno) << std::endl;
+                failures++;
+            }
+            else if (!quiet) std::cout << "\tTruncated " << discarded << " trailing bytes" << std::endl;
+        }
+        close(fd);
+    }
+    return (failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
@@ -0,0 +1,378 @@
+/*
+    sensorstat: summarize finished logs without a plotting session
+
+    Every log is loaded with the parallel log reader and split into phases using its event timeline:
+        all             every sample
+        initial-wait    initial-wait-start .. initial-wait-end (the idle baseline)
+        wrapped-command initial-wait-end .. wrapped-command-end
+        post-command    wrapped-command-end .. end of log
+    Events carry the number of samples logged so far, so phase boundaries are exact rows rather than timestamps.
+    CSV logs keep their events in a sidecar (-E | --events); it is found next to the log as NAME.events.
+
+    For each numeric channel and phase this reports sample count, min/mean/max/std, time spent above a threshold,
+    the time integral (joules for power channels in watts) and, after the wrapped command, the time taken to return
+    within a tolerance of the initial-wait mean.
+    Logs are summarized concurrently by worker threads; results are printed in argument order as they complete.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../reader/log_reader.h" // Parallel log loading
+
+#include <iostream> // std file descriptors
+#include <iomanip> // setw and setprecision
+#include <string> // String class and manipulation
+#include <vector> // Summaries and channel lists
+#include <regex> // Channel selection
+#include <cmath> // NAN, isnan(), sqrt(), fabs()
+#include <thread> // Worker threads
+#include <future> // Ordered hand-off of finished summaries
+#include <atomic> // Shared work index
+#include <filesystem> // Locating event sidecars
+#include <getopt.h> // provides getopt-long() definition
+#include <nlohmann/json.hpp> // JSON output
+// End Headers
+
+// Class and Type declarations
+typedef struct channel_stats_t {
+    size_t samples = 0;
+    double min = NAN, max = NAN, mean = NAN, m2 = 0; // m2: running sum of squared deviations (Welford)
+    double above = 0; // Seconds above the threshold, holding each sample until the next
+    double integral = 0; // Trapezoidal integral over time
+    double recovery = NAN; // Seconds until back within tolerance of the baseline; post-command only
+} channel_stats;
+
+typedef struct phase_stats_t {
+    std::string name;
+    size_t first, last; // Rows [first, last)
+    double start = NAN, end = NAN; // Timestamps of the first and last rows
+    std::vector<channel_stats> channels;
+} phase_stats;
+
+typedef struct log_summary_t {
+    std::string path, error, events_source;
+    bool ok = false, truncated = false;
+    int format = ReaderAuto;
+    size_t rows = 0;
+    std::vector<std::string> channels;
+    std::vector<phase_stats> phases;
+} log_summary;
+
+typedef struct stat_options_t {
+    std::vector<std::regex> channel_filters;
+    double threshold = NAN;
+    double tolerance = 1.0;
+    bool json = false;
+    unsigned threads = 0;
+} stat_options;
+// End Class and Type declarations
+
+void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] log [log ...]" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-c [regex] | --channel [regex]\n\t\t" <<
+                 "Only summarize channels whose name matches [regex]; may be repeated (default: every numeric channel)" << std::endl;
+    std::cout << "\t-T [value] | --threshold [value]\n\t\t" <<
+                 "Report seconds each channel spends above [value] (default: not reported)" << std::endl;
+    std::cout << "\t-b [value] | --baseline-tolerance [value]\n\t\t" <<
+                 "A channel has recovered once it is within [value] of its initial-wait mean (default: 1.0)" << std::endl;
+    std::cout << "\t-j | --json\n\t\t" <<
+                 "Print JSON instead of a table" << std::endl;
+    std::cout << "\t-t [threads] | --threads [threads]\n\t\t" <<
+                 "Worker threads (default: every hardware thread)" << std::endl;
+}
+
+// Events for logs that do not carry them inline: NAME.events or LOG.events beside the log
+static void load_sidecar_events(const std::string& path, sensor_log& log, std::string& source) {
+    std::filesystem::path log_path(path);
+    std::filesystem::path candidates[2] = {std::filesystem::path(log_path).replace_extension(".events"),
+                                           std::filesystem::path(path + ".events")};
+    for (std::filesystem::path& candidate : candidates) {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(candidate, ec)) continue;
+        reader_options options;
+        options.threads = 1;
+        sensor_log sidecar;
+        std::string error;
+        if (read_sensor_log(candidate.string(), options, sidecar, error) != ReaderOK) continue;
+        source = candidate.string();
+        if (!sidecar.events.empty()) {
+            // JSON sidecar
+            log.events = std::move(sidecar.events);
+            return;
+        }
+        // CSV sidecar: one row per event
+        int name = find_log_column(sidecar, "event"), sample = find_log_column(sidecar, "sample"),
+            timestamp = find_log_column(sidecar, "timestamp");
+        if (name < 0 || sample < 0 || sidecar.columns[name].kind != ChannelText) continue;
+        for (size_t r = 0; r < sidecar.rows; r++) {
+            log_event event;
+            event.name = sidecar.columns[name].text[r];
+            event.sample = static_cast<int64_t>(sidecar.columns[sample].values[r]);
+            if (timestamp >= 0) event.timestamp = sidecar.columns[timestamp].values[r];
+            log.events.push_back(event);
+        }
+        return;
+    }
+}
+
+// Row at which the first event with this name was emitted, or -1
+static int64_t event_row(const sensor_log& log, const char* name) {
+    for (std::vector<log_event>::const_iterator i = log.events.begin(); i != log.events.end(); i++)
+        if (i->name == name) return std::min<int64_t>(i->sample, log.rows);
+    return -1;
+}
+
+static void summarize_phase(const sensor_log& log, const std::vector<int>& selected, const stat_options& options, phase_stats& phase) {
+    const std::vector<double>& t = log.columns[0].values;
+    if (phase.last > phase.first) {
+        phase.start = t[phase.first];
+        phase.end = t[phase.last - 1];
+    }
+    phase.channels.resize(selected.size());
+    for (size_t c = 0; c < selected.size(); c++) {
+        const std::vector<double>& v = log.columns[selected[c]].values;
+        channel_stats& stats = phase.channels[c];
+        for (size_t r = phase.first; r < phase.last; r++) {
+            double value = v[r];
+            // Each sample owns the interval up to the next one, even across a phase boundary, so phases add up to the whole run
+            if (r + 1 < t.size()) {
+                double dt = t[r+1] - t[r];
+                if (!std::isnan(options.threshold) && value > options.threshold) stats.above += dt;
+                if (!std::isnan(value) && !std::isnan(v[r+1])) stats.integral += 0.5 * (value + v[r+1]) * dt;
+            }
+            if (std::isnan(value)) continue;
+            if (stats.samples++ == 0) {
+                stats.min = stats.max = stats.mean = value;
+                continue;
+            }
+            stats.min = std::min(stats.min, value);
+            stats.max = std::max(stats.max, value);
+            double delta = value - stats.mean;
+            stats.mean += delta / stats.samples;
+            stats.m2 += delta * (value - stats.mean);
+        }
+    }
+}
+
+static void summarize_log(const std::string& path, const stat_options& options, unsigned reader_threads, log_summary& summary) {
+    summary.path = path;
+    reader_options reader;
+    reader.threads = reader_threads;
+    sensor_log log;
+    if (read_sensor_log(path, reader, log, summary.error) != ReaderOK) return;
+    summary.format = log.format;
+    summary.rows = log.rows;
+    summary.truncated = log.truncated;
+    if (log.columns.empty() || log.columns[0].name != "timestamp") {
+        summary.error = path + ": no timestamp column";
+        return;
+    }
+    if (log.events.empty()) load_sidecar_events(path, log, summary.events_source);
+    else summary.events_source = "inline";
+
+    std::vector<int> selected;
+    for (size_t c = 1; c < log.columns.size(); c++) {
+        if (log.columns[c].kind != ChannelNumeric) continue;
+        bool keep = options.channel_filters.empty();
+        for (std::vector<std::regex>::const_iterator f = options.channel_filters.begin(); !keep && f != options.channel_filters.end(); f++)
+            keep = std::regex_search(log.columns[c].name, *f);
+        if (!keep) continue;
+        selected.push_back(static_cast<int>(c));
+        summary.channels.push_back(log.columns[c].name);
+    }
+
+    int64_t wait_start = event_row(log, "initial-wait-start"), wait_end = event_row(log, "initial-wait-end"),
+            command_end = event_row(log, "wrapped-command-end");
+    summary.phases.push_back({"all", 0, log.rows});
+    int baseline = -1;
+    if (wait_start >= 0 && wait_end >= wait_start) {
+        baseline = static_cast<int>(summary.phases.size());
+        summary.phases.push_back({"initial-wait", static_cast<size_t>(wait_start), static_cast<size_t>(wait_end)});
+    }
+    if (wait_end >= 0 && command_end >= wait_end)
+        summary.phases.push_back({"wrapped-command", static_cast<size_t>(wait_end), static_cast<size_t>(command_end)});
+    if (command_end >= 0)
+        summary.phases.push_back({"post-command", static_cast<size_t>(command_end), log.rows});
+    for (std::vector<phase_stats>::iterator p = summary.phases.begin(); p != summary.phases.end(); p++)
+        summarize_phase(log, selected, options, *p);
+
+    // Recovery: first post-command sample back within tolerance of the initial-wait mean
+    phase_stats& post = summary.phases.back();
+    if (baseline >= 0 && post.name == "post-command") {
+        const std::vector<double>& t = log.columns[0].values;
+        for (size_t c = 0; c < selected.size(); c++) {
+            double reference = summary.phases[baseline].channels[c].mean;
+            if (std::isnan(reference)) continue;
+            const std::vector<double>& v = log.columns[selected[c]].values;
+            for (size_t r = post.first; r < post.last; r++) {
+                if (!std::isnan(v[r]) && std::fabs(v[r] - reference) <= options.tolerance) {
+                    post.channels[c].recovery = t[r] - t[post.first];
+                    break;
+                }
+            }
+        }
+    }
+    summary.ok = true;
+}
+
+static double deviation(const channel_stats& stats) {
+    return (stats.samples > 0) ? std::sqrt(stats.m2 / stats.samples) : NAN;
+}
+
+static void print_table(const log_summary& summary, const stat_options& options) {
+    std::cout << summary.path << " (" << reader_format_name(summary.format) << ", " << summary.rows << " samples";
+    if (summary.truncated) std::cout << ", torn final record dropped";
+    if (summary.events_source.empty()) std::cout << ", no events";
+    else if (summary.events_source != "inline") std::cout << ", events from " << summary.events_source;
+    std::cout << ")" << std::endl;
+    size_t width = 8;
+    for (std::vector<std::string>::const_iterator i = summary.channels.begin(); i != summary.channels.end(); i++)
+        width = std::max(width, i->size() + 2);
+    std::cout << std::left << std::setw(17) << "phase" << std::setw(width) << "channel" << std::right <<
+                 std::setw(9) << "samples" << std::setw(12) << "min" << std::setw(12) << "mean" << std::setw(12) << "max" <<
+                 std::setw(12) << "std" << std::setw(12) << "above(s)" << std::setw(14) << "integral" <<
+                 std::setw(13) << "recovery(s)" << std::endl;
+    std::cout << std::setprecision(6);
+    for (std::vector<phase_stats>::const_iterator p = summary.phases.begin(); p != summary.phases.end(); p++) {
+        for (size_t c = 0; c < summary.channels.size(); c++) {
+            const channel_stats& stats = p->channels[c];
+            std::cout << std::left << std::setw(17) << p->name << std::setw(width) << summary.channels[c] << std::right <<
+                         std::setw(9) << stats.samples << std::setw(12) << stats.min << std::setw(12) << stats.mean <<
+                         std::setw(12) << stats.max << std::setw(12) << deviation(stats);
+            if (std::isnan(options.threshold)) std::cout << std::setw(12) << "-";
+            else std::cout << std::setw(12) << stats.above;
+            std::cout << std::setw(14) << stats.integral;
+            if (p->name == "post-command") std::cout << std::setw(13) << stats.recovery;
+            else std::cout << std::setw(13) << "-";
+            std::cout << std::endl;
+        }
+    }
+    std::cout << std::endl;
+}
+
+static nlohmann::ordered_json summary_json(const log_summary& summary, const stat_options& options) {
+    nlohmann::ordered_json out;
+    out["file"] = summary.path;
+    out["format"] = reader_format_name(summary.format);
+    out["samples"] = summary.rows;
+    out["truncated"] = summary.truncated;
+    out["events"] = summary.events_source.empty() ? nlohmann::ordered_json(nullptr) : nlohmann::ordered_json(summary.events_source);
+    out["phases"] = nlohmann::ordered_json::array();
+    for (std::vector<phase_stats>::const_iterator p = summary.phases.begin(); p != summary.phases.end(); p++) {
+        nlohmann::ordered_json phase;
+        phase["phase"] = p->name;
+        phase["first-sample"] = p->first;
+        phase["last-sample"] = p->last;
+        phase["start"] = p->start;
+        phase["end"] = p->end;
+        phase["channels"] = nlohmann::ordered_json::object();
+        for (size_t c = 0; c < summary.channels.size(); c++) {
+            const channel_stats& stats = p->channels[c];
+            nlohmann::ordered_json channel;
+            channel["samples"] = stats.samples;
+            channel["min"] = stats.min;
+            channel["mean"] = stats.mean;
+            channel["max"] = stats.max;
+            channel["std"] = deviation(stats);
+            if (!std::isnan(options.threshold)) channel["time-above"] = stats.above;
+            channel["integral"] = stats.integral;
+            if (p->name == "post-command") channel["recovery"] = stats.recovery;
+            phase["channels"][summary.channels[c]] = channel;
+        }
+        out["phases"].push_back(phase);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    const struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"channel", required_argument, 0, 'c'},
+        {"threshold", required_argument, 0, 'T'},
+        {"baseline-tolerance", required_argument, 0, 'b'},
+        {"json", no_argument, 0, 'j'},
+        {"threads", required_argument, 0, 't'},
+        {0,0,0,0}
+    };
+    stat_options options;
+    int c;
+    while ((c = getopt_long(argc, argv, "hc:T:b:jt:", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 'c':
+                try {
+                    options.channel_filters.emplace_back(optarg, std::regex::extended);
+                }
+                catch (const std::regex_error& e) {
+                    std::cerr << "Invalid channel regex '" << optarg << "': " << e.what() << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'T':
+                options.threshold = atof(optarg);
+                break;
+            case 'b':
+                options.tolerance = atof(optarg);
+                break;
+            case 'j':
+                options.json = true;
+                break;
+            case 't':
+                options.threads = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    size_t n = argc - optind;
+    unsigned workers = options.threads;
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    // Spare threads go to the reader when there are fewer logs than workers
+    unsigned reader_threads = std::max<unsigned>(1, workers / std::min<size_t>(n, workers));
+    workers = std::min<size_t>(workers, n);
+
+    std::vector<log_summary> summaries(n);
+    std::vector<std::promise<void>> finished(n);
+    std::vector<std::future<void>> ready;
+    for (size_t i = 0; i < n; i++) ready.push_back(finished[i].get_future());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; w++) {
+        pool.emplace_back([&](void) {
+            size_t i;
+            while ((i = next++) < n) {
+                summarize_log(argv[optind + i], options, reader_threads, summaries[i]);
+                finished[i].set_value();
+            }
+        });
+    }
+    int failures = 0;
+    if (options.json) std::cout << "[";
+    bool first = true;
+    for (size_t i = 0; i < n; i++) {
+        ready[i].wait();
+        log_summary& summary = summaries[i];
+        if (!summary.ok) {
+            std::cerr << summary.error << std::endl;
+            failures++;
+        }
+        else if (options.json) {
+            std::cout << (first ? "\n" : ",\n") << summary_json(summary, options).dump(1, '\t');
+            first = false;
+        }
+        else print_table(summary, options);
+        std::cout << std::flush;
+        summaries[i] = log_summary(); // Release as we go; hundreds of runs may be summarized at once
+    }
+    if (options.json) std::cout << "\n]" << std::endl;
+    for (std::vector<std::thread>::iterator i = pool.begin(); i != pool.end(); i++) i->join();
+    return (failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
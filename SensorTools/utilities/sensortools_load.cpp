@@ -0,0 +1,379 @@
+/*
+    sensortools-load: duty-cycled thermal load with phase markers, replacing Benchmarks/pyloop.py
+
+    Pins one thread to each chosen core and runs a kernel on all of them for duty*period seconds out of every period,
+    idling for the rest. Each on/off edge is written as one JSON line, ie:
+        {"phase":"on","cycle":3,"kernel":"avx2","cores":[0,1],"edge-monotonic-ns":123456789}
+    to the FIFO in $SENSORTOOLS_MARKERS (set for commands wrapped by ${hostname}_sensors -m FIFO), to --markers,
+    or to stdout. edge-monotonic-ns is CLOCK_MONOTONIC when the phase flag flipped, the same clock as the sensing
+    tool's monotonic-ns, so edges line up with samples more precisely than the poll interval.
+    Edges are scheduled on absolute times from the start of the run, so they do not drift over long runs.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../io/markers.h" // MarkerEnvironment
+#include <nlohmann/json.hpp> // Marker lines
+
+#include <iostream> // std file descriptors
+#include <string> // String class and manipulation
+#include <vector> // Cores, threads and buffers
+#include <thread> // Workers
+#include <atomic> // Phase flag shared with workers
+#include <mutex> // Waking workers at on edges
+#include <condition_variable> // Waking workers at on edges
+#include <chrono> // Edge schedule
+#include <algorithm> // std::min
+#include <csignal> // Stopping on SIGINT/SIGTERM
+#include <cstring> // strerror()
+#include <cerrno> // errno
+#include <ctime> // clock_gettime()
+#include <fcntl.h> // open()
+#include <unistd.h> // write(), close()
+#include <pthread.h> // pthread_setaffinity_np()
+#include <sched.h> // cpu_set_t
+#include <getopt.h> // provides getopt-long() definition
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // AVX2/AVX-512 intrinsics, compiled per function with target attributes
+#endif
+// End Headers
+
+#define LoadChunkIterations 4096 // Kernel iterations between checks of the phase flag, a few microseconds at most
+#define LoadStreamDefaultMib 64 // Per thread, well past the last level cache
+
+// Class and Type declarations
+enum LoadKernels {
+    LoadScalar, // Four scalar multiply-add chains on the FP ports, never vectorized
+    LoadAvx2, // 256-bit FMA
+    LoadAvx512, // 512-bit FMA
+    LoadStream, // STREAM triad over buffers larger than the caches
+    count_LoadKernels
+};
+
+typedef struct load_options_t {
+    std::vector<int> cores = {0};
+    short kernel = LoadScalar;
+    double duty = 0.5, period = 1.0; // Fraction of each period spent loaded, period in seconds
+    double duration = 0; // Seconds, 0 == until interrupted or cycles are done
+    long cycles = 0; // 0 == until interrupted or duration is done
+    size_t stream_mib = LoadStreamDefaultMib;
+    std::string markers_path; // Empty == $SENSORTOOLS_MARKERS, else stdout
+} load_options;
+// End Class and Type declarations
+
+static const char* kernel_names[count_LoadKernels] = {"scalar", "avx2", "avx512", "stream"};
+
+static load_options options;
+static std::atomic<bool> loaded(false), finished(false);
+static std::mutex phase_lock;
+static std::condition_variable phase_changed;
+static volatile sig_atomic_t stop_requested = 0;
+static int marker_fd = STDOUT_FILENO;
+
+static void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options]" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-c [list] | --cores [list]\n\t\t" <<
+                 "Cores to load, one pinned thread each, ie: 0,2,4-7 (default: 0)" << std::endl;
+    std::cout << "\t-k [kernel] | --kernel [kernel]\n\t\t" <<
+                 "scalar, avx2, avx512 or stream (default: scalar)" << std::endl;
+    std::cout << "\t-d [fraction] | --duty [fraction]\n\t\t" <<
+                 "Fraction of each period spent loaded, 0 < fraction <= 1 (default: " << options.duty << ")" << std::endl;
+    std::cout << "\t-p [seconds] | --period [seconds]\n\t\t" <<
+                 "Length of one on/off cycle (default: " << options.period << ")" << std::endl;
+    std::cout << "\t-t [seconds] | --duration [seconds]\n\t\t" <<
+                 "Stop after [seconds] (default: run until interrupted)" << std::endl;
+    std::cout << "\t-n [cycles] | --cycles [cycles]\n\t\t" <<
+                 "Stop after [cycles] full periods (default: run until interrupted)" << std::endl;
+    std::cout << "\t-s [MiB] | --stream-size [MiB]\n\t\t" <<
+                 "Size of each of the three stream buffers per thread (default: " << options.stream_mib << ")" << std::endl;
+    std::cout << "\t-m [path] | --markers [path]\n\t\t" <<
+                 "Write phase markers to [path] (default: $" << MarkerEnvironment << ", else stdout)" << std::endl;
+}
+
+static void on_signal(int) {
+    stop_requested = 1;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+}
+
+// Accepts comma-separated cores and inclusive ranges, ie: 0,2,4-7
+static bool parse_cores(const std::string& list, std::vector<int>& cores) {
+    cores.clear();
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(start, end - start);
+        size_t dash = item.find('-');
+        char* rest;
+        long first = strtol(item.c_str(), &rest, 10), last = first;
+        if (item.empty() || rest == item.c_str()) return false;
+        if (dash != std::string::npos) {
+            const char* upper = item.c_str() + dash + 1;
+            last = strtol(upper, &rest, 10);
+            if (rest == upper) return false;
+        }
+        if (*rest != '\0' || first < 0 || last < first || last >= CPU_SETSIZE) return false;
+        for (long core = first; core <= last; core++) cores.push_back(static_cast<int>(core));
+        start = end + 1;
+    }
+    return !cores.empty();
+}
+
+// Kernels run LoadChunkIterations steps and return something derived from every step, so none are optimized out
+// The four chains are independent, so -O3 would otherwise pack them into one vector register
+__attribute__((optimize("no-tree-vectorize")))
+static double scalar_chunk(double seed) {
+    double a = seed, b = seed * 0.5, c = seed * 0.25, d = seed * 0.125;
+    for (int i = 0; i < LoadChunkIterations; i++) {
+        a = a * 0.999999 + 1e-7;
+        b = b * 0.999999 + 1e-7;
+        c = c * 0.999999 + 1e-7;
+        d = d * 0.999999 + 1e-7;
+    }
+    return a + b + c + d;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+static double avx2_chunk(double seed) {
+    // Independent accumulators cover the FMA latency
+    __m256d scale = _mm256_set1_pd(0.999999), bias = _mm256_set1_pd(1e-7);
+    __m256d a = _mm256_set1_pd(seed), b = a, c = a, d = a, e = a, f = a, g = a, h = a;
+    for (int i = 0; i < LoadChunkIterations; i++) {
+        a = _mm256_fmadd_pd(a, scale, bias); b = _mm256_fmadd_pd(b, scale, bias);
+        c = _mm256_fmadd_pd(c, scale, bias); d = _mm256_fmadd_pd(d, scale, bias);
+        e = _mm256_fmadd_pd(e, scale, bias); f = _mm256_fmadd_pd(f, scale, bias);
+        g = _mm256_fmadd_pd(g, scale, bias); h = _mm256_fmadd_pd(h, scale, bias);
+    }
+    __m256d sum = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(a, b), _mm256_add_pd(c, d)),
+                                _mm256_add_pd(_mm256_add_pd(e, f), _mm256_add_pd(g, h)));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx512f")))
+static double avx512_chunk(double seed) {
+    __m512d scale = _mm512_set1_pd(0.999999), bias = _mm512_set1_pd(1e-7);
+    __m512d a = _mm512_set1_pd(seed), b = a, c = a, d = a, e = a, f = a, g = a, h = a;
+    for (int i = 0; i < LoadChunkIterations; i++) {
+        a = _mm512_fmadd_pd(a, scale, bias); b = _mm512_fmadd_pd(b, scale, bias);
+        c = _mm512_fmadd_pd(c, scale, bias); d = _mm512_fmadd_pd(d, scale, bias);
+        e = _mm512_fmadd_pd(e, scale, bias); f = _mm512_fmadd_pd(f, scale, bias);
+        g = _mm512_fmadd_pd(g, scale, bias); h = _mm512_fmadd_pd(h, scale, bias);
+    }
+    __m512d sum = _mm512_add_pd(_mm512_add_pd(_mm512_add_pd(a, b), _mm512_add_pd(c, d)),
+                                _mm512_add_pd(_mm512_add_pd(e, f), _mm512_add_pd(g, h)));
+    return _mm512_reduce_add_pd(sum);
+}
+#endif
+
+static bool kernel_supported(short kernel) {
+    #if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (kernel == LoadAvx2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (kernel == LoadAvx512) return __builtin_cpu_supports("avx512f");
+    #else
+    if (kernel == LoadAvx2 || kernel == LoadAvx512) return false;
+    #endif
+    return true;
+}
+
+// Triad over the thread's own buffers, resuming where the last chunk stopped
+static double stream_chunk(std::vector<double>& a, const std::vector<double>& b, const std::vector<double>& c, size_t& at) {
+    for (int i = 0; i < LoadChunkIterations; i++) {
+        a[at] = b[at] + 3.0 * c[at];
+        if (++at == a.size()) at = 0;
+    }
+    return a[at];
+}
+
+static void worker(int core, short kernel) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(core, &mask);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+    if (error != 0) std::cerr << "Unable to pin a load thread to core " << core << ": " << strerror(error) << std::endl;
+    std::vector<double> a, b, c;
+    size_t at = 0;
+    if (kernel == LoadStream) {
+        // Touched here, so pages are local to the pinned core
+        size_t count = options.stream_mib * (1 << 20) / sizeof(double);
+        a.assign(count, 0.0);
+        b.assign(count, 1.0);
+        c.assign(count, 2.0);
+    }
+    volatile double sink = 0;
+    double seed = 1.0 + core;
+    while (!finished.load(std::memory_order_relaxed)) {
+        if (!loaded.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lock(phase_lock);
+            phase_changed.wait(lock, [] { return loaded.load() || finished.load(); });
+            continue;
+        }
+        switch (kernel) {
+            case LoadScalar: sink = scalar_chunk(seed); break;
+            #if defined(__x86_64__) || defined(__i386__)
+            case LoadAvx2: sink = avx2_chunk(seed); break;
+            case LoadAvx512: sink = avx512_chunk(seed); break;
+            #endif
+            case LoadStream: sink = stream_chunk(a, b, c, at); break;
+        }
+    }
+    (void)sink;
+}
+
+static bool open_markers(void) {
+    std::string path = options.markers_path;
+    if (path.empty()) {
+        const char* inherited = getenv(MarkerEnvironment);
+        if (inherited != nullptr) path = inherited;
+    }
+    if (path.empty() || path == "-") return true;
+    // A FIFO without a reader fails rather than blocking the first edge
+    marker_fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_NONBLOCK | O_CLOEXEC, 0644);
+    if (marker_fd < 0) {
+        std::cerr << "Unable to open markers " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // Later writes may wait for a full pipe rather than drop a marker
+    fcntl(marker_fd, F_SETFL, fcntl(marker_fd, F_GETFL) & ~O_NONBLOCK);
+    return true;
+}
+
+// One write() per line keeps markers whole (lines stay far below PIPE_BUF)
+static void write_marker(const char* phase, long cycle, uint64_t edge_ns) {
+    nlohmann::json marker = {
+        {"phase", phase},
+        {"cycle", cycle},
+        {"kernel", kernel_names[options.kernel]},
+        {"cores", options.cores},
+        {"duty", options.duty},
+        {"period", options.period},
+        {"edge-monotonic-ns", edge_ns},
+    };
+    std::string line = marker.dump() + "\n";
+    if (write(marker_fd, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+        std::cerr << "Unable to write marker: " << strerror(errno) << std::endl;
+}
+
+// Flip the phase, returning when it flipped
+static uint64_t set_phase(bool on) {
+    uint64_t edge_ns;
+    {
+        std::lock_guard<std::mutex> lock(phase_lock);
+        loaded.store(on);
+        edge_ns = monotonic_ns();
+    }
+    if (on) phase_changed.notify_all();
+    return edge_ns;
+}
+
+int main(int argc, char** argv) {
+    const struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"cores", required_argument, 0, 'c'},
+        {"kernel", required_argument, 0, 'k'},
+        {"duty", required_argument, 0, 'd'},
+        {"period", required_argument, 0, 'p'},
+        {"duration", required_argument, 0, 't'},
+        {"cycles", required_argument, 0, 'n'},
+        {"stream-size", required_argument, 0, 's'},
+        {"markers", required_argument, 0, 'm'},
+        {0,0,0,0}
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "hc:k:d:p:t:n:s:m:", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 'c':
+                if (!parse_cores(optarg, options.cores)) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << " '" << optarg << "'" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'k': {
+                short kernel = 0;
+                while (kernel < count_LoadKernels && std::string(kernel_names[kernel]) != optarg) kernel++;
+                if (kernel == count_LoadKernels) {
+                    std::cerr << "Invalid setting for " << argv[optind-2] << " '" << optarg << "'" << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                options.kernel = kernel;
+                break;
+            }
+            case 'd':
+                options.duty = atof(optarg);
+                break;
+            case 'p':
+                options.period = atof(optarg);
+                break;
+            case 't':
+                options.duration = atof(optarg);
+                break;
+            case 'n':
+                options.cycles = atol(optarg);
+                break;
+            case 's':
+                options.stream_mib = strtoul(optarg, nullptr, 10);
+                break;
+            case 'm':
+                options.markers_path = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (optind != argc || options.duty <= 0 || options.duty > 1 || options.period <= 0 || options.duration < 0 ||
+        options.cycles < 0 || options.stream_mib == 0) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (!kernel_supported(options.kernel)) {
+        std::cerr << "This CPU does not support the " << kernel_names[options.kernel] << " kernel" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (!open_markers()) exit(EXIT_FAILURE);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    std::vector<std::thread> workers;
+    for (std::vector<int>::iterator core = options.cores.begin(); core != options.cores.end(); core++)
+        workers.emplace_back(worker, *core, options.kernel);
+
+    // Absolute edge times, so sleeping late on one edge does not shift the rest
+    typedef std::chrono::steady_clock clock;
+    const clock::duration period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(options.period)),
+                          on_time = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(options.period * options.duty));
+    const clock::time_point start = clock::now(),
+                            end = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(options.duration));
+    for (long cycle = 0; !stop_requested && (options.cycles == 0 || cycle < options.cycles); cycle++) {
+        clock::time_point on_edge = start + cycle * period, off_edge = on_edge + on_time;
+        if (options.duration > 0 && on_edge >= end) break;
+        if (options.duration > 0 && off_edge > end) off_edge = end;
+        std::this_thread::sleep_until(on_edge);
+        if (stop_requested) break;
+        write_marker("on", cycle, set_phase(true));
+        // Sleep in short steps so a signal ends the on phase promptly
+        while (!stop_requested && clock::now() < off_edge)
+            std::this_thread::sleep_until(std::min(off_edge, clock::now() + std::chrono::milliseconds(100)));
+        write_marker("off", cycle, set_phase(false));
+    }
+    {
+        std::lock_guard<std::mutex> lock(phase_lock);
+        finished.store(true);
+    }
+    phase_changed.notify_all();
+    for (std::vector<std::thread>::iterator thread = workers.begin(); thread != workers.end(); thread++) thread->join();
+    if (marker_fd != STDOUT_FILENO) close(marker_fd);
+    return 0;
+}
@@ -0,0 +1,443 @@
+/*
+    sensortools-simtree: generate a fake /sys and /proc for running collectors against any machine shape
+
+    Writes DIR/sys and DIR/proc holding the files the CPU (frequency, utilization, idle, throttling, topology, hwmon
+    coretemp), RAPL, sysstat, network, disk, thermal and uncore collectors read, for any number of cores, sockets and
+    NUMA nodes. Point a sensing run at it with
+        ${hostname}_sensors --sysfs-root DIR/sys --procfs-root DIR/proc ...
+
+    Readings follow the same trajectories as simulated devices (-X, tools/sim/sim_backend.h): levels such as
+    frequencies and temperatures are set from them directly, counters such as energy, idle time and bytes grow at a
+    rate set from them. Each core's load mixes its socket's trajectory with its own; per-socket readings follow the
+    mean load of the socket's cores.
+    With -u the tree is rewritten every interval until interrupted. Files are rewritten in place rather than replaced,
+    so descriptors collectors keep open see every update.
+*/
+// Headers and why they're included
+// Document necessary compiler flags as needed in full-line comment below the header
+#include "../tools/sim/sim_backend.h" // Trajectories
+
+#include <iostream> // std file descriptors
+#include <string> // String class and manipulation
+#include <vector> // Files and per-core state
+#include <functional> // File renderers
+#include <filesystem> // Creating the tree
+#include <algorithm> // std::min, std::max, std::max_element
+#include <thread> // Sleeping between updates
+#include <chrono> // Update interval
+#include <csignal> // Stopping on SIGINT/SIGTERM
+#include <cstring> // strerror()
+#include <cerrno> // errno
+#include <fcntl.h> // open()
+#include <unistd.h> // pwrite(), ftruncate(), close(), symlink()
+#include <getopt.h> // provides getopt-long() definition
+// End Headers
+
+#define SimtreeMinKhz 1200000
+#define SimtreeMaxKhz 3800000
+#define SimtreeUncoreMinKhz 800000
+#define SimtreeUncoreMaxKhz 2400000
+#define SimtreeRaplRangeUj 262143328850ull // max_energy_range_uj of a typical package domain
+#define SimtreeUserHz 100 // /proc/stat ticks per second
+#define SimtreeMemTotalKb (256ull << 20)
+
+// Class and Type declarations
+typedef struct simtree_options_t {
+    int cores = 8, sockets = 1, nodes = 0; // nodes == 0: one per socket
+    int interfaces = 1, disks = 1, nvme = 0;
+    double update = 0; // Seconds between rewrites, 0 == write once
+} simtree_options;
+
+// A file whose content changes; render(t, dt) gives its content t seconds into the run, dt after the last render
+typedef struct tree_file_t {
+    int fd;
+    std::function<std::string(double, double)> render;
+} tree_file;
+// End Class and Type declarations
+
+static std::filesystem::path tree_root;
+static std::vector<tree_file> tree_files;
+static std::vector<double> core_loads, socket_loads; // Refreshed before every render pass
+static simtree_options options;
+static volatile sig_atomic_t stop_requested = 0;
+
+static void usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] DIR" << std::endl;
+    std::cout << "\t-h | --help\n\t\t" <<
+                 "Print this help message and exit" << std::endl;
+    std::cout << "\t-c [n] | --cores [n]\n\t\t" <<
+                 "Logical cores (default: " << options.cores << ")" << std::endl;
+    std::cout << "\t-s [n] | --sockets [n]\n\t\t" <<
+                 "Sockets, dividing the cores evenly (default: " << options.sockets << ")" << std::endl;
+    std::cout << "\t-n [n] | --nodes [n]\n\t\t" <<
+                 "NUMA nodes, dividing the cores evenly (default: one per socket)" << std::endl;
+    std::cout << "\t-e [n] | --interfaces [n]\n\t\t" <<
+                 "Network interfaces besides loopback (default: " << options.interfaces << ")" << std::endl;
+    std::cout << "\t-b [n] | --disks [n]\n\t\t" <<
+                 "SATA block devices (default: " << options.disks << "), plus one namespace per simulated NVMe controller" << std::endl;
+    std::cout << "\t-X [spec] | --simulate [spec]\n\t\t" <<
+                 "How readings move, as for the sensing tool's -X (default: random,period=" << simulation.period << ",nvme=0)" << std::endl;
+    std::cout << "\t-u [interval] | --update [interval]\n\t\t" <<
+                 "Rewrite the tree every [interval] seconds until interrupted (default: write once)" << std::endl;
+}
+
+static void on_signal(int) {
+    stop_requested = 1;
+}
+
+// Replace a file's content without replacing the file
+static bool rewrite(int fd, const std::string& content) {
+    return pwrite(fd, content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()) &&
+           ftruncate(fd, content.size()) == 0;
+}
+
+static bool write_file(const std::string& path, const std::string& content) {
+    std::filesystem::path file = tree_root / path;
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0 && rewrite(fd, content);
+    if (!ok) std::cerr << "Unable to write " << file << ": " << strerror(errno) << std::endl;
+    if (fd >= 0) close(fd);
+    return ok;
+}
+
+static void add_file(const std::string& path, std::function<std::string(double, double)> render) {
+    std::filesystem::path file = tree_root / path;
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Unable to create " << file << ": " << strerror(errno) << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    tree_files.push_back({fd, render});
+}
+
+// Relative symlink at link (tree path) pointing to target (tree path)
+static void add_link(const std::string& target, const std::string& link) {
+    std::filesystem::path at = tree_root / link;
+    std::error_code ec;
+    std::filesystem::create_directories(at.parent_path(), ec);
+    std::filesystem::remove(at, ec);
+    std::filesystem::create_directory_symlink(std::filesystem::relative(tree_root / target, at.parent_path()), at, ec);
+    if (ec) std::cerr << "Unable to link " << at << ": " << ec.message() << std::endl;
+}
+
+// A level between lo and hi, as text
+static std::function<std::string(double, double)> level(std::function<double(void)> load, double lo, double hi) {
+    return [load, lo, hi](double, double) { return std::to_string(static_cast<int64_t>(lo + (hi - lo) * load())) + "\n"; };
+}
+
+// A counter growing by between lo and hi per second, wrapping at range (0 == never)
+static std::function<std::string(double, double)> counter(std::function<double(void)> load, double lo, double hi, uint64_t range = 0) {
+    double total = 0;
+    return [load, lo, hi, range, total](double, double dt) mutable {
+        total += (lo + (hi - lo) * load()) * dt;
+        uint64_t value = static_cast<uint64_t>(total);
+        return std::to_string((range == 0) ? value : value % range) + "\n";
+    };
+}
+
+// The last socket takes any cores left over
+static int socket_of(int core) {
+    return std::min(options.sockets - 1, core / std::max(1, options.cores / options.sockets));
+}
+
+// Per core: frequency, topology, idle states and throttle counters; then NUMA nodes and /proc/stat
+static void add_cpu_tree(void) {
+    int per_node = std::max(1, options.cores / options.nodes);
+    for (int c = 0; c < options.cores; c++) {
+        std::string cpu = "sys/devices/system/cpu/cpu" + std::to_string(c);
+        std::function<double(void)> load = [c]() { return core_loads[c]; };
+        add_file(cpu + "/cpufreq/scaling_cur_freq", level(load, SimtreeMinKhz, SimtreeMaxKhz));
+        write_file(cpu + "/cpufreq/scaling_min_freq", std::to_string(SimtreeMinKhz) + "\n");
+        write_file(cpu + "/cpufreq/scaling_max_freq", std::to_string(SimtreeMaxKhz) + "\n");
+        write_file(cpu + "/cpufreq/base_frequency", std::to_string((SimtreeMinKhz + SimtreeMaxKhz) / 2) + "\n");
+        write_file(cpu + "/topology/physical_package_id", std::to_string(socket_of(c)) + "\n");
+        write_file(cpu + "/topology/die_id", "0\n");
+        write_file(cpu + "/topology/core_id", std::to_string(c - socket_of(c) * std::max(1, options.cores / options.sockets)) + "\n");
+        // Idle microseconds split over the states as a mostly-C6 part would
+        const char* states[] = {"POLL", "C1", "C6"};
+        const double shares[] = {0.01, 0.2, 0.79};
+        for (int s = 0; s < 3; s++) {
+            std::string dir = cpu + "/cpuidle/state" + std::to_string(s);
+            write_file(dir + "/name", std::string(states[s]) + "\n");
+            add_file(dir + "/time", counter([c]() { return 1 - core_loads[c]; }, 0, shares[s] * 1e6));
+        }
+        // A couple of throttle events a second while nearly saturated
+        add_file(cpu + "/thermal_throttle/core_throttle_count", counter([c]() { return core_loads[c] > 0.95; }, 0, 2));
+        add_file(cpu + "/thermal_throttle/package_throttle_count", counter([c]() { return socket_loads[socket_of(c)] > 0.95; }, 0, 2));
+    }
+    for (int n = 0; n < options.nodes; n++) {
+        int first = n * per_node, last = (n == options.nodes - 1) ? options.cores - 1 : first + per_node - 1;
+        write_file("sys/devices/system/node/node" + std::to_string(n) + "/cpulist", std::to_string(first) + "-" + std::to_string(last) + "\n");
+    }
+    // Utilization: user and system time grow with load, idle with the rest
+    std::vector<double> ticks(options.cores * 3, 0);
+    add_file("proc/stat", [ticks](double, double dt) mutable {
+        std::string cores;
+        uint64_t all[3] = {0, 0, 0};
+        for (int c = 0; c < options.cores; c++) {
+            ticks[c * 3] += core_loads[c] * 0.8 * SimtreeUserHz * dt;
+            ticks[c * 3 + 1] += core_loads[c] * 0.2 * SimtreeUserHz * dt;
+            ticks[c * 3 + 2] += (1 - core_loads[c]) * SimtreeUserHz * dt;
+            uint64_t user = ticks[c * 3], system = ticks[c * 3 + 1], idle = ticks[c * 3 + 2];
+            all[0] += user; all[1] += system; all[2] += idle;
+            cores += "cpu" + std::to_string(c) + " " + std::to_string(user) + " 0 " + std::to_string(system) + " " + std::to_string(idle) + " 0 0 0 0 0 0\n";
+        }
+        return "cpu  " + std::to_string(all[0]) + " 0 " + std::to_string(all[1]) + " " + std::to_string(all[2]) + " 0 0 0 0 0 0\n" +
+               cores + "intr 0\nctxt 0\nbtime 0\nprocesses 1\nprocs_running 1\nprocs_blocked 0\n";
+    });
+}
+
+// Per socket: coretemp chip, RAPL domains, package thermal zone and cooling device, uncore frequency
+static void add_socket_tree(void) {
+    int per_socket = std::max(1, options.cores / options.sockets);
+    std::error_code ec;
+    std::filesystem::create_directories(tree_root / "sys/bus/platform", ec);
+    for (int s = 0; s < options.sockets; s++) {
+        std::string id = std::to_string(s);
+        std::function<double(void)> load = [s]() { return socket_loads[s]; };
+        std::string device = "sys/devices/platform/coretemp." + id, hwmon = device + "/hwmon/hwmon" + id;
+        write_file(hwmon + "/name", "coretemp\n");
+        add_link(device, hwmon + "/device");
+        add_link("sys/bus/platform", device + "/subsystem");
+        add_link(hwmon, "sys/class/hwmon/hwmon" + id);
+        write_file(hwmon + "/temp1_label", "Package id " + id + "\n");
+        add_file(hwmon + "/temp1_input", level(load, 35000, 95000));
+        for (int c = s * per_socket, k = 0; c < options.cores && socket_of(c) == s; c++, k++) {
+            std::string temp = hwmon + "/temp" + std::to_string(k + 2);
+            write_file(temp + "_label", "Core " + std::to_string(k) + "\n");
+            add_file(temp + "_input", level([c]() { return core_loads[c]; }, 33000, 93000));
+        }
+
+        std::string rapl = "sys/class/powercap/intel-rapl:" + id;
+        write_file(rapl + "/name", "package-" + id + "\n");
+        write_file(rapl + "/max_energy_range_uj", std::to_string(SimtreeRaplRangeUj) + "\n");
+        add_file(rapl + "/energy_uj", counter(load, 40e6, 200e6, SimtreeRaplRangeUj + 1));
+        write_file(rapl + ":0/name", "dram\n");
+        write_file(rapl + ":0/max_energy_range_uj", std::to_string(SimtreeRaplRangeUj) + "\n");
+        add_file(rapl + ":0/energy_uj", counter(load, 5e6, 25e6, SimtreeRaplRangeUj + 1));
+
+        std::string zone = "sys/class/thermal/thermal_zone" + id, cooling = "sys/class/thermal/cooling_device" + id;
+        write_file(zone + "/type", "x86_pkg_temp\n");
+        add_file(zone + "/temp", level(load, 35000, 95000));
+        write_file(zone + "/trip_point_0_type", "passive\n");
+        write_file(zone + "/trip_point_0_temp", "95000\n");
+        write_file(zone + "/trip_point_1_type", "critical\n");
+        write_file(zone + "/trip_point_1_temp", "105000\n");
+        write_file(cooling + "/type", "Processor\n");
+        write_file(cooling + "/max_state", "10\n");
+        // Throttling steps in over the top fifth of the load range
+        add_file(cooling + "/cur_state", level([s]() { return std::max(0., socket_loads[s] - 0.8) / 0.2; }, 0, 10));
+
+        char uncore[64];
+        snprintf(uncore, sizeof(uncore), "sys/devices/system/cpu/intel_uncore_frequency/package_%02d_die_00", s);
+        write_file(std::string(uncore) + "/min_freq_khz", std::to_string(SimtreeUncoreMinKhz) + "\n");
+        write_file(std::string(uncore) + "/max_freq_khz", std::to_string(SimtreeUncoreMaxKhz) + "\n");
+        add_file(std::string(uncore) + "/current_freq_khz", level(load, SimtreeUncoreMinKhz, SimtreeUncoreMaxKhz));
+    }
+}
+
+// Pressure follows the busiest socket; vmstat and meminfo follow the whole machine's load
+static void add_system_tree(void) {
+    std::function<double(void)> load = []() {
+        double sum = 0;
+        for (double l : socket_loads) sum += l;
+        return sum / socket_loads.size();
+    };
+    for (const char* resource : {"cpu", "memory", "io"}) {
+        uint64_t key = sim_key("pressure", 0, resource[0]);
+        double some = 0, full = 0;
+        add_file(std::string("proc/pressure/") + resource, [key, some, full](double t, double dt) mutable {
+            // Stalls only build up once some socket is busy
+            double busiest = *std::max_element(socket_loads.begin(), socket_loads.end());
+            double stall = std::max(0., busiest - 0.6) / 0.4 * sim_level(simulation, key, t);
+            some += stall * 0.5e6 * dt;
+            full += stall * 0.2e6 * dt;
+            return "some avg10=0.00 avg60=0.00 avg300=0.00 total=" + std::to_string(static_cast<uint64_t>(some)) + "\n" +
+                   "full avg10=0.00 avg60=0.00 avg300=0.00 total=" + std::to_string(static_cast<uint64_t>(full)) + "\n";
+        });
+    }
+    double counts[6] = {0};
+    add_file("proc/vmstat", [load, counts](double, double dt) mutable {
+        const char* names[6] = {"pgfault", "pgmajfault", "pswpin", "pswpout", "numa_miss", "numa_foreign"};
+        const double rates[6] = {2e5, 50, 10, 10, 1e3, 1e3};
+        std::string text = "nr_free_pages 1000000\n";
+        for (int k = 0; k < 6; k++) {
+            counts[k] += rates[k] * load() * dt;
+            text += std::string(names[k]) + " " + std::to_string(static_cast<uint64_t>(counts[k])) + "\n";
+        }
+        return text;
+    });
+    add_file("proc/meminfo", [load](double, double) {
+        uint64_t used = static_cast<uint64_t>(SimtreeMemTotalKb * (0.1 + 0.8 * load()));
+        return "MemTotal:       " + std::to_string(SimtreeMemTotalKb) + " kB\n" +
+               "MemFree:        " + std::to_string((SimtreeMemTotalKb - used) / 2) + " kB\n" +
+               "MemAvailable:   " + std::to_string(SimtreeMemTotalKb - used) + " kB\n" +
+               "Buffers:        1024 kB\n" +
+               "Cached:         " + std::to_string((SimtreeMemTotalKb - used) / 2) + " kB\n" +
+               "SwapTotal:      8388608 kB\n" +
+               "SwapFree:       8388608 kB\n" +
+               "Dirty:          " + std::to_string(static_cast<uint64_t>(1e5 * load())) + " kB\n";
+    });
+}
+
+// /proc/net/dev and /proc/diskstats, each device with its own trajectory
+static void add_device_tree(void) {
+    std::vector<double> net(options.interfaces * 4, 0);
+    add_file("proc/net/dev", [net](double t, double dt) mutable {
+        std::string text = "Inter-|   Receive                                                |  Transmit\n"
+                           " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+                           "    lo: 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+        for (int i = 0; i < options.interfaces; i++) {
+            // Up to 10 Gb/s each way in 1 kB packets
+            for (int d = 0; d < 2; d++) net[i * 4 + d * 2] += 1.25e9 * sim_level(simulation, sim_key("net", i, d), t) * dt;
+            for (int d = 0; d < 2; d++) net[i * 4 + d * 2 + 1] = net[i * 4 + d * 2] / 1000;
+            text += "  eth" + std::to_string(i) + ": ";
+            for (int d = 0; d < 2; d++) {
+                text += std::to_string(static_cast<uint64_t>(net[i * 4 + d * 2])) + " " + std::to_string(static_cast<uint64_t>(net[i * 4 + d * 2 + 1])) +
+                        " 0 0 0 0 0 0 ";
+            }
+            text.back() = '\n';
+        }
+        return text;
+    });
+    std::vector<std::string> names;
+    for (int d = 0; d < options.disks; d++) names.push_back("sd" + std::string(1, 'a' + d % 26) + ((d < 26) ? "" : std::to_string(d / 26)));
+    for (int n = 0; n < options.nvme; n++) {
+        names.push_back("nvme" + std::to_string(n) + "n1");
+        // Namespaces link back to their controller, which the disk tool uses to share NVMe indices
+        std::error_code ec;
+        std::filesystem::create_directories(tree_root / ("sys/class/nvme/nvme" + std::to_string(n)), ec);
+        add_link("sys/class/nvme/nvme" + std::to_string(n), "sys/block/" + names.back() + "/device");
+    }
+    for (std::vector<std::string>::iterator name = names.begin(); name != names.end(); name++)
+        write_file("sys/block/" + *name + "/size", "0\n");
+    std::vector<double> io(names.size() * 5, 0);
+    add_file("proc/diskstats", [names, io](double t, double dt) mutable {
+        std::string text;
+        for (size_t d = 0; d < names.size(); d++) {
+            double read = sim_level(simulation, sim_key("disk", d, 0), t), write = sim_level(simulation, sim_key("disk", d, 1), t);
+            // Up to 2 GB/s each way in 128 kB requests; busy while either direction is
+            io[d * 5] += read * 2e9 / 512 * dt;
+            io[d * 5 + 1] += read * 2e9 / 131072 * dt;
+            io[d * 5 + 2] += write * 2e9 / 512 * dt;
+            io[d * 5 + 3] += write * 2e9 / 131072 * dt;
+            io[d * 5 + 4] += std::min(1., read + write) * 1e3 * dt;
+            uint64_t v[5];
+            for (int k = 0; k < 5; k++) v[k] = io[d * 5 + k];
+            text += " 259       " + std::to_string(d) + " " + names[d] + " " +
+                    std::to_string(v[1]) + " 0 " + std::to_string(v[0]) + " 0 " +
+                    std::to_string(v[3]) + " 0 " + std::to_string(v[2]) + " 0 0 " + std::to_string(v[4]) + " " + std::to_string(v[4]) + "\n";
+        }
+        return text;
+    });
+}
+
+// Refresh the loads and every file; returns how many writes failed
+static int render_all(double t, double dt) {
+    // Cores mostly follow their socket's workload, so socket-level readings move rather than average out
+    std::vector<double> sums(options.sockets, 0), workloads(options.sockets);
+    std::vector<int> counts(options.sockets, 0);
+    for (int s = 0; s < options.sockets; s++) workloads[s] = sim_level(simulation, sim_key("socket", s, 0), t);
+    for (int c = 0; c < options.cores; c++) {
+        core_loads[c] = 0.7 * workloads[socket_of(c)] + 0.3 * sim_level(simulation, sim_key("core", c, 0), t);
+        sums[socket_of(c)] += core_loads[c];
+        counts[socket_of(c)]++;
+    }
+    for (int s = 0; s < options.sockets; s++) socket_loads[s] = (counts[s] > 0) ? sums[s] / counts[s] : 0;
+    int failed = 0;
+    for (std::vector<tree_file>::iterator file = tree_files.begin(); file != tree_files.end(); file++)
+        if (!rewrite(file->fd, file->render(t, dt))) failed++;
+    return failed;
+}
+
+int main(int argc, char** argv) {
+    const struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"cores", required_argument, 0, 'c'},
+        {"sockets", required_argument, 0, 's'},
+        {"nodes", required_argument, 0, 'n'},
+        {"interfaces", required_argument, 0, 'e'},
+        {"disks", required_argument, 0, 'b'},
+        {"simulate", required_argument, 0, 'X'},
+        {"update", required_argument, 0, 'u'},
+        {0,0,0,0}
+    };
+    // Simulated NVMe controllers only get namespaces when asked for
+    simulation.nvme = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "hc:s:n:e:b:X:u:", long_options, nullptr)) != -1) {
+        switch (c) {
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            case 'c':
+                options.cores = atoi(optarg);
+                break;
+            case 's':
+                options.sockets = atoi(optarg);
+                break;
+            case 'n':
+                options.nodes = atoi(optarg);
+                break;
+            case 'e':
+                options.interfaces = atoi(optarg);
+                break;
+            case 'b':
+                options.disks = atoi(optarg);
+                break;
+            case 'X': {
+                std::string error;
+                if (!parse_simulation(optarg, simulation, error)) {
+                    std::cerr << "Invalid simulation '" << optarg << "': " << error << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            }
+            case 'u':
+                options.update = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+    if (options.nodes == 0) options.nodes = options.sockets;
+    options.nvme = simulation.nvme;
+    if (optind != argc - 1 || options.cores < 1 || options.sockets < 1 || options.sockets > options.cores ||
+        options.nodes < 1 || options.nodes > options.cores || options.interfaces < 0 || options.disks < 0 || options.update < 0) {
+        usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    tree_root = argv[optind];
+    core_loads.assign(options.cores, 0);
+    socket_loads.assign(options.sockets, 0);
+
+    add_cpu_tree();
+    add_socket_tree();
+    add_system_tree();
+    add_device_tree();
+    if (render_all(sim_time(), 0) > 0) exit(EXIT_FAILURE);
+    std::cout << "Wrote " << tree_files.size() << " files for " << options.cores << " cores, " << options.sockets << " sockets and " <<
+                 options.nodes << " nodes below " << tree_root << std::endl;
+    if (options.update == 0) return 0;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    double last = sim_time();
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    while (!stop_requested) {
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.update));
+        std::this_thread::sleep_until(next);
+        double now = sim_time();
+        int failed = render_all(now, now - last);
+        if (failed > 0) std::cerr << failed << " files could not be rewritten" << std::endl;
+        last = now;
+    }
+    for (std::vector<tree_file>::iterator file = tree_files.begin(); file != tree_files.end(); file++) close(file->fd);
+    return 0;
+}
+